@@ -0,0 +1,135 @@
+#include <assembler/assembler.hpp>
+#include <assembler/counting_resource.hpp>
+#include <benchmark/benchmark.h>
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "synthetic_source.hpp"
+
+namespace {
+    void set_counters(benchmark::State& state, std::string_view const source, usize const num_instructions) {
+        state.SetBytesProcessed(static_cast<i64>(state.iterations() * source.length()));
+        state.counters["instructions_per_second"] = benchmark::Counter{
+            static_cast<double>(num_instructions),
+            benchmark::Counter::kIsIterationInvariantRate,
+        };
+    }
+
+    void lexer_tokenize(benchmark::State& state) {
+        auto const source = synthetic_source(static_cast<usize>(state.range(0)));
+        auto const source_file = assembler::SourceFile{ "benchmark.asm", source };
+        auto num_tokens = usize{ 0 };
+        for (auto _ : state) {
+            auto lexer = assembler::Lexer{ source_file };
+            if (not lexer.tokenize().has_value()) {
+                state.SkipWithError("Tokenizing failed.");
+                return;
+            }
+            auto const tokens = std::move(lexer).take();
+            num_tokens = tokens.size();
+            benchmark::DoNotOptimize(tokens.data());
+        }
+        state.SetBytesProcessed(static_cast<i64>(state.iterations() * source.length()));
+        state.counters["tokens_per_second"] = benchmark::Counter{
+            static_cast<double>(num_tokens),
+            benchmark::Counter::kIsIterationInvariantRate,
+        };
+    }
+
+    void parser_parse(benchmark::State& state) {
+        auto const source = synthetic_source(static_cast<usize>(state.range(0)));
+        auto const source_file = assembler::SourceFile{ "benchmark.asm", source };
+        auto lexer = assembler::Lexer{ source_file };
+        if (not lexer.tokenize().has_value()) {
+            state.SkipWithError("Tokenizing failed.");
+            return;
+        }
+        auto const tokens = std::move(lexer).take();
+        auto num_instructions = usize{ 0 };
+        for (auto _ : state) {
+            // Copying the tokens is part of the measurement, since the parser consumes them.
+            auto parser = assembler::Parser{ tokens };
+            if (not parser.parse().has_value()) {
+                state.SkipWithError("Parsing failed.");
+                return;
+            }
+            auto const ast = std::move(parser).take();
+            num_instructions = ast.instructions().size();
+            benchmark::DoNotOptimize(ast.instructions().data());
+        }
+        set_counters(state, source, num_instructions);
+    }
+
+    void assemble(benchmark::State& state) {
+        auto const source = synthetic_source(static_cast<usize>(state.range(0)));
+        auto const source_file = assembler::SourceFile{ "benchmark.asm", source };
+        auto const options = assembler::Options{ .num_threads = static_cast<usize>(state.range(1)) };
+        auto num_instructions = usize{ 0 };
+        for (auto _ : state) {
+            auto const instructions = assembler::assemble(source_file, options);
+            if (not instructions.has_value()) {
+                state.SkipWithError("Assembling failed.");
+                return;
+            }
+            num_instructions = instructions->size();
+            benchmark::DoNotOptimize(instructions->opcodes().data());
+        }
+        set_counters(state, source, num_instructions);
+    }
+
+    void stream(benchmark::State& state) {
+        auto const source = synthetic_source(static_cast<usize>(state.range(0)));
+        auto const source_file = assembler::SourceFile{ "benchmark.asm", source };
+        auto const options = assembler::Options{ .num_threads = 1 };
+        for (auto _ : state) {
+            auto num_bytes = usize{ 0 };
+            auto const result = assembler::stream(
+                source_file,
+                [&](std::span<std::byte const> const bytes) { num_bytes += bytes.size(); },
+                options
+            );
+            if (not result.has_value()) {
+                state.SkipWithError("Assembling failed.");
+                return;
+            }
+            benchmark::DoNotOptimize(num_bytes);
+        }
+        state.SetBytesProcessed(static_cast<i64>(state.iterations() * source.length()));
+    }
+
+    // How much of the temporary memory the assembler still requests from the upstream resource.
+    void assemble_allocations(benchmark::State& state) {
+        auto const source = synthetic_source(static_cast<usize>(state.range(0)));
+        auto const source_file = assembler::SourceFile{ "benchmark.asm", source };
+        auto counting_resource = assembler::CountingResource{};
+        auto const options = assembler::Options{
+            .num_threads = static_cast<usize>(state.range(1)),
+            .memory_resource = &counting_resource,
+        };
+        for (auto _ : state) {
+            auto const instructions = assembler::assemble(source_file, options);
+            if (not instructions.has_value()) {
+                state.SkipWithError("Assembling failed.");
+                return;
+            }
+            benchmark::DoNotOptimize(instructions->opcodes().data());
+        }
+        auto const statistics = counting_resource.statistics();
+        state.counters["upstream_allocations"] = benchmark::Counter{
+            static_cast<double>(statistics.num_allocations),
+            benchmark::Counter::kAvgIterations,
+        };
+        state.counters["upstream_peak_bytes"] = static_cast<double>(statistics.peak_bytes);
+    }
+}  // namespace
+
+BENCHMARK(lexer_tokenize)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK(parser_parse)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK(assemble)
+    ->ArgNames({ "lines", "threads" })
+    ->ArgsProduct({ benchmark::CreateRange(64, 1 << 20, 16), { 1, 0 } })
+    ->UseRealTime();
+BENCHMARK(stream)->ArgName("lines")->RangeMultiplier(16)->Range(64, 1 << 20);
+BENCHMARK(assemble_allocations)
+    ->ArgNames({ "lines", "threads" })
+    ->ArgsProduct({ benchmark::CreateRange(64, 1 << 20, 16), { 1, 0 } })
+    ->UseRealTime();
@@ -0,0 +1,90 @@
+#include <assembler/assembler.hpp>
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <common/instruction.hpp>
+#include <common/instruction_store.hpp>
+#include <iterator>
+#include <vector>
+#include "synthetic_source.hpp"
+
+namespace {
+    [[nodiscard]] InstructionStore synthetic_instructions(usize const num_lines) {
+        auto const source = synthetic_source(num_lines);
+        auto const source_file = assembler::SourceFile{ "benchmark.asm", source };
+        return assembler::assemble(source_file).value();
+    }
+
+    void set_counters(benchmark::State& state, usize const num_bytes, usize const num_instructions) {
+        state.SetBytesProcessed(static_cast<i64>(state.iterations() * num_bytes));
+        state.counters["instructions_per_second"] = benchmark::Counter{
+            static_cast<double>(num_instructions),
+            benchmark::Counter::kIsIterationInvariantRate,
+        };
+    }
+
+    void instruction_encode(benchmark::State& state) {
+        auto const instructions = synthetic_instructions(static_cast<usize>(state.range(0)));
+        auto bytes = std::vector<std::byte>{};
+        bytes.reserve(instructions.byte_length());
+        for (auto _ : state) {
+            bytes.clear();
+            for (auto const& instruction : instructions) {
+                instruction.encode(std::back_inserter(bytes));
+            }
+            benchmark::DoNotOptimize(bytes.data());
+            benchmark::ClobberMemory();
+        }
+        set_counters(state, bytes.size(), instructions.size());
+    }
+
+    void instruction_decode(benchmark::State& state) {
+        auto const instructions = synthetic_instructions(static_cast<usize>(state.range(0)));
+        auto const bytes = instructions.encode();
+        for (auto _ : state) {
+            auto remaining = std::span<std::byte const>{ bytes };
+            while (not remaining.empty()) {
+                auto const instruction = Instruction::decode(remaining);
+                benchmark::DoNotOptimize(instruction);
+                remaining = remaining.subspan(instruction.byte_length());
+            }
+        }
+        set_counters(state, bytes.size(), instructions.size());
+    }
+
+    void decode_memory(benchmark::State& state) {
+        auto const instructions = synthetic_instructions(static_cast<usize>(state.range(0)));
+        auto const bytes = instructions.encode();
+        for (auto _ : state) {
+            auto const decoded = decode(bytes);
+            benchmark::DoNotOptimize(decoded.opcodes().data());
+        }
+        set_counters(state, bytes.size(), instructions.size());
+    }
+
+    // Counting one opcode only reads the opcode array of the store.
+    void opcode_scan_store(benchmark::State& state) {
+        auto const instructions = synthetic_instructions(static_cast<usize>(state.range(0)));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(instructions.count(Opcode::MoveImmediateIntoMemory));
+        }
+        set_counters(state, instructions.size(), instructions.size());
+    }
+
+    // The same scan over the variants the store replaced, for comparison.
+    void opcode_scan_variants(benchmark::State& state) {
+        auto const store = synthetic_instructions(static_cast<usize>(state.range(0)));
+        auto const instructions = std::vector<Instruction>(store.begin(), store.end());
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(std::ranges::count_if(instructions, [](Instruction const& instruction) {
+                return instruction.opcode() == Opcode::MoveImmediateIntoMemory;
+            }));
+        }
+        set_counters(state, instructions.size() * sizeof(Instruction), instructions.size());
+    }
+}  // namespace
+
+BENCHMARK(instruction_encode)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK(instruction_decode)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK(decode_memory)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK(opcode_scan_store)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK(opcode_scan_variants)->RangeMultiplier(8)->Range(64, 1 << 18);
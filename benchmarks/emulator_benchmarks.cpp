@@ -0,0 +1,187 @@
+#include <fmt/format.h>
+#include <assembler/assembler.hpp>
+#include <benchmark/benchmark.h>
+#include <emulator/emulator.hpp>
+#include <emulator/machine.hpp>
+#include <emulator/profiler.hpp>
+#include <emulator/save_state.hpp>
+#include <emulator/verifier.hpp>
+#include <filesystem>
+#include <iterator>
+#include <limits>
+#include <magic_enum.hpp>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "synthetic_source.hpp"
+
+namespace {
+    void emulator_step(benchmark::State& state) {
+        auto const source = synthetic_program(static_cast<usize>(state.range(0)));
+        auto const source_file = assembler::SourceFile{ "benchmark.asm", source };
+        auto const options = assembler::Options{ .base_address = static_cast<Word>(Emulator::entry_point) };
+        auto const image = assembler::assemble_image(source_file, options);
+        if (not image.has_value()) {
+            state.SkipWithError("Assembling failed.");
+            return;
+        }
+
+        auto emulator = std::make_unique<Emulator>(image->bytes());
+        auto num_steps = usize{ 0 };
+        for (auto _ : state) {
+            if (emulator->is_halted()) {
+                state.PauseTiming();
+                emulator = std::make_unique<Emulator>(image->bytes());
+                state.ResumeTiming();
+            }
+            emulator->step();
+            ++num_steps;
+        }
+        state.counters["instructions_per_second"] = benchmark::Counter{
+            static_cast<double>(num_steps),
+            benchmark::Counter::kIsRate,
+        };
+    }
+
+    // Same program, but verified once up front so that stepping skips fetching and decoding.
+    void emulator_step_verified(benchmark::State& state) {
+        auto const source = synthetic_program(static_cast<usize>(state.range(0)));
+        auto const source_file = assembler::SourceFile{ "benchmark.asm", source };
+        auto const options = assembler::Options{ .base_address = static_cast<Word>(Emulator::entry_point) };
+        auto const image = assembler::assemble_image(source_file, options);
+        if (not image.has_value()) {
+            state.SkipWithError("Assembling failed.");
+            return;
+        }
+        auto const program = VerifiedProgram::verify(image->bytes());
+        if (not program.has_value()) {
+            state.SkipWithError("Verification failed.");
+            return;
+        }
+
+        auto emulator = std::make_unique<Emulator>(program.value());
+        auto num_steps = usize{ 0 };
+        for (auto _ : state) {
+            if (emulator->is_halted()) {
+                state.PauseTiming();
+                emulator = std::make_unique<Emulator>(program.value());
+                state.ResumeTiming();
+            }
+            emulator->step();
+            ++num_steps;
+        }
+        state.counters["instructions_per_second"] = benchmark::Counter{
+            static_cast<double>(num_steps),
+            benchmark::Counter::kIsRate,
+        };
+    }
+
+    // Host hardware events per emulated instruction, next to the emulated instruction rate. Only the rate is
+    // reported where perf events are unavailable.
+    void emulator_host_events(benchmark::State& state) {
+        auto const source = synthetic_program(static_cast<usize>(state.range(0)));
+        auto const source_file = assembler::SourceFile{ "benchmark.asm", source };
+        auto const options = assembler::Options{ .base_address = static_cast<Word>(Emulator::entry_point) };
+        auto const image = assembler::assemble_image(source_file, options);
+        if (not image.has_value()) {
+            state.SkipWithError("Assembling failed.");
+            return;
+        }
+
+        auto profiler = Profiler{};
+        for (auto _ : state) {
+            state.PauseTiming();
+            auto emulator = std::make_unique<Emulator>(image->bytes());
+            state.ResumeTiming();
+            profiler.run(*emulator, std::numeric_limits<u64>::max());
+        }
+
+        auto const& profile = profiler.profile();
+        state.counters["instructions_per_second"] = benchmark::Counter{
+            static_cast<double>(profile.num_instructions),
+            benchmark::Counter::kIsRate,
+        };
+        for (auto const event : magic_enum::enum_values<HardwareEvent>()) {
+            if (auto const value = profile.counters[event]; value.has_value()) {
+                state.counters[fmt::format("{}_per_instruction", magic_enum::enum_name(event))] =
+                    static_cast<double>(value.value()) / static_cast<double>(profile.num_instructions);
+            }
+        }
+    }
+
+    // Loading a save state and executing the first instruction after it, which decompresses one page. The
+    // program is the memory, so its size is the memory size.
+    void save_state_resume(benchmark::State& state) {
+        auto const source = synthetic_program(static_cast<usize>(state.range(0)));
+        auto const source_file = assembler::SourceFile{ "benchmark.asm", source };
+        auto const options = assembler::Options{ .base_address = static_cast<Word>(Emulator::entry_point) };
+        auto const image = assembler::assemble_image(source_file, options);
+        if (not image.has_value()) {
+            state.SkipWithError("Assembling failed.");
+            return;
+        }
+
+        auto const path = std::filesystem::temp_directory_path() / "iubs2k_benchmark_save_state.bin";
+        {
+            auto emulator = Emulator{ image->bytes() };
+            for (auto i = 0; i < 1'000 and not emulator.is_halted(); ++i) {
+                emulator.step();
+            }
+            emulator.save(path);
+        }
+        for (auto _ : state) {
+            auto const save_state = SaveState::load(path);
+            if (not save_state.has_value()) {
+                state.SkipWithError("Loading failed.");
+                break;
+            }
+            auto emulator = Emulator{ save_state.value() };
+            emulator.step();
+            benchmark::DoNotOptimize(emulator.instruction_pointer());
+        }
+        state.counters["memory_size"] = static_cast<double>(image->bytes().size());
+        auto error = std::error_code{};
+        std::filesystem::remove(path, error);
+    }
+
+    // All cores run the same program, so they store to the same words.
+    void machine_run(benchmark::State& state) {
+        auto const source = synthetic_program(static_cast<usize>(state.range(0)));
+        auto const source_file = assembler::SourceFile{ "benchmark.asm", source };
+        auto const options = assembler::Options{ .base_address = static_cast<Word>(Machine::entry_point) };
+        auto const image = assembler::assemble_image(source_file, options);
+        if (not image.has_value()) {
+            state.SkipWithError("Assembling failed.");
+            return;
+        }
+
+        auto const entry_points = std::vector<Word>(static_cast<usize>(state.range(1)), Machine::entry_point);
+        auto const scheduling = static_cast<Scheduling>(state.range(2));
+        auto num_instructions = u64{ 0 };
+        for (auto _ : state) {
+            state.PauseTiming();
+            auto machine = std::make_unique<Machine>(image->bytes(), entry_points);
+            state.ResumeTiming();
+            while (not machine->is_halted()) {
+                num_instructions += machine->run(scheduling, u64{ 1 } << 20);
+            }
+        }
+        state.counters["instructions_per_second"] = benchmark::Counter{
+            static_cast<double>(num_instructions),
+            benchmark::Counter::kIsRate,
+        };
+    }
+}  // namespace
+
+BENCHMARK(emulator_step)->Arg(1 << 14);
+BENCHMARK(emulator_step_verified)->Arg(1 << 14);
+BENCHMARK(emulator_host_events)->Arg(1 << 14);
+BENCHMARK(save_state_resume)->RangeMultiplier(16)->Range(1 << 10, 1 << 18)->Unit(benchmark::kMicrosecond);
+BENCHMARK(machine_run)
+    ->ArgNames({ "stores", "cores", "scheduling" })
+    ->ArgsProduct({
+        { 1 << 14 },
+        { 1, 2, 4 },
+        { std::to_underlying(Scheduling::Deterministic), std::to_underlying(Scheduling::FreeRunning) },
+    })
+    ->UseRealTime();
@@ -0,0 +1,57 @@
+#include <assembler/assembler.hpp>
+#include <benchmark/benchmark.h>
+#include <common/source_map.hpp>
+#include <random>
+#include <vector>
+#include "synthetic_source.hpp"
+
+namespace {
+    constexpr auto num_samples = usize{ 1 } << 20;
+
+    // Uniformly distributed sample addresses, like a sampling profiler would collect them.
+    [[nodiscard]] std::vector<Word> random_addresses(assembler::Image const& image) {
+        auto generator = std::mt19937{ 42 };
+        auto distribution = std::uniform_int_distribution<Word>{ 0, static_cast<Word>(image.bytes().size() - 1) };
+        auto result = std::vector<Word>(num_samples);
+        for (auto& address : result) {
+            address = distribution(generator);
+        }
+        return result;
+    }
+
+    void source_map_find(benchmark::State& state) {
+        auto const source = synthetic_source(static_cast<usize>(state.range(0)));
+        auto const source_file = assembler::SourceFile{ "benchmark.asm", source };
+        auto const image = assembler::assemble_image(source_file);
+        if (not image.has_value()) {
+            state.SkipWithError("Assembling failed.");
+            return;
+        }
+        auto const addresses = random_addresses(image.value());
+        for (auto _ : state) {
+            for (auto const address : addresses) {
+                benchmark::DoNotOptimize(image->source_map().find(address));
+            }
+        }
+        state.SetItemsProcessed(static_cast<i64>(state.iterations() * addresses.size()));
+    }
+
+    void source_map_find_all(benchmark::State& state) {
+        auto const source = synthetic_source(static_cast<usize>(state.range(0)));
+        auto const source_file = assembler::SourceFile{ "benchmark.asm", source };
+        auto const image = assembler::assemble_image(source_file);
+        if (not image.has_value()) {
+            state.SkipWithError("Assembling failed.");
+            return;
+        }
+        auto const addresses = random_addresses(image.value());
+        for (auto _ : state) {
+            auto const locations = image->source_map().find_all(addresses);
+            benchmark::DoNotOptimize(locations.data());
+        }
+        state.SetItemsProcessed(static_cast<i64>(state.iterations() * addresses.size()));
+    }
+}  // namespace
+
+BENCHMARK(source_map_find)->ArgName("lines")->Arg(1 << 10)->Arg(1 << 18);
+BENCHMARK(source_map_find_all)->ArgName("lines")->Arg(1 << 10)->Arg(1 << 18);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <common/common.hpp>
+#include <emulator/text_device.hpp>
+#include <fmt/format.h>
+#include <lib2k/types.hpp>
+#include <string>
+
+// Deterministic assembly sources of (roughly) the requested size, mixing all instruction forms as well
+// as comments and blank lines.
+[[nodiscard]] inline std::string synthetic_source(usize const num_lines) {
+    static constexpr auto registers = std::string_view{ "ABCD" };
+    auto source = std::string{};
+    auto state = u32{ 0x1234'5678 };
+    for (auto line = usize{ 0 }; line < num_lines; ++line) {
+        // xorshift32
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        auto const register_ = registers[state % registers.length()];
+        switch (line % 8) {
+            case 0:
+                source += fmt::format("copy {}, {}\n", state, register_);
+                break;
+            case 1:
+                source += fmt::format("copy 0x{:X}, *{} ; store\n", state, register_);
+                break;
+            case 2:
+                source += "; just a comment\n";
+                break;
+            case 3:
+                source += "\n";
+                break;
+            default:
+                source += fmt::format("copy {}, {}\n", state % 1000, register_);
+                break;
+        }
+    }
+    source += "halt\n";
+    return source;
+}
+
+// A program that keeps writing to the text device, so that every instruction touches memory.
+[[nodiscard]] inline std::string synthetic_program(usize const num_stores) {
+    auto source = std::string{};
+    for (auto i = usize{ 0 }; i < num_stores; ++i) {
+        auto const address = (i * sizeof(Word)) % (TextDevice::num_mapped_bytes - sizeof(Word) + 1);
+        source += fmt::format("copy {}, A\ncopy 0x{:08X}, *A\n", address, 0x4142'4344 + i);
+    }
+    source += "halt\n";
+    return source;
+}
@@ -0,0 +1,39 @@
+#include <array>
+#include <benchmark/benchmark.h>
+#include <emulator/text_device.hpp>
+
+namespace {
+    [[nodiscard]] std::array<std::byte, TextDevice::num_mapped_bytes> filled_memory() {
+        auto memory = std::array<std::byte, TextDevice::num_mapped_bytes>{};
+        for (auto i = usize{ 0 }; i < memory.size(); ++i) {
+            // Leave some cells empty, so that the translation of unused cells is exercised as well.
+            memory[i] = i % 7 == 0 ? std::byte{ 0 } : static_cast<std::byte>('a' + i % 26);
+        }
+        return memory;
+    }
+
+    void text_device_text(benchmark::State& state) {
+        auto memory = filled_memory();
+        auto const text_device = TextDevice{ memory };
+        for (auto _ : state) {
+            auto const text = text_device.text();
+            benchmark::DoNotOptimize(text.data());
+        }
+        state.SetBytesProcessed(static_cast<i64>(state.iterations() * TextDevice::num_mapped_bytes));
+    }
+
+    void text_device_format_into(benchmark::State& state) {
+        auto memory = filled_memory();
+        auto const text_device = TextDevice{ memory };
+        auto buffer = std::array<char, TextDevice::formatted_size>{};
+        for (auto _ : state) {
+            text_device.format_into(buffer);
+            benchmark::DoNotOptimize(buffer.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(static_cast<i64>(state.iterations() * TextDevice::num_mapped_bytes));
+    }
+}  // namespace
+
+BENCHMARK(text_device_text);
+BENCHMARK(text_device_format_into);
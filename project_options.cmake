@@ -22,11 +22,13 @@ if (PROJECT_IS_TOP_LEVEL)
     option(iubs2k_enable_undefined_behavior_sanitizer "Enable undefined behavior sanitizer" ${supports_ubsan})
     option(iubs2k_enable_address_sanitizer "Enable address sanitizer" ${supports_asan})
     option(iubs2k_build_tests "Build unit tests" ON)
+    option(iubs2k_build_benchmarks "Build benchmarks" ON)
 else ()
     option(iubs2k_warnings_as_errors "Treat warnings as errors" OFF)
     option(iubs2k_enable_undefined_behavior_sanitizer "Enable undefined behavior sanitizer" OFF)
     option(iubs2k_enable_address_sanitizer "Enable address sanitizer" OFF)
     option(iubs2k_build_tests "Build unit tests" OFF)
+    option(iubs2k_build_benchmarks "Build benchmarks" OFF)
 endif ()
 
 add_library(iubs2k_warnings INTERFACE)
@@ -1,29 +1,58 @@
 #include <assembler/assembler.hpp>
-#include "parser.hpp"
+#include <assembler/module.hpp>
+#include "cache.hpp"
 
 namespace assembler {
-    [[nodiscard]] tl::expected<std::vector<::Instruction>, Error> assemble(
-        std::string_view const filename,
-        std::string_view const source
+    [[nodiscard]] tl::expected<InstructionStore, Error> assemble(
+        SourceFile const& source_file,
+        Options const& options
     ) {
-        auto lexer = Lexer{ filename, source };
-        if (auto const result = lexer.tokenize(); not result.has_value()) {
-            return tl::unexpected{ result.error() };
+        if (options.cache_directory.has_value()) {
+            auto const image = assemble_image(source_file, options);
+            if (not image.has_value()) {
+                return tl::unexpected{ image.error() };
+            }
+            return decode(image->bytes());
         }
-        auto parser = Parser{ std::move(lexer).take() };
-        if (auto const result = parser.parse(); not result.has_value()) {
-            return tl::unexpected{ result.error() };
+
+        auto module = Module{ options };
+        if (auto const assigned = module.assign(source_file); not assigned.has_value()) {
+            return tl::unexpected{ assigned.error() };
         }
-        auto const instructions = std::move(parser).take();
+        return module.link();
+    }
 
-        auto result = std::vector<::Instruction>{};
-        for (auto const& instruction : instructions) {
-            auto lowered = instruction.lower();
-            if (not lowered.has_value()) {
-                return tl::unexpected{ lowered.error() };
+    [[nodiscard]] tl::expected<Image, Error> assemble_image(SourceFile const& source_file, Options const& options) {
+        auto key = tl::optional<cache::Key>{};
+        if (options.cache_directory.has_value()) {
+            key = cache::key(source_file, options);
+            if (auto image = cache::load(options.cache_directory.value(), key.value()); image.has_value()) {
+                return std::move(image).value();
             }
-            result.push_back(std::move(lowered).value());
         }
-        return result;
+
+        auto module = Module{ options };
+        if (auto const assigned = module.assign(source_file); not assigned.has_value()) {
+            return tl::unexpected{ assigned.error() };
+        }
+        auto const instructions = module.link();
+        if (not instructions.has_value()) {
+            return tl::unexpected{ instructions.error() };
+        }
+        auto image = Image{ instructions->encode(), module.symbols(), module.source_map() };
+
+        if (key.has_value()) {
+            cache::store(options.cache_directory.value(), key.value(), image);
+        }
+        return image;
+    }
+
+    [[nodiscard]] std::vector<Error> collect_errors(
+        SourceFile const& source_file,
+        usize const max_errors,
+        Options const& options
+    ) {
+        auto module = Module{ options };
+        return module.assign_recovering(source_file, max_errors);
     }
 }  // namespace assembler
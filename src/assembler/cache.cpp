@@ -0,0 +1,206 @@
+#include <array>
+#include <assembler/assembler.hpp>
+#include <bit>
+#include <common/byte_stream.hpp>
+#include <common/mapped_file.hpp>
+#include <common/memory.hpp>
+#include "cache.hpp"
+
+namespace assembler::cache {
+    namespace {
+        // File layout (all integers little endian):
+        //   header: magic, format version, image offset, image size, metadata offset, metadata size (u64 each)
+        //   image:  the encoded instructions, starting at an aligned offset
+        //   metadata: number of symbols (u64), then per symbol: address (u32), name length (u32), name,
+        //             then the size of the serialized source map (u64) and the source map
+        inline constexpr auto magic = u64{ 0x43'41'4B'32'53'42'55'49 };  // "IUBS2KAC"
+        inline constexpr auto format_version = u64{ 3 };
+        inline constexpr auto header_size = usize{ 6 * sizeof(u64) };
+        inline constexpr auto image_alignment = usize{ 64 };
+
+        [[nodiscard]] constexpr u64 mix(u64 value) {
+            value ^= value >> 30;
+            value *= u64{ 0xBF58476D1CE4E5B9 };
+            value ^= value >> 27;
+            value *= u64{ 0x94D049BB133111EB };
+            value ^= value >> 31;
+            return value;
+        }
+
+        // Two independently seeded lanes, consuming eight bytes per step.
+        class Hasher final {
+        private:
+            u64 m_high = 0x9E37'79B9'7F4A'7C15;
+            u64 m_low = 0xC2B2'AE3D'27D4'EB4F;
+            u64 m_length = 0;
+
+        public:
+            void update(u64 const word) {
+                m_high = std::rotl((m_high ^ word) * u64{ 0x87C3'7B91'1142'53D5 }, 31);
+                m_low = std::rotl((m_low + word) * u64{ 0x4CF5'AD43'2745'937F }, 29) ^ m_high;
+                ++m_length;
+            }
+
+            // The length is hashed as well, so that consecutive fields cannot be confused.
+            void update(std::string_view const bytes) {
+                update(u64{ bytes.length() });
+                auto index = usize{ 0 };
+                for (; index + sizeof(u64) <= bytes.length(); index += sizeof(u64)) {
+                    update(load_little_endian<u64>(std::as_bytes(std::span{ bytes }).data() + index));
+                }
+                auto tail = u64{ 0 };
+                for (auto shift = 0; index < bytes.length(); ++index, shift += 8) {
+                    tail |= u64{ static_cast<u8>(bytes[index]) } << shift;
+                }
+                update(tail);
+            }
+
+            [[nodiscard]] Key finish() const {
+                return Key{ mix(m_high ^ m_length), mix(m_low + m_high) };
+            }
+        };
+
+        [[nodiscard]] tl::optional<std::span<std::byte const>> section_of(
+            std::span<std::byte const> const file,
+            u64 const offset,
+            u64 const size
+        ) {
+            if (offset > file.size() or size > file.size() - offset) {
+                return tl::nullopt;
+            }
+            return file.subspan(static_cast<usize>(offset), static_cast<usize>(size));
+        }
+
+        [[nodiscard]] tl::optional<std::vector<Symbol>> read_symbols(ByteReader& reader) {
+            auto const num_symbols = reader.read<u64>();
+            if (not num_symbols.has_value()) {
+                return tl::nullopt;
+            }
+            auto symbols = std::vector<Symbol>{};
+            for (auto i = u64{ 0 }; i < num_symbols.value(); ++i) {
+                auto const address = reader.read<u32>();
+                auto const name_length = reader.read<u32>();
+                if (not address.has_value() or not name_length.has_value()) {
+                    return tl::nullopt;
+                }
+                auto const name = reader.read(name_length.value());
+                if (not name.has_value()) {
+                    return tl::nullopt;
+                }
+                symbols.push_back(Symbol{
+                    std::string{ reinterpret_cast<char const*>(name->data()), name->size() },
+                    Word{ address.value() },
+                });
+            }
+            return symbols;
+        }
+
+        [[nodiscard]] tl::optional<SourceMap> read_source_map(ByteReader& reader) {
+            auto const size = reader.read<u64>();
+            if (not size.has_value()) {
+                return tl::nullopt;
+            }
+            auto const bytes = reader.read(static_cast<usize>(size.value()));
+            if (not bytes.has_value()) {
+                return tl::nullopt;
+            }
+            return SourceMap::deserialize(bytes.value());
+        }
+
+        [[nodiscard]] std::filesystem::path entry_path(std::filesystem::path const& directory, Key const& key) {
+            return directory / (key.to_string() + ".img");
+        }
+    }  // namespace
+
+    [[nodiscard]] std::string Key::to_string() const {
+        return fmt::format("{:016x}{:016x}", high, low);
+    }
+
+    [[nodiscard]] Key key(SourceFile const& source_file, Options const& options) {
+        auto hasher = Hasher{};
+        hasher.update(version);
+        hasher.update(u64{ options.base_address });
+        hasher.update(u64{ options.optimize });
+        hasher.update(source_file.filename());
+        hasher.update(source_file.source());
+        return hasher.finish();
+    }
+
+    [[nodiscard]] tl::optional<Image> load(std::filesystem::path const& directory, Key const& key) {
+        auto file = MappedFile::open(entry_path(directory, key));
+        if (not file.has_value()) {
+            return tl::nullopt;
+        }
+        auto const bytes = file->bytes();
+        auto header = ByteReader{ bytes };
+        auto const file_magic = header.read<u64>();
+        auto const file_format_version = header.read<u64>();
+        auto const image_offset = header.read<u64>();
+        auto const image_size = header.read<u64>();
+        auto const metadata_offset = header.read<u64>();
+        auto const metadata_size = header.read<u64>();
+        if (not metadata_size.has_value() or file_magic.value() != magic
+            or file_format_version.value() != format_version) {
+            return tl::nullopt;
+        }
+        auto const image = section_of(bytes, image_offset.value(), image_size.value());
+        auto const metadata = section_of(bytes, metadata_offset.value(), metadata_size.value());
+        if (not image.has_value() or not metadata.has_value()) {
+            return tl::nullopt;
+        }
+        auto metadata_reader = ByteReader{ metadata.value() };
+        auto symbols = read_symbols(metadata_reader);
+        if (not symbols.has_value()) {
+            return tl::nullopt;
+        }
+        auto source_map = read_source_map(metadata_reader);
+        if (not source_map.has_value()) {
+            return tl::nullopt;
+        }
+        return Image{
+            std::move(file).value(),
+            image.value(),
+            std::move(symbols).value(),
+            std::move(source_map).value(),
+        };
+    }
+
+    void store(std::filesystem::path const& directory, Key const& key, Image const& image) {
+        auto writer = ByteWriter{};
+        for (auto i = usize{ 0 }; i < header_size / sizeof(u64); ++i) {
+            writer.write(u64{ 0 });
+        }
+        writer.pad_to(image_alignment);
+        auto const image_offset = writer.size();
+        writer.write(image.bytes());
+        auto const metadata_offset = writer.size();
+        writer.write(u64{ image.symbols().size() });
+        for (auto const& symbol : image.symbols()) {
+            writer.write(u32{ symbol.address });
+            writer.write(static_cast<u32>(symbol.name.length()));
+            writer.write(std::as_bytes(std::span{ symbol.name }));
+        }
+        auto const source_map = image.source_map().serialize();
+        writer.write(u64{ source_map.size() });
+        writer.write(source_map);
+        auto const header = std::array{
+            magic,
+            format_version,
+            u64{ image_offset },
+            u64{ image.bytes().size() },
+            u64{ metadata_offset },
+            u64{ writer.size() - metadata_offset },
+        };
+        for (auto i = usize{ 0 }; i < header.size(); ++i) {
+            writer.overwrite(i * sizeof(u64), header[i]);
+        }
+
+        // Concurrent readers never see partial entries. A failed write only means that the entry is missing.
+        auto error = std::error_code{};
+        std::filesystem::create_directories(directory, error);
+        if (error) {
+            return;
+        }
+        [[maybe_unused]] auto const written = write_file_atomically(entry_path(directory, key), writer.bytes());
+    }
+}  // namespace assembler::cache
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <assembler/image.hpp>
+#include <assembler/options.hpp>
+#include <assembler/source_file.hpp>
+#include <filesystem>
+#include <string>
+#include <tl/optional.hpp>
+
+// Content-addressed on-disk cache of assembled images. Entries are named after a hash of everything
+// that influences the output, so they never have to be invalidated. The hash is not cryptographic,
+// so the cache directory must only be writable by trusted users.
+namespace assembler::cache {
+    struct Key final {
+        u64 high;
+        u64 low;
+
+        [[nodiscard]] std::string to_string() const;
+    };
+
+    [[nodiscard]] Key key(SourceFile const& source_file, Options const& options);
+
+    // Returns nothing if there is no valid entry for the key.
+    [[nodiscard]] tl::optional<Image> load(std::filesystem::path const& directory, Key const& key);
+
+    // Failing to store an entry is not an error, it only costs a cache miss later on.
+    void store(std::filesystem::path const& directory, Key const& key, Image const& image);
+}  // namespace assembler::cache
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include "chunk.hpp"
+#include "parser.hpp"
+
+namespace assembler {
+    namespace {
+        // Instructions that fail to lower are left out. Errors are only recorded while `errors` holds fewer
+        // than `max_errors`.
+        void lower(
+            Ast const& ast,
+            Section& section,
+            bool const optimize,
+            std::vector<Error>& errors,
+            usize const max_errors,
+            std::pmr::memory_resource* const memory_resource
+        ) {
+            auto const instructions = ast.instructions();
+            auto const labels = ast.labels();
+            auto lowered_instructions = std::pmr::vector<LoweredInstruction>{ memory_resource };
+            lowered_instructions.reserve(instructions.size());
+            auto label_indices = std::pmr::vector<u32>{ memory_resource };  // Indices into `lowered_instructions`.
+            label_indices.reserve(labels.size());
+            for (auto i = usize{ 0 }; i < instructions.size(); ++i) {
+                while (label_indices.size() < labels.size() and labels[label_indices.size()].instruction_index <= i) {
+                    label_indices.push_back(static_cast<u32>(lowered_instructions.size()));
+                }
+                auto lowered = instructions[i].lower(ast);
+                if (not lowered.has_value()) {
+                    if (errors.size() < max_errors) {
+                        errors.push_back(lowered.error());
+                    }
+                    continue;
+                }
+                lowered_instructions.push_back(std::move(lowered).value());
+            }
+            label_indices.resize(labels.size(), static_cast<u32>(lowered_instructions.size()));
+
+            if (optimize) {
+                section.optimization_report = assembler::optimize(lowered_instructions, label_indices);
+            }
+
+            section.instructions.reserve(lowered_instructions.size());
+            section.source_offsets.reserve(lowered_instructions.size());
+            auto next_label = usize{ 0 };
+            auto const add_labels_up_to = [&](usize const instruction_index) {
+                while (next_label < label_indices.size() and label_indices[next_label] <= instruction_index) {
+                    section.labels.push_back(Section::Label{ ast.labels()[next_label].name, section.byte_length });
+                    ++next_label;
+                }
+            };
+            for (auto i = usize{ 0 }; i < lowered_instructions.size(); ++i) {
+                add_labels_up_to(i);
+                auto& lowered = lowered_instructions[i];
+                if (lowered.symbol.has_value()) {
+                    section.relocations.push_back(Section::Relocation{ static_cast<u32>(i), lowered.symbol.value() });
+                }
+                section.byte_length += static_cast<Word>(lowered.instruction.byte_length());
+                section.instructions.push_back(std::move(lowered.instruction));
+                section.source_offsets.push_back(lowered.source_offset);
+            }
+            // Labels at the end of the section refer to whatever follows it.
+            add_labels_up_to(lowered_instructions.size());
+        }
+
+        [[nodiscard]] tl::optional<u32> position_of(Error const& error) {
+            return error.source_location().map([](SourceLocation const& location) { return location.offset(); });
+        }
+    }  // namespace
+
+    [[nodiscard]] ChunkArena::ChunkArena(std::pmr::memory_resource* const upstream)
+        : m_upstream{ upstream } {}
+
+    ChunkArena::~ChunkArena() {
+        m_resource.reset();
+        if (m_buffer != nullptr) {
+            m_upstream.deallocate(m_buffer, m_size, alignof(std::max_align_t));
+        }
+    }
+
+    [[nodiscard]] std::pmr::memory_resource* ChunkArena::next_chunk() {
+        m_resource.reset();
+        // A monotonic resource never frees anything on its own, so all bytes it requested from upstream since
+        // the last chunk are what did not fit into the buffer.
+        auto const num_upstream_bytes = m_upstream.statistics().num_bytes;
+        auto const overflow = num_upstream_bytes - m_num_upstream_bytes;
+        if (overflow > 0) {
+            if (m_buffer != nullptr) {
+                m_upstream.deallocate(m_buffer, m_size, alignof(std::max_align_t));
+                m_buffer = nullptr;
+            }
+            auto const size = m_size + overflow;
+            m_buffer = m_upstream.allocate(size, alignof(std::max_align_t));
+            m_size = size;
+        }
+        m_num_upstream_bytes = m_upstream.statistics().num_bytes;
+        if (m_buffer == nullptr) {
+            m_resource.emplace(&m_upstream);
+        } else {
+            m_resource.emplace(m_buffer, m_size, &m_upstream);
+        }
+        return &m_resource.value();
+    }
+
+    [[nodiscard]] ChunkResult assemble_chunk(
+        SourceFile const& source_file,
+        Chunk const chunk,
+        bool const optimize,
+        std::pmr::memory_resource* const memory_resource
+    ) {
+        auto result = ChunkResult{};
+        result.section.source_file = &source_file;
+        auto phase = Phase::Lexing;
+        try {
+            auto lexer = Lexer{ source_file, chunk.begin, chunk.end, memory_resource };
+            if (auto const tokenized = lexer.tokenize(); not tokenized.has_value()) {
+                result.failed_phase = phase;
+                result.error = tokenized.error();
+                return result;
+            }
+
+            phase = Phase::Parsing;
+            auto parser = Parser{ std::move(lexer).take() };
+            if (auto const parsed = parser.parse(); not parsed.has_value()) {
+                result.failed_phase = phase;
+                result.error = parsed.error();
+                return result;
+            }
+            auto const ast = std::move(parser).take();
+
+            phase = Phase::Lowering;
+            auto errors = std::vector<Error>{};
+            lower(ast, result.section, optimize, errors, 1, memory_resource);
+            if (not errors.empty()) {
+                result.failed_phase = phase;
+                result.error = std::move(errors.front());
+                return result;
+            }
+        } catch (...) {
+            result.failed_phase = phase;
+            result.exception = std::current_exception();
+        }
+        return result;
+    }
+
+    void sort_by_position(std::vector<Error>& errors) {
+        std::ranges::stable_sort(errors, [](Error const& lhs, Error const& rhs) {
+            auto const left = position_of(lhs);
+            auto const right = position_of(rhs);
+            return left.has_value() and (not right.has_value() or left.value() < right.value());
+        });
+    }
+
+    [[nodiscard]] ChunkResult assemble_chunk_recovering(
+        SourceFile const& source_file,
+        Chunk const chunk,
+        bool const optimize,
+        usize const max_errors,
+        std::pmr::memory_resource* const memory_resource
+    ) {
+        auto result = ChunkResult{};
+        result.section.source_file = &source_file;
+        auto& errors = result.errors;
+        try {
+            // Every phase processes all of its input, but records only the first `max_errors` errors it finds.
+            // Together, they contain the first `max_errors` errors in source order.
+            auto lexer = Lexer{ source_file, chunk.begin, chunk.end, memory_resource };
+            lexer.tokenize_recovering(errors, max_errors);
+            auto parser = Parser{ std::move(lexer).take() };
+            auto parse_errors = std::vector<Error>{};
+            parser.parse_recovering(parse_errors, max_errors);
+            auto const ast = std::move(parser).take();
+            auto lower_errors = std::vector<Error>{};
+            lower(ast, result.section, optimize, lower_errors, max_errors, memory_resource);
+
+            errors.insert(errors.end(), parse_errors.begin(), parse_errors.end());
+            errors.insert(errors.end(), lower_errors.begin(), lower_errors.end());
+            sort_by_position(errors);
+            if (errors.size() > max_errors) {
+                errors.erase(errors.begin() + static_cast<std::ptrdiff_t>(max_errors), errors.end());
+            }
+        } catch (...) {
+            result.exception = std::current_exception();
+        }
+        return result;
+    }
+
+    void patch_immediate(::Instruction& instruction, Word const value) {
+        std::visit(
+            [&](auto& inst) {
+                if constexpr (requires { inst.immediate = value; }) {
+                    inst.immediate = value;
+                } else {
+                    throw std::logic_error{ "Relocated instruction has no immediate operand." };
+                }
+            },
+            instruction
+        );
+    }
+
+    Word add_to_source_map(SourceMap::Builder& builder, Section const& section, Word address) {
+        for (auto i = usize{ 0 }; i < section.instructions.size(); ++i) {
+            auto const offset = section.source_offsets[i];
+            auto const& source_file = *section.source_file;
+            auto const row = static_cast<u32>(source_file.row(offset));
+            auto const column = static_cast<u32>(source_file.column(offset));
+            builder.add(address, source_file.filename(), row, column);
+            address += static_cast<Word>(section.instructions[i].byte_length());
+        }
+        return address;
+    }
+
+    [[nodiscard]] std::vector<Chunk> split(std::string_view const source) {
+        // Chunks depend on neither the number of threads nor the parallel threshold, so neither do section
+        // boundaries (which the optimiser treats as barriers) and thus the output. Many more chunks than
+        // threads for large sources even out chunks that take longer than others.
+        static constexpr auto max_length = usize{ 1 } << 16;
+
+        auto chunks = std::vector<Chunk>{};
+        auto begin = usize{ 0 };
+        while (begin < source.length()) {
+            auto end = source.length();
+            if (source.length() - begin > max_length) {
+                auto const newline = source.find('\n', begin + max_length);
+                end = newline == std::string_view::npos ? source.length() : newline + 1;
+            }
+            chunks.push_back(Chunk{ begin, end });
+            begin = end;
+        }
+        if (chunks.empty()) {
+            chunks.push_back(Chunk{ 0, source.length() });
+        }
+        return chunks;
+    }
+}  // namespace assembler
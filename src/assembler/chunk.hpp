@@ -0,0 +1,113 @@
+#pragma once
+
+#include <assembler/counting_resource.hpp>
+#include <assembler/error.hpp>
+#include <assembler/optimizer.hpp>
+#include <assembler/options.hpp>
+#include <assembler/source_file.hpp>
+#include <common/instruction.hpp>
+#include <common/source_map.hpp>
+#include <exception>
+#include <memory_resource>
+#include <string_view>
+#include <tl/optional.hpp>
+#include <vector>
+
+// Assembling independent parts of a source file, shared by Module and stream().
+namespace assembler {
+    // Labels and relocations are relative to the start of the section.
+    struct Section final {
+        struct Label final {
+            Token name;
+            Word offset;
+        };
+
+        struct Relocation final {
+            u32 instruction_index;
+            Token symbol;
+        };
+
+        SourceFile const* source_file = nullptr;
+        std::vector<::Instruction> instructions;
+        std::vector<u32> source_offsets;  // Of every instruction, for the source map.
+        std::vector<Label> labels;
+        std::vector<Relocation> relocations;
+        Word byte_length = 0;
+        Word offset = 0;  // Relative to the start of the module. Assigned during linking.
+        OptimizationReport optimization_report;
+    };
+
+    // Order in which a sequential assembler would run into errors.
+    enum class Phase {
+        Lexing,
+        Parsing,
+        Lowering,
+    };
+
+    struct Chunk final {
+        usize begin;
+        usize end;
+    };
+
+    struct ChunkResult final {
+        Section section;
+        tl::optional<Phase> failed_phase;
+        tl::optional<Error> error;
+        std::vector<Error> errors;  // Only used when recovering from errors.
+        std::exception_ptr exception;
+    };
+
+    // Memory for the temporaries of one chunk at a time. Everything of a chunk is released at once when
+    // the next one starts. The arena keeps a buffer that grows to what the largest chunk so far needed, so
+    // after the first chunk or two, nothing is allocated from the upstream resource anymore. Not thread-safe.
+    class ChunkArena final {
+    private:
+        CountingResource m_upstream;  // Tells how much a chunk did not fit into the buffer.
+        u64 m_num_upstream_bytes = 0;
+        void* m_buffer = nullptr;
+        usize m_size = 0;
+        tl::optional<std::pmr::monotonic_buffer_resource> m_resource;
+
+    public:
+        [[nodiscard]] explicit ChunkArena(std::pmr::memory_resource* upstream);
+
+        ChunkArena(ChunkArena const&) = delete;
+        ChunkArena& operator=(ChunkArena const&) = delete;
+
+        ~ChunkArena();
+
+        // Releases everything allocated for the previous chunk.
+        [[nodiscard]] std::pmr::memory_resource* next_chunk();
+    };
+
+    // The result does not refer to memory of `memory_resource`, which is only used for temporaries.
+    [[nodiscard]] ChunkResult assemble_chunk(
+        SourceFile const& source_file,
+        Chunk chunk,
+        bool optimize,
+        std::pmr::memory_resource* memory_resource
+    );
+
+    // Like assemble_chunk(), but skips the rest of the offending line after an error. Collects the first
+    // `max_errors` errors of the chunk in source order.
+    [[nodiscard]] ChunkResult assemble_chunk_recovering(
+        SourceFile const& source_file,
+        Chunk chunk,
+        bool optimize,
+        usize max_errors,
+        std::pmr::memory_resource* memory_resource
+    );
+
+    // Errors without a source location go last.
+    void sort_by_position(std::vector<Error>& errors);
+
+    // Fills in the address of the symbol that a relocation refers to.
+    void patch_immediate(::Instruction& instruction, Word value);
+
+    // Adds the instructions of a section placed at `address`. Returns the address behind the section.
+    Word add_to_source_map(SourceMap::Builder& builder, Section const& section, Word address);
+
+    // Splits the source into chunks that each start at the beginning of a line. Since instructions never
+    // span multiple lines, every chunk can be assembled on its own. Chunks are roughly 64 KiB long.
+    [[nodiscard]] std::vector<Chunk> split(std::string_view source);
+}  // namespace assembler
@@ -0,0 +1,33 @@
+#include <assembler/counting_resource.hpp>
+
+namespace assembler {
+    [[nodiscard]] CountingResource::CountingResource(std::pmr::memory_resource* const upstream)
+        : m_upstream{ upstream } {}
+
+    [[nodiscard]] AllocationStatistics CountingResource::statistics() const {
+        return AllocationStatistics{
+            m_num_allocations.load(std::memory_order_relaxed),
+            m_num_bytes.load(std::memory_order_relaxed),
+            m_peak_bytes.load(std::memory_order_relaxed),
+        };
+    }
+
+    [[nodiscard]] void* CountingResource::do_allocate(usize const bytes, usize const alignment) {
+        auto const result = m_upstream->allocate(bytes, alignment);
+        m_num_allocations.fetch_add(1, std::memory_order_relaxed);
+        m_num_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        auto const current = m_current_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        auto peak = m_peak_bytes.load(std::memory_order_relaxed);
+        while (current > peak and not m_peak_bytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) { }
+        return result;
+    }
+
+    void CountingResource::do_deallocate(void* const pointer, usize const bytes, usize const alignment) {
+        m_upstream->deallocate(pointer, bytes, alignment);
+        m_current_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool CountingResource::do_is_equal(std::pmr::memory_resource const& other) const noexcept {
+        return this == &other;
+    }
+}  // namespace assembler
@@ -0,0 +1,32 @@
+#include <algorithm>
+#include <assembler/diagnostic.hpp>
+#include <iterator>
+
+namespace assembler {
+    [[nodiscard]] std::string render(Error const& error) {
+        auto const source_location = error.source_location();
+        if (not source_location.has_value()) {
+            return fmt::format("Error: {}\n", error);
+        }
+        auto const& location = source_location.value();
+        auto const num_digits = static_cast<int>(std::to_string(location.row()).length());
+        auto const surrounding_line = location.surrounding_line();
+        auto const offset = std::distance(surrounding_line.data(), location.lexeme().data());
+        auto const underline_length = std::max(location.lexeme().length(), usize{ 1 }) - 1;
+        return fmt::format(
+            "{}:{}:{}: {}\n{} | {}\n{:{}} | {:>{}}{:~>{}}^\n",
+            location.filename(),
+            location.row(),
+            location.column(),
+            error,
+            location.row(),
+            surrounding_line,
+            "",
+            num_digits,
+            "",
+            offset,
+            "",
+            underline_length
+        );
+    }
+}  // namespace assembler
@@ -1,12 +1,55 @@
 #pragma once
 
-#include <common/instruction.hpp>
+#include <common/instruction_store.hpp>
+#include <cstddef>
+#include <functional>
+#include <span>
 #include <string_view>
+#include <vector>
 #include "error.hpp"
+#include "image.hpp"
+#include "options.hpp"
+#include "source_file.hpp"
 
 namespace assembler {
-    [[nodiscard]] tl::expected<std::vector<::Instruction>, Error> assemble(
-        std::string_view filename,
-        std::string_view source
+    // Part of the cache key. Must be changed whenever the same source would assemble differently.
+    inline constexpr auto version = std::string_view{ "0.2.0" };
+
+    // Errors are deterministic and independent of the number of threads: they are exactly the ones
+    // that a strictly sequential lex → parse → lower → link pipeline would report.
+    [[nodiscard]] tl::expected<InstructionStore, Error> assemble(
+        SourceFile const& source_file,
+        Options const& options = {}
+    );
+
+    // Like assemble(), but returns the encoded program. With a cache directory, an unchanged source
+    // skips lexing, parsing and lowering and the image is memory mapped from the cache.
+    [[nodiscard]] tl::expected<Image, Error> assemble_image(SourceFile const& source_file, Options const& options = {});
+
+    // Receives the encoded program piece by piece, in order.
+    using Sink = std::function<void(std::span<std::byte const>)>;
+
+    // Everything stream() produces besides the bytes.
+    struct StreamResult final {
+        std::vector<Symbol> symbols;
+        SourceMap source_map;
+    };
+
+    // Like assemble_image(), but never holds the tokens, syntax trees and instructions of more than one
+    // chunk of about 64 KiB of the source. A first pass only lays out the labels, a second one assembles
+    // again and hands the encoded bytes to the sink. Ignores the cache. On an undefined symbol, the sink may
+    // already have received the bytes in front of it.
+    [[nodiscard]] tl::expected<StreamResult, Error> stream(
+        SourceFile const& source_file,
+        Sink const& sink,
+        Options const& options = {}
+    );
+
+    // Assembles in one error-recovering pass: after an error, the rest of the offending line is skipped.
+    // Returns the first `max_errors` errors in source order, or nothing if the source assembles.
+    [[nodiscard]] std::vector<Error> collect_errors(
+        SourceFile const& source_file,
+        usize max_errors,
+        Options const& options = {}
     );
-}
+}  // namespace assembler
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory_resource>
+#include <span>
+#include <vector>
+#include "instruction.hpp"
+#include "operand.hpp"
+
+namespace assembler {
+    // A label refers to the instruction following it (or to the end of the program).
+    struct Label final {
+        Token name;
+        u32 instruction_index;
+    };
+
+    // All instructions, operands and labels of a parsed program. Operands live in a single contiguous
+    // buffer, the operands of each instruction form a consecutive range within it. Nothing is
+    // allocated per node, and the whole tree is released at once. All of it comes from one memory resource.
+    class Ast final {
+    private:
+        std::pmr::vector<Instruction> m_instructions;
+        std::pmr::vector<Operand> m_operands;
+        std::pmr::vector<Label> m_labels;
+
+    public:
+        [[nodiscard]] explicit Ast(std::pmr::memory_resource* const memory_resource = std::pmr::get_default_resource())
+            : m_instructions{ memory_resource }, m_operands{ memory_resource }, m_labels{ memory_resource } {}
+
+        [[nodiscard]] std::span<Instruction const> instructions() const {
+            return m_instructions;
+        }
+
+        [[nodiscard]] std::span<Operand const> operands(Instruction const& instruction) const {
+            return std::span{ m_operands }.subspan(instruction.first_operand(), instruction.num_operands());
+        }
+
+        [[nodiscard]] std::span<Label const> labels() const {
+            return m_labels;
+        }
+
+        [[nodiscard]] Operand const& pointee(Operand const& pointer) const {
+            return m_operands.at(pointer.pointee_index());
+        }
+
+        [[nodiscard]] u32 add_operand(Operand const& operand) {
+            m_operands.push_back(operand);
+            return static_cast<u32>(m_operands.size() - 1);
+        }
+
+        void add_label(Token const& name) {
+            m_labels.push_back(Label{ name, static_cast<u32>(m_instructions.size()) });
+        }
+
+        // Appends the given operands as the consecutive operand range of a new instruction.
+        void add_instruction(Token const& mnemonic, std::span<Operand const> const operands) {
+            auto const first_operand = static_cast<u32>(m_operands.size());
+            m_operands.insert(m_operands.end(), operands.begin(), operands.end());
+            m_instructions.emplace_back(mnemonic, first_operand, static_cast<u32>(operands.size()));
+        }
+    };
+}  // namespace assembler
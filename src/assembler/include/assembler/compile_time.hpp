@@ -0,0 +1,366 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <assembler/mnemonics.hpp>
+#include <assembler/scanner.hpp>
+#include <assembler/token.hpp>
+#include <common/instruction.hpp>
+#include <common/register.hpp>
+#include <cstddef>
+#include <iterator>
+#include <lib2k/types.hpp>
+#include <limits>
+#include <magic_enum.hpp>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Assembles programs during constant evaluation, for programs that are embedded into the executable. It
+// shares the character classes, the mnemonic table and the instruction encoders with the runtime path, but
+// lexes and parses on its own. test/compile_time_tests.cpp checks that both accept the same sources and
+// produce the same bytes as an unoptimized runtime build, including the limit of Token::max_length.
+// Assembly errors are compile errors: the diagnostic points at the `throw` that names the problem.
+namespace assembler::compile_time {
+    // A string literal usable as template argument.
+    template<usize size>
+    struct Source final {
+        std::array<char, size> characters{};
+
+        // NOLINTNEXTLINE(google-explicit-constructor): Implicit to allow `assemble<"...">()`.
+        consteval Source(char const (&literal)[size]) {
+            std::copy_n(literal, size, characters.begin());
+        }
+
+        [[nodiscard]] constexpr std::string_view view() const {
+            return std::string_view{ characters.data(), size - 1 };
+        }
+    };
+
+    namespace detail {
+        enum class TokenType : u8 {
+            Identifier,
+            Register,
+            Integer,
+            Comma,
+            Asterisk,
+            Colon,
+            Newline,
+            EndOfInput,
+        };
+
+        struct Token final {
+            TokenType type;
+            std::string_view lexeme;
+        };
+
+        [[nodiscard]] constexpr bool is_identifier_start(char const c) {
+            return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z');
+        }
+
+        [[nodiscard]] constexpr std::vector<Token> tokenize(std::string_view const source) {
+            auto tokens = std::vector<Token>{};
+            auto index = usize{ 0 };
+            auto const emit = [&](TokenType const type, usize const start) {
+                if (index - start > assembler::Token::max_length) {
+                    throw "Token too long.";
+                }
+                tokens.push_back(Token{ type, source.substr(start, index - start) });
+            };
+            while (true) {
+                index = scanner::skip<scanner::HorizontalWhitespace>(source, index);
+                if (index >= source.length()) {
+                    emit(TokenType::EndOfInput, index);
+                    return tokens;
+                }
+                auto const start = index;
+                auto const c = source[index];
+                if (c == ';') {
+                    index = scanner::skip<scanner::AnythingButNewline>(source, index);
+                    continue;
+                }
+                if (c == '\n' or c == ',' or c == '*' or c == ':') {
+                    ++index;
+                    using enum TokenType;
+                    emit(c == '\n' ? Newline : c == ',' ? Comma : c == '*' ? Asterisk : Colon, start);
+                    continue;
+                }
+                if (scanner::DecimalDigit::matches(c)) {
+                    auto const is_hexadecimal = source.substr(index).starts_with("0x") and index + 2 < source.length()
+                                                and scanner::HexadecimalDigit::matches(source[index + 2]);
+                    index = is_hexadecimal ? scanner::skip<scanner::HexadecimalDigit>(source, index + 2)
+                                           : scanner::skip<scanner::DecimalDigit>(source, index);
+                    emit(TokenType::Integer, start);
+                    continue;
+                }
+                if (is_identifier_start(c)) {
+                    index = scanner::skip<scanner::IdentifierContinuation>(source, index + 1);
+                    auto const is_register = magic_enum::enum_cast<Register>(source.substr(start, index - start));
+                    emit(is_register ? TokenType::Register : TokenType::Identifier, start);
+                    continue;
+                }
+                throw "Invalid character.";
+            }
+        }
+
+        [[nodiscard]] constexpr Word parse_integer(std::string_view lexeme) {
+            auto const is_hexadecimal = lexeme.starts_with("0x");
+            auto const base = Word{ is_hexadecimal ? 16U : 10U };
+            if (is_hexadecimal) {
+                lexeme.remove_prefix(2);
+            }
+            auto result = u64{ 0 };
+            for (auto const c : lexeme) {
+                auto const digit = scanner::DecimalDigit::matches(c) ? c - '0'
+                                   : c >= 'a'                        ? c - 'a' + 10
+                                                                     : c - 'A' + 10;
+                result = result * base + static_cast<u64>(digit);
+                if (result > std::numeric_limits<Word>::max()) {
+                    throw "Invalid integer.";
+                }
+            }
+            return static_cast<Word>(result);
+        }
+
+        enum class OperandKind : u8 {
+            Immediate,
+            Register,
+            Identifier,
+            Pointer,
+        };
+
+        // Pointers only keep their direct pointee, nothing but a register is a valid pointee anyway.
+        struct Operand final {
+            OperandKind kind;
+            std::string_view lexeme;
+            OperandKind pointee_kind = OperandKind::Immediate;
+        };
+
+        struct Statement final {
+            std::string_view mnemonic;
+            std::vector<Operand> operands;
+        };
+
+        struct Label final {
+            std::string_view name;
+            usize statement_index;
+        };
+
+        struct Program final {
+            std::vector<Statement> statements;
+            std::vector<Label> labels;
+        };
+
+        // Mirrors Parser, including which token sequences it accepts.
+        class Parser final {
+        private:
+            std::vector<Token> m_tokens;
+            usize m_index = 0;
+
+        public:
+            [[nodiscard]] constexpr explicit Parser(std::vector<Token> tokens)
+                : m_tokens{ std::move(tokens) } {}
+
+            [[nodiscard]] constexpr Program parse() {
+                auto program = Program{};
+                while (true) {
+                    while (current().type == TokenType::Newline) {
+                        advance();
+                    }
+                    if (current().type == TokenType::EndOfInput) {
+                        return program;
+                    }
+                    if (current().type == TokenType::Identifier and peek().type == TokenType::Colon) {
+                        program.labels.push_back(Label{ current().lexeme, program.statements.size() });
+                        advance();
+                        advance();
+                        continue;
+                    }
+                    if (current().type != TokenType::Identifier) {
+                        throw "Unexpected token. Expected identifier.";
+                    }
+                    auto statement = Statement{ current().lexeme, {} };
+                    advance();
+                    while (current().type != TokenType::EndOfInput and current().type != TokenType::Newline) {
+                        statement.operands.push_back(operand());
+                        if (current().type != TokenType::Comma) {
+                            break;
+                        }
+                        advance();
+                    }
+                    program.statements.push_back(std::move(statement));
+                }
+            }
+
+        private:
+            [[nodiscard]] constexpr Token const& current() const {
+                return m_tokens[m_index];
+            }
+
+            [[nodiscard]] constexpr Token const& peek() const {
+                return m_tokens[std::min(m_index + 1, m_tokens.size() - 1)];
+            }
+
+            constexpr void advance() {
+                if (current().type != TokenType::EndOfInput) {
+                    ++m_index;
+                }
+            }
+
+            [[nodiscard]] constexpr Operand operand() {
+                auto const token = current();
+                advance();
+                switch (token.type) {
+                    case TokenType::Register:
+                        return Operand{ OperandKind::Register, token.lexeme };
+                    case TokenType::Identifier:
+                        return Operand{ OperandKind::Identifier, token.lexeme };
+                    case TokenType::Integer:
+                        return Operand{ OperandKind::Immediate, token.lexeme };
+                    case TokenType::Asterisk: {
+                        auto const pointee = operand();
+                        return Operand{ OperandKind::Pointer, pointee.lexeme, pointee.kind };
+                    }
+                    default:
+                        throw "Unexpected token. Expected operand.";
+                }
+            }
+        };
+
+        struct LoweredInstruction final {
+            ::Instruction instruction;
+            std::string_view symbol;  // Empty if the instruction does not refer to a symbol.
+        };
+
+        [[nodiscard]] constexpr bool matches(
+            mnemonics::Signature const& signature,
+            std::vector<Operand> const& operands
+        ) {
+            for (auto i = usize{ 0 }; i < operands.size(); ++i) {
+                auto const kind = operands[i].kind;
+                switch (signature.operands[i]) {
+                    case mnemonics::OperandPattern::Immediate:
+                        if (kind != OperandKind::Immediate and kind != OperandKind::Identifier) {
+                            return false;
+                        }
+                        break;
+                    case mnemonics::OperandPattern::Register:
+                        if (kind != OperandKind::Register) {
+                            return false;
+                        }
+                        break;
+                    case mnemonics::OperandPattern::PointerToRegister:
+                        if (kind != OperandKind::Pointer) {
+                            return false;
+                        }
+                        break;
+                }
+            }
+            return true;
+        }
+
+        [[nodiscard]] constexpr LoweredInstruction lower(Statement const& statement) {
+            auto const mnemonic = mnemonics::find(statement.mnemonic);
+            if (mnemonic == nullptr) {
+                throw "Unknown mnemonic.";
+            }
+            if (statement.operands.size() != mnemonic->arity) {
+                throw "Arity mismatch.";
+            }
+            for (auto const& signature : mnemonic->signatures) {
+                if (not matches(signature, statement.operands)) {
+                    continue;
+                }
+                auto values = mnemonics::OperandValues{};
+                auto symbol = std::string_view{};
+                for (auto i = usize{ 0 }; i < statement.operands.size(); ++i) {
+                    auto const& operand = statement.operands[i];
+                    switch (signature.operands[i]) {
+                        case mnemonics::OperandPattern::Immediate:
+                            if (operand.kind == OperandKind::Identifier) {
+                                symbol = operand.lexeme;
+                            } else {
+                                values.immediates[i] = parse_integer(operand.lexeme);
+                            }
+                            break;
+                        case mnemonics::OperandPattern::Register:
+                            values.registers[i] = magic_enum::enum_cast<Register>(operand.lexeme).value();
+                            break;
+                        case mnemonics::OperandPattern::PointerToRegister:
+                            if (operand.pointee_kind != OperandKind::Register) {
+                                throw "Invalid operands.";
+                            }
+                            values.registers[i] = magic_enum::enum_cast<Register>(operand.lexeme).value();
+                            break;
+                    }
+                }
+                return LoweredInstruction{ signature.build(values), symbol };
+            }
+            throw "Invalid operands.";
+        }
+
+        [[nodiscard]] constexpr std::vector<std::byte> assemble(
+            std::string_view const source,
+            Word const base_address
+        ) {
+            auto const program = Parser{ tokenize(source) }.parse();
+
+            auto instructions = std::vector<LoweredInstruction>{};
+            auto offsets = std::vector<Word>{ 0 };  // Byte offset of every statement, plus the end.
+            for (auto const& statement : program.statements) {
+                instructions.push_back(lower(statement));
+                offsets.push_back(offsets.back() + static_cast<Word>(instructions.back().instruction.byte_length()));
+            }
+
+            for (auto i = usize{ 0 }; i < program.labels.size(); ++i) {
+                for (auto j = usize{ 0 }; j < i; ++j) {
+                    if (program.labels[i].name == program.labels[j].name) {
+                        throw "Duplicate label.";
+                    }
+                }
+            }
+
+            auto result = std::vector<std::byte>{};
+            for (auto& [instruction, symbol] : instructions) {
+                if (not symbol.empty()) {
+                    auto const label = std::ranges::find(program.labels, symbol, &Label::name);
+                    if (label == program.labels.end()) {
+                        throw "Undefined symbol.";
+                    }
+                    auto const address = base_address + offsets[label->statement_index];
+                    std::visit(
+                        [&](auto& inst) {
+                            if constexpr (requires { inst.immediate = address; }) {
+                                inst.immediate = address;
+                            }
+                        },
+                        instruction
+                    );
+                }
+                instruction.encode(std::back_inserter(result));
+            }
+            return result;
+        }
+    }  // namespace detail
+
+    // Returns the encoded program, placed at `base_address`.
+    template<Source source, Word base_address = 0>
+    [[nodiscard]] consteval auto assemble() {
+        // Memory allocated during constant evaluation cannot outlive it, so the program is assembled once into
+        // an array that is certainly large enough: no instruction takes more bytes than its shortest spelling
+        // takes characters, e.g. "copy 1,A".
+        constexpr auto assembled = [] {
+            auto const bytes = detail::assemble(source.view(), base_address);
+            auto result = std::pair{ std::array<std::byte, source.view().length()>{}, bytes.size() };
+            if (bytes.size() > result.first.size()) {
+                throw "Program larger than its source.";
+            }
+            std::ranges::copy(bytes, result.first.begin());
+            return result;
+        }();
+        auto result = std::array<std::byte, assembled.second>{};
+        std::ranges::copy_n(assembled.first.begin(), static_cast<std::ptrdiff_t>(result.size()), result.begin());
+        return result;
+    }
+}  // namespace assembler::compile_time
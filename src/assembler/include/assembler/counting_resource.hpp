@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <lib2k/types.hpp>
+#include <memory_resource>
+
+namespace assembler {
+    struct AllocationStatistics final {
+        u64 num_allocations = 0;
+        u64 num_bytes = 0;   // In total, including memory that has been released again.
+        u64 peak_bytes = 0;  // Largest amount held at the same time.
+    };
+
+    // Forwards to another resource and counts what passes through. Pass one as Options::memory_resource to
+    // see how much an assembly allocates. Can be shared between threads.
+    class CountingResource final : public std::pmr::memory_resource {
+    private:
+        std::pmr::memory_resource* m_upstream;
+        std::atomic<u64> m_num_allocations = 0;
+        std::atomic<u64> m_num_bytes = 0;
+        std::atomic<u64> m_current_bytes = 0;
+        std::atomic<u64> m_peak_bytes = 0;
+
+    public:
+        [[nodiscard]] explicit CountingResource(
+            std::pmr::memory_resource* upstream = std::pmr::get_default_resource()
+        );
+
+        [[nodiscard]] AllocationStatistics statistics() const;
+
+    private:
+        [[nodiscard]] void* do_allocate(usize bytes, usize alignment) override;
+
+        void do_deallocate(void* pointer, usize bytes, usize alignment) override;
+
+        [[nodiscard]] bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override;
+    };
+}  // namespace assembler
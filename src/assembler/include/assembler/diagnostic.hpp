@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+#include "error.hpp"
+
+namespace assembler {
+    // Formats an error like a compiler diagnostic: the location and message, followed by the source line
+    // with the offending lexeme underlined. Ends with a newline.
+    [[nodiscard]] std::string render(Error const& error);
+}  // namespace assembler
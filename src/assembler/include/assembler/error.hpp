@@ -1,6 +1,7 @@
 #pragma once
 
 #include <tl/expected.hpp>
+#include <string_view>
 #include <tl/optional.hpp>
 #include <variant>
 #include "source_location.hpp"
@@ -35,12 +36,23 @@ namespace assembler {
         }
     };
 
+    struct TokenTooLong final {
+        SourceLocation source_location;
+
+        [[nodiscard]] explicit TokenTooLong(SourceLocation const& source_location)
+            : source_location{ source_location } {}
+
+        [[nodiscard]] friend std::string format_as(TokenTooLong const&) {
+            return fmt::format("Token exceeds the maximum length of {} characters.", Token::max_length);
+        }
+    };
+
     struct UnexpectedToken final {
         Token token;
-        std::string message;
+        std::string_view message;  // Refers to static text, so that reporting an error does not allocate.
 
-        [[nodiscard]] explicit UnexpectedToken(Token const& token, std::string message)
-            : token{ token }, message{ std::move(message) } {}
+        [[nodiscard]] explicit UnexpectedToken(Token const& token, std::string_view const message)
+            : token{ token }, message{ message } {}
 
         [[nodiscard]] friend std::string format_as(UnexpectedToken const& error) {
             return fmt::format("Unexpected token: '{}'. {}", error.token.lexeme(), error.message);
@@ -87,15 +99,40 @@ namespace assembler {
         }
     };
 
+    struct DuplicateLabel final {
+        Token token;
+
+        [[nodiscard]] explicit DuplicateLabel(Token const& token)
+            : token{ token } {}
+
+        [[nodiscard]] friend std::string format_as(DuplicateLabel const& error) {
+            return fmt::format("Duplicate label: '{}'", error.token.lexeme());
+        }
+    };
+
+    struct UndefinedSymbol final {
+        Token token;
+
+        [[nodiscard]] explicit UndefinedSymbol(Token const& token)
+            : token{ token } {}
+
+        [[nodiscard]] friend std::string format_as(UndefinedSymbol const& error) {
+            return fmt::format("Undefined symbol: '{}'", error.token.lexeme());
+        }
+    };
+
     // clang-format off
     using ErrorBase = std::variant<
         InputExhausted,
         InvalidChar,
         InvalidInteger,
+        TokenTooLong,
         UnexpectedToken,
         ArityMismatch,
         UnknownMnemonic,
-        InvalidOperands
+        InvalidOperands,
+        DuplicateLabel,
+        UndefinedSymbol
     >;
     // clang-format on
 
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <common/common.hpp>
+#include <common/mapped_file.hpp>
+#include <common/source_map.hpp>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace assembler {
+    struct Symbol final {
+        std::string name;
+        Word address;
+    };
+
+    // An encoded program together with its metadata. The bytes are either owned by the image or
+    // memory mapped from the assembly cache.
+    class Image final {
+    private:
+        std::variant<std::vector<std::byte>, MappedFile> m_storage;
+        std::span<std::byte const> m_bytes;
+        std::vector<Symbol> m_symbols;
+        SourceMap m_source_map;
+
+    public:
+        [[nodiscard]] Image(std::vector<std::byte> bytes, std::vector<Symbol> symbols, SourceMap source_map)
+            : m_storage{ std::move(bytes) },
+              m_bytes{ std::get<std::vector<std::byte>>(m_storage) },
+              m_symbols{ std::move(symbols) },
+              m_source_map{ std::move(source_map) } {}
+
+        // `bytes` must point into `file`.
+        [[nodiscard]] Image(
+            MappedFile file,
+            std::span<std::byte const> const bytes,
+            std::vector<Symbol> symbols,
+            SourceMap source_map
+        )
+            : m_storage{ std::move(file) },
+              m_bytes{ bytes },
+              m_symbols{ std::move(symbols) },
+              m_source_map{ std::move(source_map) } {}
+
+        // Moving the storage does not move the bytes it refers to, so the view stays valid.
+        Image(Image const& other) = delete;
+        Image(Image&& other) noexcept = default;
+        Image& operator=(Image const& other) = delete;
+        Image& operator=(Image&& other) noexcept = default;
+        ~Image() = default;
+
+        [[nodiscard]] std::span<std::byte const> bytes() const {
+            return m_bytes;
+        }
+
+        [[nodiscard]] std::span<Symbol const> symbols() const {
+            return m_symbols;
+        }
+
+        [[nodiscard]] SourceMap const& source_map() const {
+            return m_source_map;
+        }
+
+        [[nodiscard]] bool is_mapped() const {
+            return std::holds_alternative<MappedFile>(m_storage);
+        }
+    };
+}  // namespace assembler
@@ -3,20 +3,42 @@
 #include <assembler/error.hpp>
 #include <common/instruction.hpp>
 #include <tl/expected.hpp>
-#include <vector>
-#include "operand.hpp"
+#include <tl/optional.hpp>
 #include "token.hpp"
 
 namespace assembler {
+    class Ast;
+
+    // If `symbol` is set, the immediate operand of `instruction` is a placeholder for the address
+    // of that symbol and still has to be patched during linking.
+    struct LoweredInstruction final {
+        ::Instruction instruction;
+        tl::optional<Token> symbol;
+        u32 source_offset = 0;  // Of the mnemonic, for the source map.
+    };
+
     class Instruction final {
     private:
         Token m_mnemonic;
-        std::vector<std::unique_ptr<Operand>> m_operands;
+        u32 m_first_operand;
+        u32 m_num_operands;
 
     public:
-        [[nodiscard]] Instruction(Token const& mnemonic, std::vector<std::unique_ptr<Operand>> operands)
-            : m_mnemonic{ mnemonic }, m_operands{ std::move(operands) } {}
+        [[nodiscard]] Instruction(Token const& mnemonic, u32 const first_operand, u32 const num_operands)
+            : m_mnemonic{ mnemonic }, m_first_operand{ first_operand }, m_num_operands{ num_operands } {}
+
+        [[nodiscard]] Token const& mnemonic() const {
+            return m_mnemonic;
+        }
+
+        [[nodiscard]] u32 first_operand() const {
+            return m_first_operand;
+        }
+
+        [[nodiscard]] u32 num_operands() const {
+            return m_num_operands;
+        }
 
-        [[nodiscard]] tl::expected<::Instruction, Error> lower() const;
+        [[nodiscard]] tl::expected<LoweredInstruction, Error> lower(Ast const& ast) const;
     };
 }  // namespace assembler
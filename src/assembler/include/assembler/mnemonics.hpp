@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <common/instruction.hpp>
+#include <common/register.hpp>
+#include <lib2k/types.hpp>
+#include <span>
+#include <string_view>
+
+// Compile-time table of all mnemonics. Looking up a mnemonic is one hash computation, one table
+// access and one string comparison. Each mnemonic lists the operand signatures it accepts.
+namespace assembler::mnemonics {
+    inline constexpr auto max_arity = usize{ 2 };
+
+    enum class OperandPattern : u8 {
+        Immediate,
+        Register,
+        PointerToRegister,
+    };
+
+    // The values of the operands of a matched signature, by operand position.
+    struct OperandValues final {
+        std::array<Word, max_arity> immediates{};
+        std::array<::Register, max_arity> registers{};
+    };
+
+    struct Signature final {
+        std::array<OperandPattern, max_arity> operands;
+        ::Instruction (*build)(OperandValues const& values);
+    };
+
+    struct Mnemonic final {
+        std::string_view name;
+        usize arity;
+        std::span<Signature const> signatures;
+    };
+
+    namespace detail {
+        using enum OperandPattern;
+
+        inline constexpr auto halt_signatures = std::array{
+            Signature{ {}, [](OperandValues const&) -> ::Instruction { return HaltAndCatchFire{}; } },
+        };
+
+        inline constexpr auto copy_signatures = std::array{
+            Signature{
+                { Immediate, Register },
+                [](OperandValues const& values) -> ::Instruction {
+                    return MoveImmediateIntoRegister{ values.immediates[0], values.registers[1] };
+                },
+            },
+            Signature{
+                { Immediate, PointerToRegister },
+                [](OperandValues const& values) -> ::Instruction {
+                    return MoveImmediateIntoMemory{ values.immediates[0], *values.registers[1] };
+                },
+            },
+        };
+
+        inline constexpr auto atomic_add_signatures = std::array{
+            Signature{
+                { Immediate, PointerToRegister },
+                [](OperandValues const& values) -> ::Instruction {
+                    return AtomicAddImmediateToMemory{ values.immediates[0], *values.registers[1] };
+                },
+            },
+        };
+
+        inline constexpr auto fence_signatures = std::array{
+            Signature{ {}, [](OperandValues const&) -> ::Instruction { return Fence{}; } },
+        };
+    }  // namespace detail
+
+    inline constexpr auto all = std::array{
+        Mnemonic{ "halt", 0, detail::halt_signatures },
+        Mnemonic{ "copy", 2, detail::copy_signatures },
+        Mnemonic{ "atomic_add", 2, detail::atomic_add_signatures },
+        Mnemonic{ "fence", 0, detail::fence_signatures },
+    };
+
+    namespace detail {
+        [[nodiscard]] constexpr bool has_at_most_one_immediate(Mnemonic const& mnemonic) {
+            for (auto const& signature : mnemonic.signatures) {
+                auto num_immediates = usize{ 0 };
+                for (auto i = usize{ 0 }; i < mnemonic.arity; ++i) {
+                    num_immediates += signature.operands[i] == OperandPattern::Immediate ? usize{ 1 } : usize{ 0 };
+                }
+                if (num_immediates > 1) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Symbolic operands are patched by assigning to the single `immediate` member of an instruction.
+        static_assert(std::ranges::all_of(all, has_at_most_one_immediate));
+
+        // FNV-1a, with the seed mixed into the offset basis.
+        [[nodiscard]] constexpr u32 hash(std::string_view const name, u32 const seed) {
+            auto result = u32{ 2166136261 } ^ seed;
+            for (auto const c : name) {
+                result ^= static_cast<u8>(c);
+                result *= u32{ 16777619 };
+            }
+            return result;
+        }
+
+        inline constexpr auto table_size = std::bit_ceil(all.size() * 2);
+        inline constexpr auto empty_slot = u8{ 0xFF };
+        static_assert(all.size() < empty_slot);
+
+        [[nodiscard]] constexpr usize slot(std::string_view const name, u32 const seed) {
+            return hash(name, seed) & (table_size - 1);
+        }
+
+        [[nodiscard]] constexpr bool is_perfect(u32 const seed) {
+            auto occupied = std::array<bool, table_size>{};
+            for (auto const& mnemonic : all) {
+                auto const index = slot(mnemonic.name, seed);
+                if (occupied[index]) {
+                    return false;
+                }
+                occupied[index] = true;
+            }
+            return true;
+        }
+
+        [[nodiscard]] constexpr u32 find_seed() {
+            for (auto seed = u32{ 0 }; seed < 100'000; ++seed) {
+                if (is_perfect(seed)) {
+                    return seed;
+                }
+            }
+            throw "No perfect hash seed found. Increase the table size.";
+        }
+
+        inline constexpr auto seed = find_seed();
+
+        inline constexpr auto table = [] {
+            auto result = std::array<u8, table_size>{};
+            result.fill(empty_slot);
+            for (auto i = usize{ 0 }; i < all.size(); ++i) {
+                result[slot(all[i].name, seed)] = static_cast<u8>(i);
+            }
+            return result;
+        }();
+    }  // namespace detail
+
+    [[nodiscard]] constexpr Mnemonic const* find(std::string_view const name) {
+        auto const index = detail::table[detail::slot(name, detail::seed)];
+        if (index == detail::empty_slot or all[index].name != name) {
+            return nullptr;
+        }
+        return &all[index];
+    }
+}  // namespace assembler::mnemonics
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <common/instruction_store.hpp>
+#include <string_view>
+#include <tl/expected.hpp>
+#include <unordered_map>
+#include <vector>
+#include "error.hpp"
+#include "image.hpp"
+#include "optimizer.hpp"
+#include "options.hpp"
+#include "source_file.hpp"
+
+namespace assembler {
+    struct Section;  // Defined in chunk.hpp.
+
+    // A program made of consecutive sections. Every section is lowered on its own and keeps its labels
+    // and symbolic operands relative to its own start. Replacing a section therefore only lowers that
+    // section again. Linking lays out the sections by their byte lengths, starting at the first section
+    // that changed, and patches the symbolic operands.
+    // Source files must outlive the module.
+    class Module final {
+    private:
+        struct SymbolDefinition final {
+            u32 section;
+            u32 label;
+        };
+
+        Options m_options;
+        std::vector<Section> m_sections;
+        std::unordered_map<std::string_view, SymbolDefinition> m_symbols;
+        usize m_first_unplaced_section = 0;
+        bool m_symbols_outdated = false;
+
+    public:
+        [[nodiscard]] explicit Module(Options const& options = {});
+
+        Module(Module const& other) = delete;
+        Module(Module&& other) noexcept;
+        Module& operator=(Module const& other) = delete;
+        Module& operator=(Module&& other) noexcept;
+        ~Module();
+
+        // Replaces all sections. Large sources are split into several sections that are assembled in
+        // parallel. On error, the module is left unchanged.
+        [[nodiscard]] tl::expected<void, Error> assign(SourceFile const& source_file);
+
+        // Like assign(), but instead of stopping at the first error, skips the rest of the offending line
+        // and carries on. Returns the first `max_errors` errors in source order, including those that
+        // link() would report. Afterwards, the module contains everything that could be assembled.
+        [[nodiscard]] std::vector<Error> assign_recovering(SourceFile const& source_file, usize max_errors);
+
+        // On error, the module is left unchanged.
+        [[nodiscard]] tl::expected<void, Error> insert_section(usize index, SourceFile const& source_file);
+
+        // On error, the module is left unchanged.
+        [[nodiscard]] tl::expected<void, Error> replace_section(usize index, SourceFile const& source_file);
+
+        void erase_section(usize index);
+
+        [[nodiscard]] usize num_sections() const;
+
+        // Reports duplicate labels before undefined symbols, each in source order.
+        [[nodiscard]] tl::expected<InstructionStore, Error> link();
+
+        // All labels in source order. Only valid after a successful link().
+        [[nodiscard]] std::vector<Symbol> symbols() const;
+
+        // Where every instruction came from. Only valid after a successful link().
+        [[nodiscard]] SourceMap source_map() const;
+
+        // Summed over all sections. Empty unless optimisation is enabled.
+        [[nodiscard]] OptimizationReport optimization_report() const;
+
+    private:
+        void invalidate_from(usize section_index);
+        // Errors are only recorded while `errors` holds fewer than `max_errors`.
+        void update_symbols(std::vector<Error>& errors, usize max_errors);
+        [[nodiscard]] tl::expected<Word, Error> resolve(Token const& symbol) const;
+    };
+}  // namespace assembler
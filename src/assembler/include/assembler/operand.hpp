@@ -1,91 +1,68 @@
 #pragma once
 
+#include <assembler/error.hpp>
+#include <common/common.hpp>
 #include <common/register.hpp>
 #include <lib2k/string_utils.hpp>
+#include <limits>
 #include <magic_enum.hpp>
-#include <memory>
-#include <tl/optional.hpp>
-#include <variant>
+#include <tl/expected.hpp>
 #include "token.hpp"
 
 namespace assembler {
+    enum class OperandKind : u8 {
+        Register,
+        Identifier,
+        Immediate,
+        Pointer,
+    };
 
-    class Identifier;
-    class Immediate;
-    class Pointer;
-    class Register;
-
-    class Operand {
-    protected:
-        [[nodiscard]] Operand() = default;
-        Operand(Operand const& other) = default;
-        Operand(Operand&& other) noexcept = default;
-
+    // Operands are plain values that are stored contiguously in an Ast. A pointer operand refers to
+    // its pointee by its index within the Ast's operand storage.
+    class Operand final {
     public:
-        Operand& operator=(Operand const& other) = delete;
-        Operand& operator=(Operand&& other) noexcept = delete;
-        virtual ~Operand() = default;
+        static constexpr auto no_pointee = std::numeric_limits<u32>::max();
 
-        [[nodiscard]] virtual tl::optional<Register const&> as_register() const {
-            return tl::nullopt;
-        }
+    private:
+        Token m_token;  // For pointers, this is the asterisk.
+        u32 m_pointee;
+        OperandKind m_kind;
 
-        [[nodiscard]] virtual tl::optional<Identifier const&> as_identifier() const {
-            return tl::nullopt;
-        }
+        [[nodiscard]] Operand(OperandKind const kind, Token const& token, u32 const pointee)
+            : m_token{ token }, m_pointee{ pointee }, m_kind{ kind } {}
 
-        [[nodiscard]] virtual tl::optional<Immediate const&> as_immediate() const {
-            return tl::nullopt;
+    public:
+        [[nodiscard]] static Operand register_(Token const& token) {
+            return Operand{ OperandKind::Register, token, no_pointee };
         }
 
-        [[nodiscard]] virtual tl::optional<Pointer const&> as_pointer() const {
-            return tl::nullopt;
+        [[nodiscard]] static Operand identifier(Token const& token) {
+            return Operand{ OperandKind::Identifier, token, no_pointee };
         }
-    };
 
-    class Register final : public Operand {
-    private:
-        Token m_token;
-
-    public:
-        [[nodiscard]] explicit Register(Token const& token)
-            : m_token{ token } {}
-
-        [[nodiscard]] ::Register value() const {
-            return magic_enum::enum_cast<::Register>(m_token.lexeme()).value();
+        [[nodiscard]] static Operand immediate(Token const& token) {
+            return Operand{ OperandKind::Immediate, token, no_pointee };
         }
 
-        [[nodiscard]] tl::optional<Register const&> as_register() const override {
-            return *this;
+        [[nodiscard]] static Operand pointer(Token const& asterisk, u32 const pointee) {
+            return Operand{ OperandKind::Pointer, asterisk, pointee };
         }
-    };
-
-    class Identifier final : public Operand {
-    private:
-        Token m_token;
 
-    public:
-        [[nodiscard]] explicit Identifier(Token const& token)
-            : m_token{ token } {}
-
-        [[nodiscard]] tl::optional<Identifier const&> as_identifier() const override {
-            return *this;
+        [[nodiscard]] OperandKind kind() const {
+            return m_kind;
         }
-    };
-
-    class Immediate final : public Operand {
-    private:
-        Token m_token;
 
-    public:
-        [[nodiscard]] explicit Immediate(Token const& token)
-            : m_token{ token } {}
+        [[nodiscard]] Token const& token() const {
+            return m_token;
+        }
 
-        [[nodiscard]] tl::optional<Immediate const&> as_immediate() const override {
-            return *this;
+        [[nodiscard]] ::Register register_value() const {
+            assert(m_kind == OperandKind::Register);
+            return magic_enum::enum_cast<::Register>(m_token.lexeme()).value();
         }
 
-        [[nodiscard]] tl::expected<Word, Error> value() const {
+        [[nodiscard]] tl::expected<Word, Error> immediate_value() const {
+            assert(m_kind == OperandKind::Immediate);
             auto const is_hex = m_token.lexeme().starts_with("0x");
             auto const view = is_hex ? m_token.lexeme().substr(2) : m_token.lexeme();
             auto const result = c2k::parse<Word>(view, is_hex ? 16 : 10);
@@ -94,23 +71,10 @@ namespace assembler {
             }
             return result.value();
         }
-    };
-
-    class Pointer final : public Operand {
-    private:
-        Token m_asterisk;
-        std::unique_ptr<Operand> m_pointee;
-
-    public:
-        [[nodiscard]] Pointer(Token const& asterisk, std::unique_ptr<Operand> pointee)
-            : m_asterisk{ asterisk }, m_pointee{ std::move(pointee) } {}
-
-        [[nodiscard]] tl::optional<Pointer const&> as_pointer() const override {
-            return *this;
-        }
 
-        [[nodiscard]] Operand const& pointee() const {
-            return *m_pointee;
+        [[nodiscard]] u32 pointee_index() const {
+            assert(m_kind == OperandKind::Pointer);
+            return m_pointee;
         }
     };
 }  // namespace assembler
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <common/instruction.hpp>
+#include <fmt/format.h>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <vector>
+#include "instruction.hpp"
+
+namespace assembler {
+    struct OptimizationReport final {
+        usize num_dead_register_writes = 0;
+        usize num_redundant_reloads = 0;
+        usize num_overwritten_stores = 0;
+        usize num_bytes_saved = 0;
+
+        [[nodiscard]] usize num_removed_instructions() const {
+            return num_dead_register_writes + num_redundant_reloads + num_overwritten_stores;
+        }
+
+        OptimizationReport& operator+=(OptimizationReport const& other) {
+            num_dead_register_writes += other.num_dead_register_writes;
+            num_redundant_reloads += other.num_redundant_reloads;
+            num_overwritten_stores += other.num_overwritten_stores;
+            num_bytes_saved += other.num_bytes_saved;
+            return *this;
+        }
+
+        [[nodiscard]] friend std::string format_as(OptimizationReport const& report) {
+            return fmt::format(
+                "removed {} dead register writes, {} redundant reloads and {} overwritten stores ({} bytes)",
+                report.num_dead_register_writes,
+                report.num_redundant_reloads,
+                report.num_overwritten_stores,
+                report.num_bytes_saved
+            );
+        }
+    };
+
+    // Peephole optimisation of straight-line code. Removes
+    //  - writes to registers that are overwritten before they are read,
+    //  - loads of a value that the register already holds and
+    //  - stores that are overwritten by a later store through the same, unchanged pointer.
+    // All registers are considered live at the end, at every halt, atomic add, fence and barrier. A barrier
+    // is the index of an instruction that might be reached other than by falling through, e.g. because it
+    // is labeled. Barriers must be sorted and are updated to the indices after the optimisation.
+    // Code is assumed to not modify itself. Temporaries come from the memory resource of `instructions`.
+    [[nodiscard]] OptimizationReport optimize(
+        std::pmr::vector<LoweredInstruction>& instructions,
+        std::span<u32> barriers
+    );
+
+    [[nodiscard]] OptimizationReport optimize(std::vector<::Instruction>& instructions);
+}  // namespace assembler
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <common/common.hpp>
+#include <filesystem>
+#include <lib2k/types.hpp>
+#include <memory_resource>
+#include <tl/optional.hpp>
+
+namespace assembler {
+    struct Options final {
+        // Sources larger than this are assembled in parallel. Does not change the output, since sources are
+        // always split into the same sections at line boundaries.
+        usize parallel_threshold = usize{ 1 } << 20;
+
+        // Maximum number of threads to use. Zero means one thread per hardware thread.
+        usize num_threads = 0;
+
+        // Address the first instruction is loaded to. Labels resolve relative to it.
+        Word base_address = 0;
+
+        // Runs the peephole optimiser on every section. Section boundaries act as barriers.
+        bool optimize = false;
+
+        // If set, assembled images are cached in this directory and reused for unchanged sources.
+        tl::optional<std::filesystem::path> cache_directory;
+
+        // Backs the tokens, syntax trees and other temporaries. Every thread draws from a per-thread arena
+        // that is reused from chunk to chunk, so this resource only sees a few large allocations. It has to
+        // be thread-safe if more than one thread is used. Assembled results use the global heap.
+        std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource();
+    };
+}  // namespace assembler
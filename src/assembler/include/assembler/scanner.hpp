@@ -0,0 +1,209 @@
+#pragma once
+
+#include <bit>
+#include <lib2k/types.hpp>
+#include <string_view>
+
+#if defined(__AVX2__) or defined(__SSE2__) or defined(_M_X64)
+#include <immintrin.h>
+#define IUBS2K_SCANNER_HAS_SIMD 1
+#else
+#define IUBS2K_SCANNER_HAS_SIMD 0
+#endif
+
+// Character class scanning for the lexer. Every function returns the index of the first character
+// at or after `index` that does not belong to the respective class. Runs are classified a whole
+// vector register at a time where SIMD is available, with a scalar loop for the tail (and for
+// constant evaluation).
+namespace assembler::scanner {
+    // Translation units compiled with and without AVX2 see different batches, character classes and skip()
+    // functions. Giving each variant its own namespace keeps them from violating the one definition rule.
+#if defined(__AVX2__)
+    inline namespace avx2 {
+#elif IUBS2K_SCANNER_HAS_SIMD
+    inline namespace sse2 {
+#else
+    inline namespace scalar {
+#endif
+#if IUBS2K_SCANNER_HAS_SIMD
+        namespace simd {
+#if defined(__AVX2__)
+            using Batch = __m256i;
+            inline constexpr auto batch_size = usize{ 32 };
+
+            [[nodiscard]] inline Batch load(char const* const data) {
+                return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data));
+            }
+
+            [[nodiscard]] inline Batch broadcast(char const c) {
+                return _mm256_set1_epi8(c);
+            }
+
+            [[nodiscard]] inline Batch equal(Batch const lhs, Batch const rhs) {
+                return _mm256_cmpeq_epi8(lhs, rhs);
+            }
+
+            [[nodiscard]] inline Batch bit_or(Batch const lhs, Batch const rhs) {
+                return _mm256_or_si256(lhs, rhs);
+            }
+
+            [[nodiscard]] inline Batch bit_not(Batch const batch) {
+                return _mm256_xor_si256(batch, _mm256_cmpeq_epi8(batch, batch));
+            }
+
+            [[nodiscard]] inline Batch subtract(Batch const lhs, Batch const rhs) {
+                return _mm256_sub_epi8(lhs, rhs);
+            }
+
+            [[nodiscard]] inline Batch min_unsigned(Batch const lhs, Batch const rhs) {
+                return _mm256_min_epu8(lhs, rhs);
+            }
+
+            [[nodiscard]] inline u32 to_mask(Batch const batch) {
+                return static_cast<u32>(_mm256_movemask_epi8(batch));
+            }
+#else
+            using Batch = __m128i;
+            inline constexpr auto batch_size = usize{ 16 };
+
+            [[nodiscard]] inline Batch load(char const* const data) {
+                return _mm_loadu_si128(reinterpret_cast<__m128i const*>(data));
+            }
+
+            [[nodiscard]] inline Batch broadcast(char const c) {
+                return _mm_set1_epi8(c);
+            }
+
+            [[nodiscard]] inline Batch equal(Batch const lhs, Batch const rhs) {
+                return _mm_cmpeq_epi8(lhs, rhs);
+            }
+
+            [[nodiscard]] inline Batch bit_or(Batch const lhs, Batch const rhs) {
+                return _mm_or_si128(lhs, rhs);
+            }
+
+            [[nodiscard]] inline Batch bit_not(Batch const batch) {
+                return _mm_xor_si128(batch, _mm_cmpeq_epi8(batch, batch));
+            }
+
+            [[nodiscard]] inline Batch subtract(Batch const lhs, Batch const rhs) {
+                return _mm_sub_epi8(lhs, rhs);
+            }
+
+            [[nodiscard]] inline Batch min_unsigned(Batch const lhs, Batch const rhs) {
+                return _mm_min_epu8(lhs, rhs);
+            }
+
+            [[nodiscard]] inline u32 to_mask(Batch const batch) {
+                return static_cast<u32>(_mm_movemask_epi8(batch));
+            }
+#endif
+
+            inline constexpr auto full_mask = u32{ batch_size == 32 ? 0xFFFF'FFFF : 0xFFFF };
+
+            [[nodiscard]] inline Batch equal(Batch const batch, char const c) {
+                return equal(batch, broadcast(c));
+            }
+
+            // Unsigned range check: (c - first) <= (last - first).
+            [[nodiscard]] inline Batch in_range(Batch const batch, char const first, char const last) {
+                auto const offset = subtract(batch, broadcast(first));
+                return equal(min_unsigned(offset, broadcast(static_cast<char>(last - first))), offset);
+            }
+        }  // namespace simd
+#endif
+
+        // Whitespace as classified by std::isspace() in the "C" locale, except for '\n' which is a token.
+        struct HorizontalWhitespace final {
+            [[nodiscard]] static constexpr bool matches(char const c) {
+                return c == ' ' or c == '\t' or c == '\v' or c == '\f' or c == '\r';
+            }
+
+#if IUBS2K_SCANNER_HAS_SIMD
+            [[nodiscard]] static simd::Batch matches(simd::Batch const batch) {
+                using namespace simd;
+                return bit_or(
+                    bit_or(equal(batch, ' '), equal(batch, '\t')),
+                    bit_or(bit_or(equal(batch, '\v'), equal(batch, '\f')), equal(batch, '\r'))
+                );
+            }
+#endif
+        };
+
+        struct AnythingButNewline final {
+            [[nodiscard]] static constexpr bool matches(char const c) {
+                return c != '\n';
+            }
+
+#if IUBS2K_SCANNER_HAS_SIMD
+            [[nodiscard]] static simd::Batch matches(simd::Batch const batch) {
+                return simd::bit_not(simd::equal(batch, '\n'));
+            }
+#endif
+        };
+
+        struct DecimalDigit final {
+            [[nodiscard]] static constexpr bool matches(char const c) {
+                return c >= '0' and c <= '9';
+            }
+
+#if IUBS2K_SCANNER_HAS_SIMD
+            [[nodiscard]] static simd::Batch matches(simd::Batch const batch) {
+                return simd::in_range(batch, '0', '9');
+            }
+#endif
+        };
+
+        struct HexadecimalDigit final {
+            [[nodiscard]] static constexpr bool matches(char const c) {
+                return DecimalDigit::matches(c) or (c >= 'a' and c <= 'f') or (c >= 'A' and c <= 'F');
+            }
+
+#if IUBS2K_SCANNER_HAS_SIMD
+            [[nodiscard]] static simd::Batch matches(simd::Batch const batch) {
+                using namespace simd;
+                return bit_or(
+                    DecimalDigit::matches(batch),
+                    bit_or(in_range(batch, 'a', 'f'), in_range(batch, 'A', 'F'))
+                );
+            }
+#endif
+        };
+
+        struct IdentifierContinuation final {
+            [[nodiscard]] static constexpr bool matches(char const c) {
+                return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z') or DecimalDigit::matches(c) or c == '_';
+            }
+
+#if IUBS2K_SCANNER_HAS_SIMD
+            [[nodiscard]] static simd::Batch matches(simd::Batch const batch) {
+                using namespace simd;
+                return bit_or(
+                    bit_or(in_range(batch, 'a', 'z'), in_range(batch, 'A', 'Z')),
+                    bit_or(DecimalDigit::matches(batch), equal(batch, '_'))
+                );
+            }
+#endif
+        };
+
+        template<typename CharacterClass>
+        [[nodiscard]] constexpr usize skip(std::string_view const source, usize index) {
+#if IUBS2K_SCANNER_HAS_SIMD
+            if !consteval {
+                using namespace simd;
+                while (index + batch_size <= source.length()) {
+                    auto const mask = to_mask(CharacterClass::matches(load(source.data() + index)));
+                    if (mask != full_mask) {
+                        return index + static_cast<usize>(std::countr_one(mask));
+                    }
+                    index += batch_size;
+                }
+            }
+#endif
+            while (index < source.length() and CharacterClass::matches(source[index])) {
+                ++index;
+            }
+            return index;
+        }
+    }  // inline namespace
+}  // namespace assembler::scanner
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <common/mapped_file.hpp>
+#include <filesystem>
+#include <lib2k/types.hpp>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tl/optional.hpp>
+#include <vector>
+
+namespace assembler {
+    // A source file together with an index of where its lines start. Tokens and source locations
+    // only store offsets into the file. Rows, columns and lines are computed on demand by binary
+    // search in the index, which is built once on first use.
+    class SourceFile final {
+    public:
+        static constexpr auto max_size = usize{ std::numeric_limits<u32>::max() };
+
+    private:
+        std::string m_owned_filename;  // Only used for mapped files.
+        tl::optional<MappedFile> m_mapping;
+        std::string_view m_filename;
+        std::string_view m_source;
+        mutable std::once_flag m_line_starts_built;
+        mutable std::vector<u32> m_line_starts;
+
+    public:
+        [[nodiscard]] SourceFile(std::string_view filename, std::string_view source);
+
+        // Memory maps the file instead of reading it, so that only the parts being assembled need to be
+        // resident. The file must not change while the source file is alive. Returns nullptr if the file
+        // cannot be read.
+        [[nodiscard]] static std::unique_ptr<SourceFile> map(std::filesystem::path const& path);
+
+        SourceFile(SourceFile const& other) = delete;
+        SourceFile(SourceFile&& other) noexcept = delete;
+        SourceFile& operator=(SourceFile const& other) = delete;
+        SourceFile& operator=(SourceFile&& other) noexcept = delete;
+        ~SourceFile() = default;
+
+        [[nodiscard]] std::string_view filename() const {
+            return m_filename;
+        }
+
+        [[nodiscard]] std::string_view source() const {
+            return m_source;
+        }
+
+        // 1-based row of the character at the given offset.
+        [[nodiscard]] usize row(usize offset) const;
+
+        // 1-based column of the character at the given offset.
+        [[nodiscard]] usize column(usize offset) const;
+
+        // The given (1-based) row without its line terminator.
+        [[nodiscard]] std::string_view line(usize row) const;
+
+    private:
+        [[nodiscard]] SourceFile(std::string filename, MappedFile mapping);
+
+        [[nodiscard]] std::vector<u32> const& line_starts() const;
+    };
+}  // namespace assembler
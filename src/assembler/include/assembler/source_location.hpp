@@ -3,56 +3,49 @@
 #include <fmt/format.h>
 #include <lib2k/types.hpp>
 #include <string_view>
+#include "source_file.hpp"
 
 namespace assembler {
     class SourceLocation final {
     private:
-        std::string_view m_filename;
-        std::string_view m_source;
-        usize m_offset;
-        usize m_length;
-        usize m_row;
-        usize m_column;
+        SourceFile const* m_source_file;
+        u32 m_offset;
+        u32 m_length;
 
     public:
-        [[nodiscard]] SourceLocation(
-            std::string_view const filename,
-            std::string_view const source,
-            usize const offset,
-            usize const length,
-            usize const row,
-            usize const column
-        )
-            : m_filename{ filename },
-              m_source{ source },
-              m_offset{ offset },
-              m_length{ length },
-              m_row{ row },
-              m_column{ column } {}
+        [[nodiscard]] SourceLocation(SourceFile const& source_file, u32 const offset, u32 const length)
+            : m_source_file{ &source_file }, m_offset{ offset }, m_length{ length } {}
+
+        [[nodiscard]] SourceFile const& source_file() const {
+            return *m_source_file;
+        }
 
         [[nodiscard]] std::string_view filename() const {
-            return m_filename;
+            return m_source_file->filename();
+        }
+
+        [[nodiscard]] usize offset() const {
+            return m_offset;
+        }
+
+        [[nodiscard]] usize length() const {
+            return m_length;
         }
 
         [[nodiscard]] std::string_view lexeme() const {
-            return m_source.substr(m_offset, m_length);
+            return m_source_file->source().substr(m_offset, m_length);
         }
 
         [[nodiscard]] usize row() const {
-            return m_row;
+            return m_source_file->row(m_offset);
         }
 
         [[nodiscard]] usize column() const {
-            return m_column;
+            return m_source_file->column(m_offset);
         }
 
         [[nodiscard]] std::string_view surrounding_line() const {
-            auto const start = m_source.rfind('\n', m_offset);
-            auto const end = m_source.find('\n', m_offset);
-            if (start == std::string_view::npos) {
-                return m_source.substr(0, end);
-            }
-            return m_source.substr(start + 1, end - start - 1);
+            return m_source_file->line(row());
         }
     };
 
@@ -1,37 +1,53 @@
 #pragma once
 
+#include <cassert>
+#include <lib2k/types.hpp>
 #include "source_location.hpp"
 
 namespace assembler {
-    enum class TokenType {
+    enum class TokenType : u8 {
         Asterisk,
         Integer,
         Identifier,
         Comma,
+        Colon,
         Newline,
         Register,
         EndOfInput,
     };
 
     class Token final {
+    public:
+        static constexpr auto max_length = usize{ (1 << 24) - 1 };
+
     private:
-        TokenType m_type;
-        SourceLocation m_source_location;
+        SourceFile const* m_source_file;
+        u32 m_offset;
+        u32 m_length : 24;
+        TokenType m_type : 8;
 
     public:
-        [[nodiscard]] Token(TokenType const type, SourceLocation const& source_location)
-            : m_type{ type }, m_source_location{ source_location } {}
+        [[nodiscard]] Token(TokenType const type, SourceFile const& source_file, u32 const offset, u32 const length)
+            : m_source_file{ &source_file },
+              m_offset{ offset },
+              // The lexer reports longer tokens as TokenTooLong, so the mask never changes the length.
+              m_length{ length & static_cast<u32>(max_length) },
+              m_type{ type } {
+            assert(length <= max_length);
+        }
 
         [[nodiscard]] TokenType type() const {
             return m_type;
         }
 
-        [[nodiscard]] SourceLocation const& source_location() const {
-            return m_source_location;
+        [[nodiscard]] SourceLocation source_location() const {
+            return SourceLocation{ *m_source_file, m_offset, m_length };
         }
 
         [[nodiscard]] std::string_view lexeme() const {
-            return m_source_location.lexeme();
+            return m_source_file->source().substr(m_offset, m_length);
         }
     };
+
+    static_assert(sizeof(Token) <= 16);
 }  // namespace assembler
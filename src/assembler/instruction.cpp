@@ -1,54 +1,102 @@
+#include <assembler/ast.hpp>
 #include <assembler/instruction.hpp>
+#include <assembler/mnemonics.hpp>
 
 namespace assembler {
-    [[nodiscard]] tl::expected<::Instruction, Error> Instruction::lower() const {
-        if (m_mnemonic.type() != TokenType::Identifier) {
-            throw std::logic_error{ "Mnemonic must be identifier." };
-        }
-
-        if (m_mnemonic.lexeme() == "halt") {
-            if (not m_operands.empty()) {
-                return tl::unexpected{
-                    ArityMismatch{ m_mnemonic, 0, m_operands.size() }
-                };
+    namespace {
+        [[nodiscard]] bool matches(mnemonics::OperandPattern const pattern, Operand const& operand) {
+            switch (pattern) {
+                case mnemonics::OperandPattern::Immediate:
+                    // Identifiers are symbols whose address is filled in during linking.
+                    return operand.kind() == OperandKind::Immediate or operand.kind() == OperandKind::Identifier;
+                case mnemonics::OperandPattern::Register:
+                    return operand.kind() == OperandKind::Register;
+                case mnemonics::OperandPattern::PointerToRegister:
+                    // The pointee is checked during extraction to report errors in operand order.
+                    return operand.kind() == OperandKind::Pointer;
             }
-
-            return HaltAndCatchFire{};
+            throw std::logic_error{ "Unreachable." };
         }
 
-        if (m_mnemonic.lexeme() == "copy") {
-            if (m_operands.size() != 2) {
-                return tl::unexpected{
-                    ArityMismatch{ m_mnemonic, 2, m_operands.size() }
-                };
-            }
-
-            auto const lhs_immediate = m_operands[0]->as_immediate();
-            auto const rhs_register = m_operands[1]->as_register();
-            if (lhs_immediate.has_value() and rhs_register.has_value()) {
-                auto const immediate_value = lhs_immediate.value().value();
-                if (not immediate_value.has_value()) {
-                    return tl::unexpected{ immediate_value.error() };
+        [[nodiscard]] bool matches(mnemonics::Signature const& signature, std::span<Operand const> const operands) {
+            for (auto i = usize{ 0 }; i < operands.size(); ++i) {
+                if (not matches(signature.operands[i], operands[i])) {
+                    return false;
                 }
-                return MoveImmediateIntoRegister{ immediate_value.value(), rhs_register.value().value() };
             }
+            return true;
+        }
 
-            auto const rhs_pointer = m_operands[1]->as_pointer();
-            if (lhs_immediate.has_value() and rhs_pointer.has_value()) {
-                auto const immediate_value = lhs_immediate.value().value();
-                if (not immediate_value.has_value()) {
-                    return tl::unexpected{ immediate_value.error() };
+        [[nodiscard]] tl::expected<mnemonics::OperandValues, Error> extract(
+            Ast const& ast,
+            Token const& mnemonic,
+            mnemonics::Signature const& signature,
+            std::span<Operand const> const operands,
+            tl::optional<Token>& symbol
+        ) {
+            auto values = mnemonics::OperandValues{};
+            for (auto i = usize{ 0 }; i < operands.size(); ++i) {
+                auto const& operand = operands[i];
+                switch (signature.operands[i]) {
+                    case mnemonics::OperandPattern::Immediate: {
+                        if (operand.kind() == OperandKind::Identifier) {
+                            symbol = operand.token();
+                            break;
+                        }
+                        auto const value = operand.immediate_value();
+                        if (not value.has_value()) {
+                            return tl::unexpected{ value.error() };
+                        }
+                        values.immediates[i] = value.value();
+                        break;
+                    }
+                    case mnemonics::OperandPattern::Register:
+                        values.registers[i] = operand.register_value();
+                        break;
+                    case mnemonics::OperandPattern::PointerToRegister: {
+                        auto const& pointee = ast.pointee(operand);
+                        if (pointee.kind() != OperandKind::Register) {
+                            return tl::unexpected{ InvalidOperands{ mnemonic } };
+                        }
+                        values.registers[i] = pointee.register_value();
+                        break;
+                    }
                 }
-                auto const& pointee = rhs_pointer.value().pointee().as_register();
-                if (not pointee.has_value()) {
-                    return tl::unexpected{ InvalidOperands{ m_mnemonic } };
-                }
-                return MoveImmediateIntoMemory{ immediate_value.value(), *pointee.value().value() };
             }
+            return values;
+        }
+    }  // namespace
 
-            return tl::unexpected{ InvalidOperands{ m_mnemonic } };
+    [[nodiscard]] tl::expected<LoweredInstruction, Error> Instruction::lower(Ast const& ast) const {
+        if (m_mnemonic.type() != TokenType::Identifier) {
+            throw std::logic_error{ "Mnemonic must be identifier." };
+        }
+
+        auto const mnemonic = mnemonics::find(m_mnemonic.lexeme());
+        if (mnemonic == nullptr) {
+            return tl::unexpected{ UnknownMnemonic{ m_mnemonic } };
+        }
+
+        auto const operands = ast.operands(*this);
+        if (operands.size() != mnemonic->arity) {
+            return tl::unexpected{
+                ArityMismatch{ m_mnemonic, mnemonic->arity, operands.size() }
+            };
+        }
+
+        for (auto const& signature : mnemonic->signatures) {
+            if (not matches(signature, operands)) {
+                continue;
+            }
+            auto symbol = tl::optional<Token>{};
+            auto const values = extract(ast, m_mnemonic, signature, operands, symbol);
+            if (not values.has_value()) {
+                return tl::unexpected{ values.error() };
+            }
+            auto const source_offset = static_cast<u32>(m_mnemonic.source_location().offset());
+            return LoweredInstruction{ signature.build(values.value()), symbol, source_offset };
         }
 
-        return tl::unexpected{ UnknownMnemonic{ m_mnemonic } };
+        return tl::unexpected{ InvalidOperands{ m_mnemonic } };
     }
 }  // namespace assembler
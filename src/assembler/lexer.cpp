@@ -1,15 +1,28 @@
 #include "lexer.hpp"
-#include <cctype>
+#include <assembler/scanner.hpp>
 #include <common/register.hpp>
-#include <ctre.hpp>
 #include <magic_enum.hpp>
 
 namespace assembler {
-    [[nodiscard]] Lexer::Lexer(std::string_view const filename, std::string_view const source)
-        : m_filename{ filename }, m_source{ source } {}
+    [[nodiscard]] Lexer::Lexer(SourceFile const& source_file, std::pmr::memory_resource* const memory_resource)
+        : Lexer{ source_file, 0, source_file.source().length(), memory_resource } {}
+
+    [[nodiscard]] Lexer::Lexer(
+        SourceFile const& source_file,
+        usize const begin,
+        usize const end,
+        std::pmr::memory_resource* const memory_resource
+    )
+        : m_source_file{ &source_file },
+          m_source{ source_file.source().substr(0, end) },
+          m_begin{ begin },
+          m_index{ begin },
+          m_tokens{ memory_resource } {
+        assert(begin <= end and end <= source_file.source().length());
+    }
 
     [[nodiscard]] tl::expected<void, Error> Lexer::tokenize() {
-        *this = Lexer{ m_filename, m_source };
+        *this = Lexer{ *m_source_file, m_begin, m_source.length(), m_tokens.get_allocator().resource() };
         while (true) {
             auto const token = next_token();
             if (not token.has_value()) {
@@ -24,7 +37,36 @@ namespace assembler {
         return {};
     }
 
-    [[nodiscard]] std::vector<Token> Lexer::take() && {
+    void Lexer::tokenize_recovering(std::vector<Error>& errors, usize const max_errors) {
+        *this = Lexer{ *m_source_file, m_begin, m_source.length(), m_tokens.get_allocator().resource() };
+        auto line_start = usize{ 0 };  // Index of the first token of the current line.
+        while (true) {
+            auto const token = next_token();
+            if (not token.has_value()) {
+                if (errors.size() < max_errors) {
+                    errors.push_back(token.error());
+                }
+                // Labels in front of the error are kept, so that references to them are not reported as undefined.
+                auto keep = line_start;
+                while (keep + 1 < m_tokens.size() and m_tokens[keep].type() == TokenType::Identifier
+                       and m_tokens[keep + 1].type() == TokenType::Colon) {
+                    keep += 2;
+                }
+                m_tokens.erase(m_tokens.begin() + static_cast<std::ptrdiff_t>(keep), m_tokens.end());
+                advance_to(scanner::skip<scanner::AnythingButNewline>(m_source, m_index));
+                continue;
+            }
+
+            m_tokens.push_back(token.value());
+            if (token.value().type() == TokenType::Newline) {
+                line_start = m_tokens.size();
+            } else if (token.value().type() == TokenType::EndOfInput) {
+                break;
+            }
+        }
+    }
+
+    [[nodiscard]] std::pmr::vector<Token> Lexer::take() && {
         return std::move(m_tokens);
     }
 
@@ -33,51 +75,37 @@ namespace assembler {
             throw std::logic_error{ "Lexer is exhausted." };
         }
 
+        // Trailing whitespace is skipped like any other, so that the source ends with EndOfInput.
+        advance_to(scanner::skip<scanner::HorizontalWhitespace>(m_source, m_index));
+
         if (is_at_end()) {
             m_input_exhausted = true;
-            return Token{
-                TokenType::EndOfInput,
-                current_source_location(0),
-            };
-        }
-
-        while (current() != '\n' and std::isspace(static_cast<unsigned char>(current()))) {
-            advance();
+            return token_from(TokenType::EndOfInput, m_index);
         }
 
         switch (current()) {
             case '\n': {
-                auto const result = Token{
-                    TokenType::Newline,
-                    current_source_location(),
-                };
                 advance();
-                return result;
+                return token_from(TokenType::Newline, m_index - 1);
             }
             case ';': {
-                while (current() != '\n' and not is_at_end()) {
-                    advance();
-                }
+                advance_to(scanner::skip<scanner::AnythingButNewline>(m_source, m_index));
                 return next_token();
             }
             case ',': {
-                auto const result = Token{
-                    TokenType::Comma,
-                    current_source_location(),
-                };
                 advance();
-                return result;
+                return token_from(TokenType::Comma, m_index - 1);
             }
             case '*': {
-                auto const result = Token{
-                    TokenType::Asterisk,
-                    current_source_location(),
-                };
                 advance();
-                return result;
+                return token_from(TokenType::Asterisk, m_index - 1);
+            }
+            case ':': {
+                advance();
+                return token_from(TokenType::Colon, m_index - 1);
             }
             default:
-                if (std::isdigit(static_cast<unsigned char>(current()))) {
+                if (scanner::DecimalDigit::matches(current())) {
                     return integer();
                 }
                 if (is_valid_identifier_start(current())) {
@@ -88,52 +116,36 @@ namespace assembler {
     }
 
     [[nodiscard]] tl::expected<Token, Error> Lexer::integer() {
-        if (auto const match = ctre::search<"^(0x[0-9A-Fa-f]+|[0-9]+)">(m_source.substr(m_index))) {
-            auto const start_offset = m_index;
-            auto const start_row = m_row;
-            auto const start_column = m_column;
-            auto const lexeme = match.get<1>().to_view();
-            for (auto const _ : lexeme) {
-                advance();
-            }
-            return Token{
-                TokenType::Integer,
-                source_location_from(start_offset, start_row, start_column),
-            };
+        // Either "0x" followed by at least one hexadecimal digit, or a run of decimal digits.
+        if (not scanner::DecimalDigit::matches(current())) {
+            return tl::unexpected{ InvalidInteger{ current_source_location() } };
+        }
+        auto const start_offset = m_index;
+        auto const is_hexadecimal = m_source.substr(m_index).starts_with("0x")
+                                    and scanner::HexadecimalDigit::matches(peek_at(2));
+        if (is_hexadecimal) {
+            advance_to(scanner::skip<scanner::HexadecimalDigit>(m_source, m_index + 2));
+        } else {
+            advance_to(scanner::skip<scanner::DecimalDigit>(m_source, m_index));
         }
-        return tl::unexpected{ InvalidInteger{ current_source_location() } };
+        return token_from(TokenType::Integer, start_offset);
     }
 
     [[nodiscard]] tl::expected<Token, Error> Lexer::identifier() {
         assert(is_valid_identifier_start(current()));
         auto const start_offset = m_index;
-        auto const start_row = m_row;
-        auto const start_column = m_column;
-        advance();
-        while (is_valid_identifier_continuation(current())) {
-            advance();
-        }
+        advance_to(scanner::skip<scanner::IdentifierContinuation>(m_source, m_index + 1));
         auto const lexeme = m_source.substr(start_offset, m_index - start_offset);
         if (magic_enum::enum_cast<Register>(lexeme)) {
-            return Token{
-                TokenType::Register,
-                source_location_from(start_offset, start_row, start_column),
-            };
+            return token_from(TokenType::Register, start_offset);
         }
-        return Token{
-            TokenType::Identifier,
-            source_location_from(start_offset, start_row, start_column),
-        };
+        return token_from(TokenType::Identifier, start_offset);
     }
 
     [[nodiscard]] bool Lexer::is_valid_identifier_start(char const c) {
         return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z');
     }
 
-    [[nodiscard]] bool Lexer::is_valid_identifier_continuation(char const c) {
-        return is_valid_identifier_start(c) or (c >= '0' and c <= '9') or (c == '_');
-    }
-
     [[nodiscard]] bool Lexer::is_at_end() const {
         return m_index >= m_source.length();
     }
@@ -142,35 +154,36 @@ namespace assembler {
         return is_at_end() ? '\0' : m_source[m_index];
     }
 
-    [[nodiscard]] char Lexer::peek() const {
-        if (m_index + 1 >= m_source.length()) {
+    [[nodiscard]] char Lexer::peek_at(usize const distance) const {
+        if (m_index + distance >= m_source.length()) {
             return '\0';
         }
-        return m_source[m_index + 1];
+        return m_source[m_index + distance];
     }
 
     void Lexer::advance() {
         if (is_at_end()) {
             return;
         }
-        if (current() == '\n') {
-            ++m_row;
-            m_column = 0;
-        }
-        ++m_column;
         ++m_index;
     }
 
+    void Lexer::advance_to(usize const index) {
+        assert(index >= m_index and index <= m_source.length());
+        m_index = index;
+    }
+
     [[nodiscard]] SourceLocation Lexer::current_source_location(usize const length) const {
-        return SourceLocation{ m_filename, m_source, m_index, length, m_row, m_column };
+        return SourceLocation{ *m_source_file, static_cast<u32>(m_index), static_cast<u32>(length) };
     }
 
-    [[nodiscard]] SourceLocation Lexer::source_location_from(
-        usize const start_offset,
-        usize const start_row,
-        usize const start_column
-    ) const {
-        return SourceLocation{ m_filename, m_source, start_offset, m_index - start_offset, start_row, start_column };
+    [[nodiscard]] tl::expected<Token, Error> Lexer::token_from(TokenType const type, usize const start_offset) const {
+        auto const length = m_index - start_offset;
+        if (length > Token::max_length) {
+            auto const location = SourceLocation{ *m_source_file, static_cast<u32>(start_offset), 1 };
+            return tl::unexpected{ TokenTooLong{ location } };
+        }
+        return Token{ type, *m_source_file, static_cast<u32>(start_offset), static_cast<u32>(length) };
     }
 
 }  // namespace assembler
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <assembler/error.hpp>
+#include <assembler/source_file.hpp>
 #include <lib2k/types.hpp>
+#include <memory_resource>
 #include <string_view>
 #include <tl/expected.hpp>
 #include <assembler/token.hpp>
@@ -10,20 +12,34 @@
 namespace assembler {
     class Lexer final {
     private:
-        std::string_view m_filename;
+        SourceFile const* m_source_file;
         std::string_view m_source;
-        usize m_index = 0;
-        usize m_row = 1;
-        usize m_column = 1;
+        usize m_begin;
+        usize m_index;
         bool m_input_exhausted = false;
-        std::vector<Token> m_tokens;
+        std::pmr::vector<Token> m_tokens;
 
     public:
-        [[nodiscard]] explicit Lexer(std::string_view filename, std::string_view source);
+        [[nodiscard]] explicit Lexer(
+            SourceFile const& source_file,
+            std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource()
+        );
+
+        // Only tokenizes the given range of the source file. Offsets stay relative to the whole file.
+        [[nodiscard]] Lexer(
+            SourceFile const& source_file,
+            usize begin,
+            usize end,
+            std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource()
+        );
 
         [[nodiscard]] tl::expected<void, Error> tokenize();
 
-        [[nodiscard]] std::vector<Token> take() &&;
+        // Instead of stopping at the first error, drops the tokens of the offending line and carries on
+        // with the next one. Errors are only recorded while `errors` holds fewer than `max_errors`.
+        void tokenize_recovering(std::vector<Error>& errors, usize max_errors);
+
+        [[nodiscard]] std::pmr::vector<Token> take() &&;
 
     private:
         [[nodiscard]] tl::expected<Token, Error> next_token();
@@ -32,20 +48,20 @@ namespace assembler {
 
         [[nodiscard]] char current() const;
 
-        [[nodiscard]] char peek() const;
+        [[nodiscard]] char peek_at(usize distance) const;
 
         void advance();
 
+        void advance_to(usize index);
+
         [[nodiscard]] SourceLocation current_source_location(usize length = 1) const;
 
-        [[nodiscard]] SourceLocation source_location_from(usize start_offset, usize start_row, usize start_column) const;
+        [[nodiscard]] tl::expected<Token, Error> token_from(TokenType type, usize start_offset) const;
 
         [[nodiscard]] tl::expected<Token, Error> integer();
 
         [[nodiscard]] tl::expected<Token, Error> identifier();
 
         [[nodiscard]] static bool is_valid_identifier_start(char c);
-
-        [[nodiscard]] static bool is_valid_identifier_continuation(char c);
     };
 }  // namespace assembler
@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <assembler/module.hpp>
+#include <assembler/optimizer.hpp>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include "chunk.hpp"
+
+namespace assembler {
+    namespace {
+        [[nodiscard]] usize num_threads_to_use(Options const& options) {
+            if (options.num_threads != 0) {
+                return options.num_threads;
+            }
+            return std::max(usize{ std::thread::hardware_concurrency() }, usize{ 1 });
+        }
+
+        template<typename AssembleChunk>
+        [[nodiscard]] std::vector<ChunkResult> assemble_chunks(
+            SourceFile const& source_file,
+            Options const& options,
+            AssembleChunk const& assemble_chunk
+        ) {
+            auto const chunks = split(source_file.source());
+            auto const is_large = source_file.source().length() > options.parallel_threshold;
+            auto const num_threads = is_large ? std::min(num_threads_to_use(options), chunks.size()) : usize{ 1 };
+
+            auto results = std::vector<ChunkResult>(chunks.size());
+            auto next_chunk = std::atomic<usize>{ 0 };
+            auto const work = [&] {
+                auto arena = ChunkArena{ options.memory_resource };
+                for (auto index = next_chunk++; index < chunks.size(); index = next_chunk++) {
+                    results[index] = assemble_chunk(chunks[index], arena.next_chunk());
+                }
+            };
+            if (num_threads == 1) {
+                work();
+            } else {
+                auto workers = std::vector<std::jthread>{};
+                for (auto i = usize{ 0 }; i < num_threads; ++i) {
+                    workers.emplace_back(work);
+                }
+            }
+            return results;
+        }
+
+        [[nodiscard]] tl::expected<std::vector<Section>, Error> assemble_sections(
+            SourceFile const& source_file,
+            Options const& options
+        ) {
+            auto results = assemble_chunks(
+                source_file,
+                options,
+                [&](Chunk const chunk, std::pmr::memory_resource* const memory_resource) {
+                    return assemble_chunk(source_file, chunk, options.optimize, memory_resource);
+                }
+            );
+
+            // A sequential assembler would first lex everything, then parse everything and then lower
+            // everything, stopping at the first error. So the earliest phase wins, then the earliest chunk.
+            auto const failure = std::ranges::min_element(results, [](ChunkResult const& lhs, ChunkResult const& rhs) {
+                if (not lhs.failed_phase.has_value()) {
+                    return false;
+                }
+                return not rhs.failed_phase.has_value() or lhs.failed_phase.value() < rhs.failed_phase.value();
+            });
+            if (failure->failed_phase.has_value()) {
+                if (failure->exception) {
+                    std::rethrow_exception(failure->exception);
+                }
+                return tl::unexpected{ failure->error.value() };
+            }
+
+            auto sections = std::vector<Section>{};
+            sections.reserve(results.size());
+            for (auto& result : results) {
+                sections.push_back(std::move(result.section));
+            }
+            return sections;
+        }
+
+        [[nodiscard]] tl::expected<Section, Error> assemble_section(
+            SourceFile const& source_file,
+            Options const& options
+        ) {
+            auto arena = ChunkArena{ options.memory_resource };
+            auto const chunk = Chunk{ 0, source_file.source().length() };
+            auto result = assemble_chunk(source_file, chunk, options.optimize, arena.next_chunk());
+            if (result.exception) {
+                std::rethrow_exception(result.exception);
+            }
+            if (result.error.has_value()) {
+                return tl::unexpected{ result.error.value() };
+            }
+            return std::move(result.section);
+        }
+    }  // namespace
+
+    [[nodiscard]] Module::Module(Options const& options)
+        : m_options{ options } {}
+
+    Module::Module(Module&& other) noexcept = default;
+    Module& Module::operator=(Module&& other) noexcept = default;
+    Module::~Module() = default;
+
+    [[nodiscard]] tl::expected<void, Error> Module::assign(SourceFile const& source_file) {
+        auto sections = assemble_sections(source_file, m_options);
+        if (not sections.has_value()) {
+            return tl::unexpected{ sections.error() };
+        }
+        m_sections = std::move(sections).value();
+        invalidate_from(0);
+        return {};
+    }
+
+    [[nodiscard]] std::vector<Error> Module::assign_recovering(SourceFile const& source_file, usize const max_errors) {
+        if (max_errors == 0) {
+            throw std::invalid_argument{ "At least one error must be reported." };
+        }
+        auto results = assemble_chunks(
+            source_file,
+            m_options,
+            [&](Chunk const chunk, std::pmr::memory_resource* const memory_resource) {
+                return assemble_chunk_recovering(source_file, chunk, m_options.optimize, max_errors, memory_resource);
+            }
+        );
+
+        // Chunks are in source order, and so are the errors of each chunk.
+        auto errors = std::vector<Error>{};
+        auto sections = std::vector<Section>{};
+        sections.reserve(results.size());
+        for (auto& result : results) {
+            if (result.exception) {
+                std::rethrow_exception(result.exception);
+            }
+            errors.insert(errors.end(), result.errors.begin(), result.errors.end());
+            sections.push_back(std::move(result.section));
+        }
+        m_sections = std::move(sections);
+        invalidate_from(0);
+
+        // Symbols can only be checked once everything else is assembled, but they belong in source order, too.
+        auto duplicates = std::vector<Error>{};
+        update_symbols(duplicates, max_errors);
+        auto undefined_symbols = std::vector<Error>{};
+        for (auto const& section : m_sections) {
+            for (auto const& relocation : section.relocations) {
+                if (undefined_symbols.size() < max_errors and not m_symbols.contains(relocation.symbol.lexeme())) {
+                    undefined_symbols.push_back(UndefinedSymbol{ relocation.symbol });
+                }
+            }
+        }
+        errors.insert(errors.end(), duplicates.begin(), duplicates.end());
+        errors.insert(errors.end(), undefined_symbols.begin(), undefined_symbols.end());
+        sort_by_position(errors);
+        if (errors.size() > max_errors) {
+            errors.erase(errors.begin() + static_cast<std::ptrdiff_t>(max_errors), errors.end());
+        }
+        return errors;
+    }
+
+    [[nodiscard]] tl::expected<void, Error> Module::insert_section(usize const index, SourceFile const& source_file) {
+        if (index > m_sections.size()) {
+            throw std::out_of_range{ "Section index out of range." };
+        }
+        auto section = assemble_section(source_file, m_options);
+        if (not section.has_value()) {
+            return tl::unexpected{ section.error() };
+        }
+        m_sections.insert(m_sections.begin() + static_cast<std::ptrdiff_t>(index), std::move(section).value());
+        invalidate_from(index);
+        return {};
+    }
+
+    [[nodiscard]] tl::expected<void, Error> Module::replace_section(usize const index, SourceFile const& source_file) {
+        auto section = assemble_section(source_file, m_options);
+        if (not section.has_value()) {
+            return tl::unexpected{ section.error() };
+        }
+        auto& replaced = m_sections.at(index);
+        auto const offset = replaced.offset;
+        auto const byte_length_changed = section->byte_length != replaced.byte_length;
+        replaced = std::move(section).value();
+        replaced.offset = offset;
+        // The section itself stays where it is. The ones after it only move if its length changed.
+        if (byte_length_changed) {
+            invalidate_from(index + 1);
+        }
+        m_symbols_outdated = true;
+        return {};
+    }
+
+    void Module::erase_section(usize const index) {
+        if (index >= m_sections.size()) {
+            throw std::out_of_range{ "Section index out of range." };
+        }
+        m_sections.erase(m_sections.begin() + static_cast<std::ptrdiff_t>(index));
+        invalidate_from(index);
+    }
+
+    [[nodiscard]] usize Module::num_sections() const {
+        return m_sections.size();
+    }
+
+    [[nodiscard]] tl::expected<InstructionStore, Error> Module::link() {
+        // First pass: lay out the sections that moved and collect all labels.
+        for (auto i = m_first_unplaced_section; i < m_sections.size(); ++i) {
+            m_sections[i].offset = i == 0 ? 0 : m_sections[i - 1].offset + m_sections[i - 1].byte_length;
+        }
+        m_first_unplaced_section = m_sections.size();
+        auto errors = std::vector<Error>{};
+        update_symbols(errors, 1);
+        if (not errors.empty()) {
+            return tl::unexpected{ std::move(errors.front()) };
+        }
+
+        // Second pass: concatenate the sections and patch the symbolic operands.
+        auto num_instructions = usize{ 0 };
+        for (auto const& section : m_sections) {
+            num_instructions += section.instructions.size();
+        }
+        auto instructions = InstructionStore{};
+        instructions.reserve(num_instructions);
+        for (auto const& section : m_sections) {
+            auto const first = instructions.size();
+            for (auto const& instruction : section.instructions) {
+                instructions.push_back(instruction);
+            }
+            for (auto const& relocation : section.relocations) {
+                auto const address = resolve(relocation.symbol);
+                if (not address.has_value()) {
+                    return tl::unexpected{ address.error() };
+                }
+                instructions.set_immediate(first + relocation.instruction_index, address.value());
+            }
+        }
+        return instructions;
+    }
+
+    [[nodiscard]] std::vector<Symbol> Module::symbols() const {
+        auto result = std::vector<Symbol>{};
+        result.reserve(m_symbols.size());
+        for (auto const& section : m_sections) {
+            for (auto const& label : section.labels) {
+                result.push_back(Symbol{
+                    std::string{ label.name.lexeme() },
+                    m_options.base_address + section.offset + label.offset,
+                });
+            }
+        }
+        return result;
+    }
+
+    [[nodiscard]] SourceMap Module::source_map() const {
+        auto builder = SourceMap::Builder{};
+        auto end = m_options.base_address;
+        for (auto const& section : m_sections) {
+            end = add_to_source_map(builder, section, m_options.base_address + section.offset);
+        }
+        return std::move(builder).build(end);
+    }
+
+    [[nodiscard]] OptimizationReport Module::optimization_report() const {
+        auto result = OptimizationReport{};
+        for (auto const& section : m_sections) {
+            result += section.optimization_report;
+        }
+        return result;
+    }
+
+    void Module::invalidate_from(usize const section_index) {
+        m_first_unplaced_section = std::min(m_first_unplaced_section, section_index);
+        m_symbols_outdated = true;
+    }
+
+    void Module::update_symbols(std::vector<Error>& errors, usize const max_errors) {
+        if (not m_symbols_outdated) {
+            return;
+        }
+        m_symbols.clear();
+        auto has_duplicates = false;
+        for (auto i = usize{ 0 }; i < m_sections.size(); ++i) {
+            auto const& labels = m_sections[i].labels;
+            for (auto j = usize{ 0 }; j < labels.size(); ++j) {
+                auto const [_, inserted] = m_symbols.try_emplace(
+                    labels[j].name.lexeme(),
+                    SymbolDefinition{ static_cast<u32>(i), static_cast<u32>(j) }
+                );
+                if (not inserted) {
+                    has_duplicates = true;
+                    if (errors.size() < max_errors) {
+                        errors.push_back(DuplicateLabel{ labels[j].name });
+                    }
+                }
+            }
+        }
+        m_symbols_outdated = has_duplicates;
+    }
+
+    [[nodiscard]] tl::expected<Word, Error> Module::resolve(Token const& symbol) const {
+        auto const definition = m_symbols.find(symbol.lexeme());
+        if (definition == m_symbols.end()) {
+            return tl::unexpected{ UndefinedSymbol{ symbol } };
+        }
+        auto const& section = m_sections[definition->second.section];
+        return m_options.base_address + section.offset + section.labels[definition->second.label].offset;
+    }
+}  // namespace assembler
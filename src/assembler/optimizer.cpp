@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <assembler/optimizer.hpp>
+#include <lib2k/overloaded.hpp>
+#include <magic_enum.hpp>
+
+namespace assembler {
+    namespace {
+        inline constexpr auto num_registers = magic_enum::enum_count<::Register>();
+
+        [[nodiscard]] usize index_of(::Register const register_) {
+            return static_cast<usize>(std::to_underlying(register_));
+        }
+
+        // Value of a register as far as it is known at assembly time. Symbols are compared by name,
+        // since every occurrence of a symbol resolves to the same address.
+        struct KnownValue final {
+            Word immediate;
+            std::string_view symbol;
+
+            [[nodiscard]] friend bool operator==(KnownValue const&, KnownValue const&) = default;
+        };
+
+        [[nodiscard]] KnownValue known_value(LoweredInstruction const& instruction, Word const immediate) {
+            if (instruction.symbol.has_value()) {
+                return KnownValue{ 0, instruction.symbol->lexeme() };
+            }
+            return KnownValue{ immediate, {} };
+        }
+
+        class Pass final {
+        private:
+            std::span<LoweredInstruction const> m_instructions;
+            std::span<u32 const> m_barriers;
+            std::pmr::vector<bool>& m_removed;
+            OptimizationReport& m_report;
+
+        public:
+            [[nodiscard]] Pass(
+                std::span<LoweredInstruction const> const instructions,
+                std::span<u32 const> const barriers,
+                std::pmr::vector<bool>& removed,
+                OptimizationReport& report
+            )
+                : m_instructions{ instructions }, m_barriers{ barriers }, m_removed{ removed }, m_report{ report } {}
+
+            // Returns whether anything was removed.
+            [[nodiscard]] bool remove_redundant_reloads() {
+                auto changed = false;
+                auto known = std::array<tl::optional<KnownValue>, num_registers>{};
+                auto next_barrier = m_barriers.begin();
+                for (auto i = usize{ 0 }; i < m_instructions.size(); ++i) {
+                    for (; next_barrier != m_barriers.end() and *next_barrier == i; ++next_barrier) {
+                        known.fill(tl::nullopt);
+                    }
+                    if (m_removed[i]) {
+                        continue;
+                    }
+                    auto const& lowered = m_instructions[i];
+                    if (auto const load = std::get_if<MoveImmediateIntoRegister>(&lowered.instruction)) {
+                        auto& register_ = known[index_of(load->register_)];
+                        auto const value = known_value(lowered, load->immediate);
+                        if (register_ == value) {
+                            remove(i, m_report.num_redundant_reloads);
+                            changed = true;
+                        } else {
+                            register_ = value;
+                        }
+                    }
+                }
+                return changed;
+            }
+
+            // Backwards liveness analysis. Returns whether anything was removed.
+            [[nodiscard]] bool remove_dead_writes() {
+                auto changed = false;
+                auto live = std::array<bool, num_registers>{};
+                auto overwritten_through = std::array<bool, num_registers>{};  // By a later store.
+                auto const make_everything_live = [&] {
+                    live.fill(true);
+                    overwritten_through.fill(false);
+                };
+                make_everything_live();
+
+                auto next_barrier = m_barriers.rbegin();
+                for (auto i = m_instructions.size(); i > 0; --i) {
+                    auto const index = i - 1;
+                    for (; next_barrier != m_barriers.rend() and *next_barrier > index; ++next_barrier) {
+                        make_everything_live();
+                    }
+                    if (m_removed[index]) {
+                        continue;
+                    }
+                    std::visit(
+                        c2k::Overloaded{
+                            [&](HaltAndCatchFire const&) { make_everything_live(); },
+                            [&](MoveImmediateIntoRegister const& load) {
+                                auto const register_ = index_of(load.register_);
+                                if (not live[register_]) {
+                                    remove(index, m_report.num_dead_register_writes);
+                                    changed = true;
+                                }
+                                live[register_] = false;
+                                overwritten_through[register_] = false;
+                            },
+                            [&](MoveImmediateIntoMemory const& store) {
+                                auto const register_ = index_of(store.pointer.register_());
+                                if (overwritten_through[register_]) {
+                                    remove(index, m_report.num_overwritten_stores);
+                                    changed = true;
+                                    return;
+                                }
+                                live[register_] = true;
+                                overwritten_through[register_] = true;
+                            },
+                            // Reads memory, and other cores may read it after either of them.
+                            [&](AtomicAddImmediateToMemory const&) { make_everything_live(); },
+                            [&](Fence const&) { make_everything_live(); },
+                        },
+                        m_instructions[index].instruction
+                    );
+                }
+                return changed;
+            }
+
+        private:
+            void remove(usize const index, usize& counter) {
+                m_removed[index] = true;
+                ++counter;
+                m_report.num_bytes_saved += m_instructions[index].instruction.byte_length();
+            }
+        };
+    }  // namespace
+
+    [[nodiscard]] OptimizationReport optimize(
+        std::pmr::vector<LoweredInstruction>& instructions,
+        std::span<u32> const barriers
+    ) {
+        auto report = OptimizationReport{};
+        auto removed = std::pmr::vector<bool>(instructions.size(), false, instructions.get_allocator());
+        auto pass = Pass{ instructions, barriers, removed, report };
+        // Each kind of removal can enable the other one, so repeat until nothing changes.
+        auto changed = true;
+        while (changed) {
+            changed = pass.remove_redundant_reloads();
+            changed = pass.remove_dead_writes() or changed;
+        }
+        if (report.num_removed_instructions() == 0) {
+            return report;
+        }
+
+        auto next_barrier = barriers.begin();
+        auto num_kept = usize{ 0 };
+        for (auto i = usize{ 0 }; i < instructions.size(); ++i) {
+            for (; next_barrier != barriers.end() and *next_barrier == i; ++next_barrier) {
+                *next_barrier = static_cast<u32>(num_kept);
+            }
+            if (not removed[i]) {
+                instructions[num_kept] = std::move(instructions[i]);
+                ++num_kept;
+            }
+        }
+        for (; next_barrier != barriers.end(); ++next_barrier) {
+            *next_barrier = static_cast<u32>(num_kept);
+        }
+        instructions.erase(instructions.begin() + static_cast<std::ptrdiff_t>(num_kept), instructions.end());
+        return report;
+    }
+
+    [[nodiscard]] OptimizationReport optimize(std::vector<::Instruction>& instructions) {
+        auto lowered = std::pmr::vector<LoweredInstruction>{};
+        lowered.reserve(instructions.size());
+        for (auto const& instruction : instructions) {
+            lowered.push_back(LoweredInstruction{ instruction, tl::nullopt });
+        }
+        auto const report = optimize(lowered, {});
+        if (report.num_removed_instructions() > 0) {
+            instructions.clear();
+            for (auto& instruction : lowered) {
+                instructions.push_back(std::move(instruction.instruction));
+            }
+        }
+        return report;
+    }
+}  // namespace assembler
@@ -1,32 +1,65 @@
 #include "parser.hpp"
 
 namespace assembler {
-    [[nodiscard]] Parser::Parser(std::vector<Token> tokens)
-        : m_tokens{ std::move(tokens) } {}
+    [[nodiscard]] Parser::Parser(std::pmr::vector<Token> tokens)
+        : m_tokens{ std::move(tokens) },
+          m_ast{ m_tokens.get_allocator().resource() },
+          m_operand_buffer{ m_tokens.get_allocator().resource() } {}
 
     [[nodiscard]] tl::expected<void, Error> Parser::parse() {
         *this = Parser{ std::move(m_tokens) };
         while (true) {
-            while (current().type() == TokenType::Newline) {
-                advance();
+            auto const parsed = item();
+            if (not parsed.has_value()) {
+                return tl::unexpected{ parsed.error() };
             }
-            if (is_at_end()) {
-                break;
+            if (not parsed.value()) {
+                return {};
             }
-            auto instruction = this->instruction();
-            if (not instruction.has_value()) {
-                return tl::unexpected{ instruction.error() };
+        }
+    }
+
+    void Parser::parse_recovering(std::vector<Error>& errors, usize const max_errors) {
+        *this = Parser{ std::move(m_tokens) };
+        while (true) {
+            auto const parsed = item();
+            if (parsed.has_value()) {
+                if (not parsed.value()) {
+                    return;
+                }
+                continue;
             }
-            m_instructions.push_back(std::move(instruction).value());
+            if (errors.size() < max_errors) {
+                errors.push_back(parsed.error());
+            }
+            skip_rest_of_line();
         }
-        return {};
     }
 
-    [[nodiscard]] std::vector<Instruction> Parser::take() && {
-        return std::move(m_instructions);
+    [[nodiscard]] Ast Parser::take() && {
+        return std::move(m_ast);
+    }
+
+    [[nodiscard]] tl::expected<bool, Error> Parser::item() {
+        while (current().type() == TokenType::Newline) {
+            advance();
+        }
+        if (is_at_end()) {
+            return false;
+        }
+        if (current().type() == TokenType::Identifier and peek().type() == TokenType::Colon) {
+            m_ast.add_label(current());
+            advance();
+            advance();
+            return true;
+        }
+        if (auto const result = instruction(); not result.has_value()) {
+            return tl::unexpected{ result.error() };
+        }
+        return true;
     }
 
-    [[nodiscard]] tl::expected<Instruction, Error> Parser::instruction() {
+    [[nodiscard]] tl::expected<void, Error> Parser::instruction() {
         while (true) {
             if (current().type() != TokenType::Newline) {
                 break;
@@ -41,11 +74,11 @@ namespace assembler {
             case Identifier: {
                 auto const mnemonic = current();
                 advance();
-                auto operands = this->operands();
-                if (not operands.has_value()) {
-                    return tl::unexpected{ operands.error() };
+                if (auto const result = operands(); not result.has_value()) {
+                    return tl::unexpected{ result.error() };
                 }
-                return Instruction{ mnemonic, std::move(operands).value() };
+                m_ast.add_instruction(mnemonic, m_operand_buffer);
+                return {};
             }
             default:
                 return tl::unexpected{
@@ -65,6 +98,19 @@ namespace assembler {
         return m_tokens.at(m_index);
     }
 
+    [[nodiscard]] Token const& Parser::peek() const {
+        if (m_index + 1 >= m_tokens.size()) {
+            return m_tokens.at(m_tokens.size() - 1);
+        }
+        return m_tokens.at(m_index + 1);
+    }
+
+    void Parser::skip_rest_of_line() {
+        while (not is_at_end() and current().type() != TokenType::Newline) {
+            advance();
+        }
+    }
+
     void Parser::advance() {
         if (is_at_end()) {
             return;
@@ -72,61 +118,67 @@ namespace assembler {
         ++m_index;
     }
 
-    [[nodiscard]] tl::expected<std::vector<std::unique_ptr<Operand>>, Error> Parser::operands() {
-        auto operands = std::vector<std::unique_ptr<Operand>>{};
+    [[nodiscard]] tl::expected<void, Error> Parser::operands() {
+        m_operand_buffer.clear();
         while (true) {
             if (current().type() == TokenType::EndOfInput or current().type() == TokenType::Newline) {
-                return operands;
+                return {};
             }
 
-            auto operand = this->operand();
+            auto const operand = this->operand();
             if (not operand.has_value()) {
                 return tl::unexpected{ operand.error() };
             }
 
-            operands.push_back(std::move(operand).value());
+            m_operand_buffer.push_back(operand.value());
 
             if (current().type() != TokenType::Comma) {
-                return operands;
+                return {};
             }
 
             advance();
         }
     }
 
-    [[nodiscard]] tl::expected<std::unique_ptr<Operand>, Error> Parser::operand() {
+    [[nodiscard]] tl::expected<Operand, Error> Parser::operand() {
         switch (current().type()) {
             case TokenType::Register: {
-                auto register_ = std::make_unique<Register>(current());
+                auto const register_ = Operand::register_(current());
                 advance();
                 return register_;
             }
             case TokenType::Identifier: {
-                auto identifier = std::make_unique<Identifier>(current());
+                auto const identifier = Operand::identifier(current());
                 advance();
                 return identifier;
             }
             case TokenType::Integer: {
-                auto immediate = std::make_unique<Immediate>(current());
+                auto const immediate = Operand::immediate(current());
                 advance();
                 return immediate;
             }
             case TokenType::Asterisk: {
                 auto const asterisk = current();
                 advance();
-                auto pointee = this->operand();
+                auto const pointee = this->operand();
                 if (not pointee.has_value()) {
                     return tl::unexpected{ pointee.error() };
                 }
-                return std::make_unique<Pointer>(asterisk, std::move(pointee).value());
+                // Pointees are stored right away, so that the top-level operands of the current
+                // instruction can still be appended as one consecutive range afterwards.
+                return Operand::pointer(asterisk, m_ast.add_operand(pointee.value()));
             }
             case TokenType::Comma:
+            case TokenType::Colon:
                 return tl::unexpected{
                     UnexpectedToken{ current(), "Expected operand." }
                 };
             case TokenType::EndOfInput:
             case TokenType::Newline:
-                throw std::logic_error{ "Token type should have been checked before." };
+                // Only reachable for an asterisk without pointee, operands() checks for these before.
+                return tl::unexpected{
+                    UnexpectedToken{ current(), "Expected operand." }
+                };
         }
         throw std::logic_error{ "Unreachable." };
     }
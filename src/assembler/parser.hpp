@@ -1,7 +1,9 @@
 #pragma once
 
+#include <assembler/ast.hpp>
 #include <assembler/error.hpp>
 #include <assembler/instruction.hpp>
+#include <memory_resource>
 #include <string_view>
 #include <tl/expected.hpp>
 #include <tl/optional.hpp>
@@ -10,28 +12,41 @@
 namespace assembler {
     class Parser final {
     private:
-        std::vector<Token> m_tokens;
-        std::vector<Instruction> m_instructions;
+        std::pmr::vector<Token> m_tokens;
+        Ast m_ast;
+        std::pmr::vector<Operand> m_operand_buffer;  // Top-level operands of the current instruction.
         usize m_index = 0;
 
     public:
-        [[nodiscard]] explicit Parser(std::vector<Token> tokens);
+        // The syntax tree is allocated from the same memory resource as the tokens.
+        [[nodiscard]] explicit Parser(std::pmr::vector<Token> tokens);
 
         [[nodiscard]] tl::expected<void, Error> parse();
 
-        [[nodiscard]] std::vector<Instruction> take() &&;
+        // Instead of stopping at the first error, skips the rest of the offending line and carries on
+        // with the next one. Errors are only recorded while `errors` holds fewer than `max_errors`.
+        void parse_recovering(std::vector<Error>& errors, usize max_errors);
+
+        [[nodiscard]] Ast take() &&;
 
     private:
-        [[nodiscard]] tl::expected<Instruction, Error> instruction();
+        // Parses a label or an instruction. Returns false at the end of the input.
+        [[nodiscard]] tl::expected<bool, Error> item();
+
+        [[nodiscard]] tl::expected<void, Error> instruction();
+
+        void skip_rest_of_line();
 
         [[nodiscard]] bool is_at_end() const;
 
         [[nodiscard]] Token const& current() const;
 
+        [[nodiscard]] Token const& peek() const;
+
         void advance();
 
-        [[nodiscard]] tl::expected<std::vector<std::unique_ptr<Operand>>, Error> operands();
+        [[nodiscard]] tl::expected<void, Error> operands();
 
-        [[nodiscard]] tl::expected<std::unique_ptr<Operand>, Error> operand();
+        [[nodiscard]] tl::expected<Operand, Error> operand();
     };
 }  // namespace assembler
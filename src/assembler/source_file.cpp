@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <assembler/source_file.hpp>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace assembler {
+    [[nodiscard]] SourceFile::SourceFile(std::string_view const filename, std::string_view const source)
+        : m_filename{ filename }, m_source{ source } {
+        if (m_source.length() > max_size) {
+            throw std::length_error{ "Source file too large." };
+        }
+    }
+
+    [[nodiscard]] SourceFile::SourceFile(std::string filename, MappedFile mapping)
+        : m_owned_filename{ std::move(filename) },
+          m_mapping{ std::move(mapping) },
+          m_filename{ m_owned_filename },
+          m_source{ reinterpret_cast<char const*>(m_mapping->bytes().data()), m_mapping->bytes().size() } {
+        if (m_source.length() > max_size) {
+            throw std::length_error{ "Source file too large." };
+        }
+    }
+
+    [[nodiscard]] std::unique_ptr<SourceFile> SourceFile::map(std::filesystem::path const& path) {
+        auto mapping = MappedFile::open(path);
+        if (not mapping.has_value()) {
+            return nullptr;
+        }
+        // Not std::make_unique(), the constructor is private.
+        return std::unique_ptr<SourceFile>{ new SourceFile{ path.string(), std::move(mapping).value() } };
+    }
+
+    [[nodiscard]] usize SourceFile::row(usize const offset) const {
+        auto const& starts = line_starts();
+        auto const next_line = std::upper_bound(starts.cbegin(), starts.cend(), offset);
+        return static_cast<usize>(next_line - starts.cbegin());
+    }
+
+    [[nodiscard]] usize SourceFile::column(usize const offset) const {
+        return offset - line_starts().at(row(offset) - 1) + 1;
+    }
+
+    [[nodiscard]] std::string_view SourceFile::line(usize const row) const {
+        auto const& starts = line_starts();
+        assert(row >= 1 and row <= starts.size());
+        auto const start = usize{ starts.at(row - 1) };
+        auto const end = row < starts.size() ? usize{ starts.at(row) } - 1 : m_source.length();
+        return m_source.substr(start, end - start);
+    }
+
+    [[nodiscard]] std::vector<u32> const& SourceFile::line_starts() const {
+        std::call_once(m_line_starts_built, [this] {
+            m_line_starts.push_back(0);
+            auto const begin = m_source.data();
+            auto const end = begin + m_source.length();
+            auto current = begin;
+            while (auto const newline =
+                       static_cast<char const*>(std::memchr(current, '\n', static_cast<usize>(end - current)))) {
+                m_line_starts.push_back(static_cast<u32>(newline + 1 - begin));
+                current = newline + 1;
+            }
+        });
+        return m_line_starts;
+    }
+}  // namespace assembler
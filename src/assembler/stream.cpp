@@ -0,0 +1,84 @@
+#include <assembler/assembler.hpp>
+#include <exception>
+#include <iterator>
+#include <unordered_map>
+#include "chunk.hpp"
+
+namespace assembler {
+    [[nodiscard]] tl::expected<StreamResult, Error> stream(
+        SourceFile const& source_file,
+        Sink const& sink,
+        Options const& options
+    ) {
+        auto const chunks = split(source_file.source());
+        auto arena = ChunkArena{ options.memory_resource };
+
+        // First pass: lay out the chunks and collect the labels. Only the earliest error is kept, in the
+        // same order as assemble() reports them: the earliest phase wins, then the earliest chunk.
+        auto failure = tl::optional<ChunkResult>{};
+        auto addresses = std::unordered_map<std::string_view, Word>{};
+        auto symbols = std::vector<Symbol>{};
+        auto duplicate = tl::optional<Error>{};
+        auto offset = Word{ 0 };
+        for (auto const& chunk : chunks) {
+            auto result = assemble_chunk(source_file, chunk, options.optimize, arena.next_chunk());
+            if (result.failed_phase.has_value()) {
+                if (not failure.has_value() or result.failed_phase.value() < failure->failed_phase.value()) {
+                    result.section = {};
+                    failure = std::move(result);
+                }
+                if (failure->failed_phase.value() == Phase::Lexing) {
+                    break;  // Nothing that comes later can be reported first.
+                }
+                continue;
+            }
+            for (auto const& label : result.section.labels) {
+                auto const address = options.base_address + offset + label.offset;
+                auto const [_, inserted] = addresses.try_emplace(label.name.lexeme(), address);
+                if (not inserted) {
+                    if (not duplicate.has_value()) {
+                        duplicate = DuplicateLabel{ label.name };
+                    }
+                    continue;
+                }
+                symbols.push_back(Symbol{ std::string{ label.name.lexeme() }, address });
+            }
+            offset += result.section.byte_length;
+        }
+        if (failure.has_value()) {
+            if (failure->exception) {
+                std::rethrow_exception(failure->exception);
+            }
+            return tl::unexpected{ failure->error.value() };
+        }
+        if (duplicate.has_value()) {
+            return tl::unexpected{ duplicate.value() };
+        }
+
+        // Second pass: assemble every chunk again, now with all addresses known, and emit its bytes.
+        auto bytes = std::vector<std::byte>{};
+        auto source_map = SourceMap::Builder{};
+        auto address = options.base_address;
+        for (auto const& chunk : chunks) {
+            auto result = assemble_chunk(source_file, chunk, options.optimize, arena.next_chunk());
+            if (result.exception) {
+                std::rethrow_exception(result.exception);
+            }
+            auto& section = result.section;
+            for (auto const& relocation : section.relocations) {
+                auto const definition = addresses.find(relocation.symbol.lexeme());
+                if (definition == addresses.end()) {
+                    return tl::unexpected{ UndefinedSymbol{ relocation.symbol } };
+                }
+                patch_immediate(section.instructions.at(relocation.instruction_index), definition->second);
+            }
+            bytes.clear();
+            for (auto const& instruction : section.instructions) {
+                instruction.encode(std::back_inserter(bytes));
+            }
+            address = add_to_source_map(source_map, section, address);
+            sink(bytes);
+        }
+        return StreamResult{ std::move(symbols), std::move(source_map).build(address) };
+    }
+}  // namespace assembler
@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <common/compression.hpp>
+#include <common/memory.hpp>
+#include <tl/optional.hpp>
+
+namespace {
+    constexpr auto min_match_length = usize{ 4 };
+    constexpr auto max_offset = usize{ 0xFFFF };
+    constexpr auto nibble_max = usize{ 15 };
+    constexpr auto hash_bits = 12;
+
+    // Of the four bytes at a position.
+    [[nodiscard]] usize hash(u32 const sequence) {
+        return static_cast<usize>((sequence * u32{ 2'654'435'761 }) >> (32 - hash_bits));
+    }
+
+    // Compares eight bytes at a time.
+    [[nodiscard]] usize common_length(std::span<std::byte const> const input, usize lhs, usize rhs) {
+        auto result = usize{ 0 };
+        while (rhs + sizeof(u64) <= input.size()) {
+            auto const difference = load_little_endian<u64>(input.data() + lhs)
+                                    ^ load_little_endian<u64>(input.data() + rhs);
+            if (difference != 0) {
+                return result + static_cast<usize>(std::countr_zero(difference)) / 8;
+            }
+            lhs += sizeof(u64);
+            rhs += sizeof(u64);
+            result += sizeof(u64);
+        }
+        while (rhs < input.size() and input[lhs] == input[rhs]) {
+            ++lhs;
+            ++rhs;
+            ++result;
+        }
+        return result;
+    }
+
+    // The part of a length that does not fit into the nibble of the token.
+    void write_length(std::vector<std::byte>& output, usize length) {
+        if (length < nibble_max) {
+            return;
+        }
+        length -= nibble_max;
+        while (length >= 0xFF) {
+            output.push_back(std::byte{ 0xFF });
+            length -= 0xFF;
+        }
+        output.push_back(static_cast<std::byte>(length));
+    }
+
+    void write_sequence(
+        std::vector<std::byte>& output,
+        std::span<std::byte const> const literals,
+        usize const offset,
+        usize const match_length
+    ) {
+        auto const match_nibble = match_length == 0 ? 0 : std::min(match_length - min_match_length, nibble_max);
+        output.push_back(static_cast<std::byte>((std::min(literals.size(), nibble_max) << 4) | match_nibble));
+        write_length(output, literals.size());
+        output.insert(output.end(), literals.begin(), literals.end());
+        if (match_length == 0) {
+            return;
+        }
+        output.push_back(static_cast<std::byte>(offset & 0xFF));
+        output.push_back(static_cast<std::byte>(offset >> 8));
+        write_length(output, match_length - min_match_length);
+    }
+
+    [[nodiscard]] tl::optional<usize> read_length(
+        std::span<std::byte const> const input,
+        usize& position,
+        usize const nibble
+    ) {
+        auto result = nibble;
+        if (nibble != nibble_max) {
+            return result;
+        }
+        auto byte = std::byte{ 0xFF };
+        while (byte == std::byte{ 0xFF }) {
+            if (position == input.size()) {
+                return tl::nullopt;
+            }
+            byte = input[position++];
+            result += std::to_integer<usize>(byte);
+        }
+        return result;
+    }
+}  // namespace
+
+[[nodiscard]] std::vector<std::byte> compress(std::span<std::byte const> const input) {
+    auto output = std::vector<std::byte>{};
+    output.reserve(input.size() + input.size() / 255 + 16);
+    // Last position of every hash. Positions past 4 GiB wrap around, which only loses matches.
+    auto table = std::array<u32, usize{ 1 } << hash_bits>{};
+    auto anchor = usize{ 0 };  // Start of the literals that are not written yet.
+    auto position = usize{ 0 };
+    while (position + min_match_length <= input.size()) {
+        auto const sequence = load_little_endian<u32>(input.data() + position);
+        auto& entry = table[hash(sequence)];
+        auto const candidate = usize{ entry };
+        entry = static_cast<u32>(position);
+        if (candidate < position and position - candidate <= max_offset
+            and load_little_endian<u32>(input.data() + candidate) == sequence) {
+            auto const length = min_match_length
+                                + common_length(input, candidate + min_match_length, position + min_match_length);
+            write_sequence(output, input.subspan(anchor, position - anchor), position - candidate, length);
+            position += length;
+            anchor = position;
+        } else {
+            // Skips ahead faster the longer nothing matches, so that incompressible data passes quickly.
+            position += 1 + ((position - anchor) >> 6);
+        }
+    }
+    write_sequence(output, input.subspan(anchor), 0, 0);
+    return output;
+}
+
+[[nodiscard]] bool decompress(std::span<std::byte const> const input, std::span<std::byte> const output) {
+    auto in = usize{ 0 };
+    auto out = usize{ 0 };
+    while (in < input.size()) {
+        auto const token = std::to_integer<usize>(input[in++]);
+        auto const num_literals = read_length(input, in, token >> 4);
+        if (not num_literals.has_value() or num_literals.value() > input.size() - in
+            or num_literals.value() > output.size() - out) {
+            return false;
+        }
+        std::ranges::copy(input.subspan(in, num_literals.value()), output.subspan(out).begin());
+        in += num_literals.value();
+        out += num_literals.value();
+        if (in == input.size()) {
+            break;  // The last sequence has no match.
+        }
+
+        if (input.size() - in < 2) {
+            return false;
+        }
+        auto const offset = std::to_integer<usize>(input[in]) | std::to_integer<usize>(input[in + 1]) << 8;
+        in += 2;
+        auto const extra_length = read_length(input, in, token & nibble_max);
+        if (not extra_length.has_value() or offset == 0 or offset > out
+            or extra_length.value() + min_match_length > output.size() - out) {
+            return false;
+        }
+        auto const match_length = extra_length.value() + min_match_length;
+        if (offset >= match_length) {
+            std::ranges::copy(output.subspan(out - offset, match_length), output.subspan(out).begin());
+            out += match_length;
+        } else {
+            // The match overlaps with what it produces, e.g. a run of one byte has an offset of one.
+            for (auto i = usize{ 0 }; i < match_length; ++i, ++out) {
+                output[out] = output[out - offset];
+            }
+        }
+    }
+    return out == output.size();
+}
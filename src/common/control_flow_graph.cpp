@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <common/control_flow_graph.hpp>
+#include <exception>
+#include <unordered_map>
+#include <variant>
+
+namespace {
+    // Returns the error message if the bytes do not hold a valid instruction.
+    [[nodiscard]] std::variant<Instruction, std::string> try_decode(std::span<std::byte const> const bytes) {
+        try {
+            return Instruction::decode(bytes);
+        } catch (std::exception const& exception) {
+            return std::string{ exception.what() };
+        }
+    }
+}  // namespace
+
+[[nodiscard]] ControlFlowGraph ControlFlowGraph::build(
+    std::span<std::byte const> const memory,
+    Word const base_address,
+    std::span<Word const> const entry_points
+) {
+    auto graph = ControlFlowGraph{};
+    auto node_at = std::unordered_map<Word, usize>{};
+    auto const fail = [&](Word const address, std::string message) {
+        auto const is_known = std::ranges::any_of(graph.m_decode_failures, [&](DecodeFailure const& failure) {
+            return failure.address == address;
+        });
+        if (not is_known) {
+            graph.m_decode_failures.push_back(DecodeFailure{ address, std::move(message) });
+        }
+    };
+
+    for (auto const entry_point : entry_points) {
+        auto address = usize{ entry_point };
+        auto previous = none;
+        while (true) {
+            if (address < base_address or address - base_address >= memory.size()) {
+                fail(static_cast<Word>(address), "Execution leaves memory.");
+                break;
+            }
+            if (auto const found = node_at.find(static_cast<Word>(address)); found != node_at.end()) {
+                if (previous != none) {
+                    graph.m_nodes.at(previous).next = found->second;
+                }
+                break;
+            }
+            auto decoded = try_decode(memory.subspan(address - base_address));
+            if (auto const message = std::get_if<std::string>(&decoded)) {
+                fail(static_cast<Word>(address), std::move(*message));
+                break;
+            }
+
+            auto const& instruction = std::get<Instruction>(decoded);
+            auto const index = graph.m_nodes.size();
+            graph.m_nodes.push_back(Node{ static_cast<Word>(address), none });
+            graph.m_instructions.push_back(instruction);
+            node_at.emplace(static_cast<Word>(address), index);
+            if (previous != none) {
+                graph.m_nodes.at(previous).next = index;
+            }
+            if (std::holds_alternative<HaltAndCatchFire>(instruction)) {
+                break;
+            }
+            address += instruction.byte_length();
+            previous = index;
+        }
+    }
+
+    graph.m_nodes_by_address.reserve(graph.m_nodes.size());
+    for (auto i = usize{ 0 }; i < graph.m_nodes.size(); ++i) {
+        graph.m_nodes_by_address.emplace_back(graph.m_nodes[i].address, i);
+    }
+    std::ranges::sort(graph.m_nodes_by_address);
+
+    graph.build_blocks(entry_points);
+    graph.mark_loop_headers();
+    return graph;
+}
+
+[[nodiscard]] tl::optional<usize> ControlFlowGraph::find(Word const address) const {
+    // Instructions may overlap when paths decode the same bytes at different offsets, so every instruction
+    // that starts close enough before `address` is a candidate.
+    auto const end = std::ranges::upper_bound(m_nodes_by_address, address, {}, &std::pair<Word, usize>::first);
+    for (auto it = end; it != m_nodes_by_address.begin();) {
+        --it;
+        if (address - it->first >= Instruction::max_byte_length) {
+            break;
+        }
+        if (address - it->first < m_instructions.byte_length(it->second)) {
+            return it->second;
+        }
+    }
+    return tl::nullopt;
+}
+
+void ControlFlowGraph::build_blocks(std::span<Word const> const entry_points) {
+    auto const find_exact = [&](Word const address) {
+        auto const it = std::ranges::lower_bound(m_nodes_by_address, address, {}, &std::pair<Word, usize>::first);
+        return it != m_nodes_by_address.end() and it->first == address ? it->second : none;
+    };
+
+    // Blocks start at entry points, where paths meet, and wherever a node does not follow its predecessor.
+    auto num_predecessors = std::vector<usize>(m_nodes.size(), 0);
+    for (auto const& node : m_nodes) {
+        if (node.next != none) {
+            ++num_predecessors.at(node.next);
+        }
+    }
+    auto is_leader = std::vector<bool>(m_nodes.size(), false);
+    for (auto const entry_point : entry_points) {
+        if (auto const index = find_exact(entry_point); index != none) {
+            is_leader.at(index) = true;
+        }
+    }
+
+    auto block_of = std::vector<usize>(m_nodes.size(), none);
+    for (auto i = usize{ 0 }; i < m_nodes.size(); ++i) {
+        if (i == 0 or is_leader[i] or num_predecessors[i] != 1 or m_nodes[i - 1].next != i) {
+            m_blocks.push_back(BasicBlock{ i, 0, {}, false });
+        }
+        ++m_blocks.back().num_nodes;
+        block_of[i] = m_blocks.size() - 1;
+    }
+
+    for (auto& block : m_blocks) {
+        if (auto const next = m_nodes.at(block.first_node + block.num_nodes - 1).next; next != none) {
+            block.successors.push_back(block_of.at(next));
+        }
+    }
+
+    m_entry_blocks.reserve(entry_points.size());
+    for (auto const entry_point : entry_points) {
+        auto const index = find_exact(entry_point);
+        m_entry_blocks.push_back(index == none ? none : block_of.at(index));
+    }
+}
+
+void ControlFlowGraph::mark_loop_headers() {
+    // Depth-first search: an edge to a block that is still on the stack closes a loop.
+    enum class State : u8 {
+        Unvisited,
+        OnStack,
+        Finished,
+    };
+
+    auto states = std::vector<State>(m_blocks.size(), State::Unvisited);
+    auto stack = std::vector<std::pair<usize, usize>>{};  // Block and the index of its next successor to visit.
+    for (auto const entry_block : m_entry_blocks) {
+        if (entry_block == none or states.at(entry_block) != State::Unvisited) {
+            continue;
+        }
+        states.at(entry_block) = State::OnStack;
+        stack.emplace_back(entry_block, 0);
+        while (not stack.empty()) {
+            auto const [block, successor_index] = stack.back();
+            auto const& successors = m_blocks.at(block).successors;
+            if (successor_index == successors.size()) {
+                states.at(block) = State::Finished;
+                stack.pop_back();
+                continue;
+            }
+            ++stack.back().second;
+            auto const successor = successors.at(successor_index);
+            if (states.at(successor) == State::OnStack) {
+                m_blocks.at(successor).is_loop_header = true;
+            } else if (states.at(successor) == State::Unvisited) {
+                states.at(successor) = State::OnStack;
+                stack.emplace_back(successor, 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <common/common.hpp>
+#include <common/memory.hpp>
+#include <concepts>
+#include <cstddef>
+#include <lib2k/types.hpp>
+#include <span>
+#include <tl/optional.hpp>
+#include <utility>
+#include <vector>
+
+// Building and parsing binary files such as cache entries and save states. All integers are little endian.
+
+class ByteWriter final {
+private:
+    std::vector<std::byte> m_bytes;
+
+public:
+    void write(std::integral auto const value) {
+        auto const little_endian = to_little_endian(value);
+        auto const bytes = std::as_bytes(std::span{ &little_endian, 1 });
+        m_bytes.insert(m_bytes.end(), bytes.begin(), bytes.end());
+    }
+
+    void write(std::span<std::byte const> const bytes) {
+        m_bytes.insert(m_bytes.end(), bytes.begin(), bytes.end());
+    }
+
+    void pad_to(usize const alignment) {
+        m_bytes.resize((m_bytes.size() + alignment - 1) / alignment * alignment);
+    }
+
+    void overwrite(usize const offset, u64 const value) {
+        store_little_endian(std::span{ m_bytes }, offset, value);
+    }
+
+    [[nodiscard]] usize size() const {
+        return m_bytes.size();
+    }
+
+    [[nodiscard]] std::span<std::byte const> bytes() const {
+        return m_bytes;
+    }
+
+    [[nodiscard]] std::vector<std::byte> take() && {
+        return std::move(m_bytes);
+    }
+};
+
+// Bounds-checked reading of untrusted files.
+class ByteReader final {
+private:
+    std::span<std::byte const> m_bytes;
+
+public:
+    [[nodiscard]] explicit ByteReader(std::span<std::byte const> const bytes)
+        : m_bytes{ bytes } {}
+
+    template<MemoryValue Integral>
+    [[nodiscard]] tl::optional<Integral> read() {
+        auto const bytes = read(sizeof(Integral));
+        if (not bytes.has_value()) {
+            return tl::nullopt;
+        }
+        return load_little_endian<Integral>(bytes->data());
+    }
+
+    [[nodiscard]] tl::optional<std::span<std::byte const>> read(usize const size) {
+        if (size > m_bytes.size()) {
+            return tl::nullopt;
+        }
+        auto const result = m_bytes.first(size);
+        m_bytes = m_bytes.subspan(size);
+        return result;
+    }
+
+    [[nodiscard]] bool is_at_end() const {
+        return m_bytes.empty();
+    }
+};
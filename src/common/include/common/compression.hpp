@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <lib2k/types.hpp>
+#include <span>
+#include <vector>
+
+// A byte-oriented LZ77 compressor in the spirit of LZ4, built for speed rather than ratio. The output is a
+// series of sequences, each a token byte (literal count in the high nibble, match length minus four in the
+// low one, 15 meaning that more length bytes follow), the literals, and a little-endian 16-bit offset back
+// into the output. The last sequence consists of literals only.
+
+// Never fails. Incompressible input grows by less than one percent plus a few bytes.
+[[nodiscard]] std::vector<std::byte> compress(std::span<std::byte const> input);
+
+// Returns false if `input` is not compressed data that decompresses to exactly `output.size()` bytes. Never
+// writes outside of `output`, so untrusted input is fine.
+[[nodiscard]] bool decompress(std::span<std::byte const> input, std::span<std::byte> output);
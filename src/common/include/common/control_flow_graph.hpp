@@ -0,0 +1,92 @@
+#pragma once
+
+#include <common/common.hpp>
+#include <cstddef>
+#include <lib2k/types.hpp>
+#include <limits>
+#include <span>
+#include <string>
+#include <tl/optional.hpp>
+#include <utility>
+#include <vector>
+#include "instruction.hpp"
+#include "instruction_store.hpp"
+
+// The instructions that can be reached from a set of entry points, decoded once and grouped into basic blocks.
+// The instruction set has no jumps yet, so every instruction falls through to the one behind it, but the graph
+// is not built on that assumption: blocks start wherever paths meet, and blocks on a cycle are marked as loop
+// headers.
+class ControlFlowGraph final {
+public:
+    static constexpr auto none = std::numeric_limits<usize>::max();
+
+    // The instruction of a node is the one with the same index in instructions().
+    struct Node final {
+        Word address;
+        usize next;  // Index of the node that executes next, or `none` if there is none.
+    };
+
+    struct BasicBlock final {
+        usize first_node;  // The nodes of a block are contiguous.
+        usize num_nodes;
+        std::vector<usize> successors;  // Indices of blocks.
+        bool is_loop_header;            // Entered by a back edge. Loops are the candidates for hot paths.
+    };
+
+    // A reachable address at which no instruction can be decoded.
+    struct DecodeFailure final {
+        Word address;
+        std::string message;
+    };
+
+private:
+    std::vector<Node> m_nodes;
+    InstructionStore m_instructions;
+    std::vector<std::pair<Word, usize>> m_nodes_by_address;  // Sorted by address.
+    std::vector<BasicBlock> m_blocks;
+    std::vector<usize> m_entry_blocks;  // Per entry point, `none` if nothing can be decoded there.
+    std::vector<DecodeFailure> m_decode_failures;
+
+public:
+    // Decodes every instruction reachable from `entry_points` in `memory`, whose first byte is at
+    // `base_address`. Paths end at halts and at decode failures.
+    [[nodiscard]] static ControlFlowGraph build(
+        std::span<std::byte const> memory,
+        Word base_address,
+        std::span<Word const> entry_points
+    );
+
+    [[nodiscard]] std::span<Node const> nodes() const {
+        return m_nodes;
+    }
+
+    [[nodiscard]] InstructionStore const& instructions() const {
+        return m_instructions;
+    }
+
+    [[nodiscard]] std::span<BasicBlock const> blocks() const {
+        return m_blocks;
+    }
+
+    [[nodiscard]] std::span<Node const> nodes(BasicBlock const& block) const {
+        return std::span{ m_nodes }.subspan(block.first_node, block.num_nodes);
+    }
+
+    [[nodiscard]] std::span<usize const> entry_blocks() const {
+        return m_entry_blocks;
+    }
+
+    [[nodiscard]] std::span<DecodeFailure const> decode_failures() const {
+        return m_decode_failures;
+    }
+
+    // Index of the node whose instruction contains the byte at `address`.
+    [[nodiscard]] tl::optional<usize> find(Word address) const;
+
+private:
+    [[nodiscard]] ControlFlowGraph() = default;
+
+    void build_blocks(std::span<Word const> entry_points);
+
+    void mark_loop_headers();
+};
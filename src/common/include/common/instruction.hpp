@@ -2,22 +2,48 @@
 
 #include <fmt/format.h>
 #include <fmt/ostream.h>
+#include <algorithm>
 #include <common/common.hpp>
+#include <common/memory.hpp>
 #include <common/pointer.hpp>
 #include <common/register.hpp>
+#include <concepts>
 #include <lib2k/static_vector.hpp>
 #include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 #include "opcode.hpp"
 
 class Instruction;
 
+// Encoding helpers. All encodings are little-endian, independent of the host, and usable in constant evaluation.
+constexpr void write_into(Opcode const opcode, std::span<std::byte> const buffer) {
+    buffer[0] = static_cast<std::byte>(std::to_underlying(opcode));
+}
+
+constexpr void write_into(Register const register_, std::span<std::byte> const buffer) {
+    buffer[0] = static_cast<std::byte>(std::to_underlying(register_));
+}
+
+constexpr void write_into(Pointer const pointer, std::span<std::byte> const buffer) {
+    write_into(pointer.register_(), buffer);
+}
+
+constexpr void write_into(MemoryValue auto const value, std::span<std::byte> const buffer) {
+    store_little_endian(buffer, 0, value);
+}
+
 struct HaltAndCatchFire final {
     static constexpr auto opcode = Opcode::HaltAndCatchFire;
     static constexpr auto byte_length = usize{ 1 };
 
-    void encode_into(std::span<std::byte> buffer) const;
+    constexpr void encode_into(std::span<std::byte> const buffer) const {
+        write_into(opcode, buffer);
+    }
 
     [[nodiscard]] static Instruction decode(std::span<std::byte const> buffer);
 };
@@ -29,10 +55,14 @@ struct MoveImmediateIntoRegister final {
     Word immediate;
     Register register_;
 
-    [[nodiscard]] explicit MoveImmediateIntoRegister(Word const immediate, Register const register_)
+    [[nodiscard]] constexpr explicit MoveImmediateIntoRegister(Word const immediate, Register const register_)
         : immediate{ immediate }, register_{ register_ } {}
 
-    void encode_into(std::span<std::byte> buffer) const;
+    constexpr void encode_into(std::span<std::byte> const buffer) const {
+        write_into(opcode, buffer.subspan(0));
+        write_into(immediate, buffer.subspan(1));
+        write_into(register_, buffer.subspan(1 + sizeof(immediate)));
+    }
 
     [[nodiscard]] static Instruction decode(std::span<std::byte const> buffer);
 
@@ -49,10 +79,14 @@ struct MoveImmediateIntoMemory final {
     Word immediate;
     Pointer pointer;
 
-    [[nodiscard]] explicit MoveImmediateIntoMemory(Word const immediate, Pointer pointer)
+    [[nodiscard]] constexpr explicit MoveImmediateIntoMemory(Word const immediate, Pointer pointer)
         : immediate{ immediate }, pointer{ pointer } {}
 
-    void encode_into(std::span<std::byte> buffer) const;
+    constexpr void encode_into(std::span<std::byte> const buffer) const {
+        write_into(opcode, buffer.subspan(0));
+        write_into(immediate, buffer.subspan(1));
+        write_into(pointer, buffer.subspan(1 + sizeof(immediate)));
+    }
 
     [[nodiscard]] static Instruction decode(std::span<std::byte const> buffer);
 
@@ -61,11 +95,51 @@ struct MoveImmediateIntoMemory final {
     }
 };
 
+// Adds the immediate to the word the pointer points to, as a single sequentially consistent read-modify-write.
+// The word must be aligned.
+struct AtomicAddImmediateToMemory final {
+    static constexpr auto opcode = Opcode::AtomicAddImmediateToMemory;
+    static constexpr auto byte_length =
+        usize{ 1 + sizeof(Word) + Pointer::byte_length() };  // Opcode + immediate + pointer.
+
+    Word immediate;
+    Pointer pointer;
+
+    [[nodiscard]] constexpr explicit AtomicAddImmediateToMemory(Word const immediate, Pointer pointer)
+        : immediate{ immediate }, pointer{ pointer } {}
+
+    constexpr void encode_into(std::span<std::byte> const buffer) const {
+        write_into(opcode, buffer.subspan(0));
+        write_into(immediate, buffer.subspan(1));
+        write_into(pointer, buffer.subspan(1 + sizeof(immediate)));
+    }
+
+    [[nodiscard]] static Instruction decode(std::span<std::byte const> buffer);
+
+    [[nodiscard]] friend std::string format_as(AtomicAddImmediateToMemory const& inst) {
+        return fmt::format(" - {} (0x{:08x}) to {}", inst.immediate, inst.immediate, inst.pointer);
+    }
+};
+
+// Sequentially consistent fence: no memory access is reordered across it.
+struct Fence final {
+    static constexpr auto opcode = Opcode::Fence;
+    static constexpr auto byte_length = usize{ 1 };
+
+    constexpr void encode_into(std::span<std::byte> const buffer) const {
+        write_into(opcode, buffer);
+    }
+
+    [[nodiscard]] static Instruction decode(std::span<std::byte const> buffer);
+};
+
 // clang-format off
 using InstructionBase = std::variant<
     HaltAndCatchFire,
     MoveImmediateIntoRegister,
-    MoveImmediateIntoMemory
+    MoveImmediateIntoMemory,
+    AtomicAddImmediateToMemory,
+    Fence
 >;
 // clang-format on
 
@@ -91,15 +165,19 @@ private:
 public:
     using variant::variant;
 
-    [[nodiscard]] Opcode opcode() const {
+    static constexpr auto max_byte_length = []<typename... Instructions>(std::variant<Instructions...> const*) {
+        return std::max({ Instructions::byte_length... });
+    }(static_cast<InstructionBase const*>(nullptr));
+
+    [[nodiscard]] constexpr Opcode opcode() const {
         return std::visit([](auto const& instruction) { return instruction.opcode; }, *this);
     }
 
-    [[nodiscard]] usize byte_length() const {
+    [[nodiscard]] constexpr usize byte_length() const {
         return std::visit([](auto const& instruction) { return instruction.byte_length; }, *this);
     }
 
-    void encode(std::output_iterator<std::byte> auto output) const {
+    constexpr void encode(std::output_iterator<std::byte> auto output) const {
         std::visit(
             [&]<typename Instruction>(Instruction const& instruction) {
                 auto buffer = std::array<std::byte, Instruction::byte_length>{};
@@ -111,6 +189,9 @@ public:
     }
 
     [[nodiscard]] static Instruction decode(std::span<std::byte const> const buffer) {
+        if (buffer.empty()) {
+            throw std::runtime_error{ "Insufficient buffer size." };
+        }
         auto const opcode = magic_enum::enum_cast<Opcode>(std::to_integer<std::underlying_type_t<Opcode>>(buffer[0]));
         if (not opcode.has_value()) {
             throw std::runtime_error{ fmt::format("Invalid opcode: 0x{:x}", std::to_integer<int>(buffer[0])) };
@@ -119,8 +200,6 @@ public:
     }
 };
 
-[[nodiscard]] std::vector<Instruction> decode(std::span<std::byte const> memory);
-
 [[nodiscard]] inline auto format_as(Instruction const& instruction) {
     return fmt::format(
         "0x{:02x} - {}{}",
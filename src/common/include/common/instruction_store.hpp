@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <common/common.hpp>
+#include <common/pointer.hpp>
+#include <common/register.hpp>
+#include <cstddef>
+#include <iterator>
+#include <lib2k/types.hpp>
+#include <magic_enum.hpp>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "instruction.hpp"
+#include "opcode.hpp"
+
+// A sequence of decoded instructions stored as a structure of arrays: one dense array of opcodes and parallel
+// arrays of the operands, which takes 6 bytes per instruction instead of the 12 of an Instruction. Scanning
+// for opcodes only touches one byte per instruction. Byte offsets are not stored per instruction but summed up
+// from the opcodes, starting at a checkpoint that is kept every `checkpoint_interval` instructions.
+//
+// visit() hands the instruction at an index to a visitor as its concrete type, like std::visit does for an
+// Instruction, without materialising the variant.
+class InstructionStore final {
+public:
+    static constexpr auto checkpoint_interval = usize{ 64 };
+
+    class Iterator;
+
+private:
+    std::vector<Opcode> m_opcodes;
+    std::vector<Word> m_immediates;     // Zero for instructions without an immediate.
+    std::vector<Register> m_registers;  // The register or the pointer's register, A for instructions without one.
+    std::vector<Word> m_checkpoints;    // Byte offset of every `checkpoint_interval`th instruction.
+    usize m_byte_length = 0;
+
+    static constexpr auto byte_lengths = []<typename... Instructions>(std::variant<Instructions...> const*) {
+        auto result = std::array<u8, magic_enum::enum_count<Opcode>()>{};
+        ((result[std::to_underlying(Instructions::opcode)] = static_cast<u8>(Instructions::byte_length)), ...);
+        return result;
+    }(static_cast<InstructionBase const*>(nullptr));
+
+    template<typename T>
+    struct Dispatcher;
+
+    template<typename First, typename... Others>
+    struct Dispatcher<std::variant<First, Others...>> {
+        template<typename Visitor>
+        static decltype(auto) visit(InstructionStore const& store, usize const index, Visitor&& visitor) {
+            // Only valid opcodes are ever stored, so the last alternative needs no check.
+            if constexpr (sizeof...(Others) == 0) {
+                return std::forward<Visitor>(visitor)(store.get<First>(index));
+            } else {
+                if (store.m_opcodes[index] == First::opcode) {
+                    return std::forward<Visitor>(visitor)(store.get<First>(index));
+                }
+                return Dispatcher<std::variant<Others...>>::visit(store, index, std::forward<Visitor>(visitor));
+            }
+        }
+    };
+
+public:
+    [[nodiscard]] InstructionStore() = default;
+
+    [[nodiscard]] explicit InstructionStore(std::span<::Instruction const> instructions);
+
+    // Throws like Instruction::decode() if the bytes do not consist of whole, valid instructions.
+    [[nodiscard]] static InstructionStore decode(std::span<std::byte const> bytes);
+
+    void reserve(usize num_instructions);
+
+    void push_back(::Instruction const& instruction);
+
+    // Throws std::logic_error if the instruction has no immediate operand.
+    void set_immediate(usize index, Word value);
+
+    [[nodiscard]] usize size() const {
+        return m_opcodes.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return m_opcodes.empty();
+    }
+
+    // Of all instructions together.
+    [[nodiscard]] usize byte_length() const {
+        return m_byte_length;
+    }
+
+    [[nodiscard]] std::span<Opcode const> opcodes() const {
+        return m_opcodes;
+    }
+
+    [[nodiscard]] Opcode opcode(usize const index) const {
+        return m_opcodes.at(index);
+    }
+
+    [[nodiscard]] usize byte_length(usize const index) const {
+        return byte_length_of(m_opcodes.at(index));
+    }
+
+    [[nodiscard]] static constexpr usize byte_length_of(Opcode const opcode) {
+        return byte_lengths[std::to_underlying(opcode)];
+    }
+
+    // Relative to the first instruction. Sums up at most `checkpoint_interval - 1` byte lengths.
+    [[nodiscard]] usize byte_offset(usize index) const;
+
+    // Number of instructions with this opcode.
+    [[nodiscard]] usize count(Opcode const opcode) const {
+        return static_cast<usize>(std::ranges::count(m_opcodes, opcode));
+    }
+
+    [[nodiscard]] ::Instruction operator[](usize index) const;
+
+    // Calls the visitor with the instruction at `index` as its concrete type, e.g. MoveImmediateIntoRegister.
+    template<typename Visitor>
+    decltype(auto) visit(usize const index, Visitor&& visitor) const {
+        if (index >= size()) {
+            throw std::out_of_range{ "Instruction index out of range." };
+        }
+        return Dispatcher<InstructionBase>::visit(*this, index, std::forward<Visitor>(visitor));
+    }
+
+    [[nodiscard]] std::vector<std::byte> encode() const;
+
+    [[nodiscard]] Iterator begin() const;
+
+    [[nodiscard]] Iterator end() const;
+
+private:
+    template<typename T>
+    [[nodiscard]] T get(usize const index) const {
+        if constexpr (requires(T const& instruction) { instruction.register_; }) {
+            return T{ m_immediates[index], m_registers[index] };
+        } else if constexpr (requires(T const& instruction) { instruction.pointer; }) {
+            return T{ m_immediates[index], Pointer{ m_registers[index] } };
+        } else {
+            return T{};
+        }
+    }
+};
+
+// Yields every instruction as an Instruction and keeps track of its byte offset along the way.
+class InstructionStore::Iterator final {
+private:
+    InstructionStore const* m_store = nullptr;
+    usize m_index = 0;
+    usize m_byte_offset = 0;
+
+public:
+    using iterator_concept = std::forward_iterator_tag;
+    using value_type = ::Instruction;
+    using difference_type = std::ptrdiff_t;
+
+    [[nodiscard]] Iterator() = default;
+
+    [[nodiscard]] Iterator(InstructionStore const& store, usize const index, usize const byte_offset)
+        : m_store{ &store }, m_index{ index }, m_byte_offset{ byte_offset } {}
+
+    [[nodiscard]] ::Instruction operator*() const {
+        return (*m_store)[m_index];
+    }
+
+    Iterator& operator++() {
+        m_byte_offset += m_store->byte_length(m_index);
+        ++m_index;
+        return *this;
+    }
+
+    Iterator operator++(int) {
+        auto const result = *this;
+        ++*this;
+        return result;
+    }
+
+    [[nodiscard]] usize index() const {
+        return m_index;
+    }
+
+    [[nodiscard]] usize byte_offset() const {
+        return m_byte_offset;
+    }
+
+    [[nodiscard]] friend bool operator==(Iterator const& lhs, Iterator const& rhs) {
+        return lhs.m_index == rhs.m_index;
+    }
+};
+
+inline ::Instruction InstructionStore::operator[](usize const index) const {
+    return visit(index, [](auto const& instruction) { return ::Instruction{ instruction }; });
+}
+
+inline InstructionStore::Iterator InstructionStore::begin() const {
+    return Iterator{ *this, 0, 0 };
+}
+
+inline InstructionStore::Iterator InstructionStore::end() const {
+    return Iterator{ *this, size(), m_byte_length };
+}
+
+// Decodes a whole program.
+[[nodiscard]] InstructionStore decode(std::span<std::byte const> memory);
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <lib2k/types.hpp>
+#include <span>
+#include <tl/optional.hpp>
+#include <vector>
+
+// A read-only view of a whole file. The file is memory mapped where the platform supports it and
+// read into memory otherwise.
+class MappedFile final {
+private:
+    void* m_mapping = nullptr;
+    usize m_size = 0;
+    std::vector<std::byte> m_contents;  // Only used if the file could not be mapped.
+
+    MappedFile() = default;
+
+public:
+    [[nodiscard]] static tl::optional<MappedFile> open(std::filesystem::path const& path);
+
+    MappedFile(MappedFile const& other) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile const& other) = delete;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    [[nodiscard]] std::span<std::byte const> bytes() const {
+        if (m_mapping != nullptr) {
+            return std::span{ static_cast<std::byte const*>(m_mapping), m_size };
+        }
+        return m_contents;
+    }
+
+    [[nodiscard]] bool is_mapped() const {
+        return m_mapping != nullptr;
+    }
+};
+
+// Writes the file under a unique temporary name first and then renames it, so that concurrent readers, also in
+// other processes, never see a partial file and a failed write keeps the previous contents. Returns whether
+// the file was written.
+[[nodiscard]] bool write_file_atomically(std::filesystem::path const& path, std::span<std::byte const> contents);
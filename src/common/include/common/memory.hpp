@@ -0,0 +1,77 @@
+#pragma once
+
+#include <bit>
+#include <common/common.hpp>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <lib2k/types.hpp>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+// Loads and stores of little-endian integers in byte buffers, shared by the instruction encoding and the
+// emulated memory. Addresses need not be aligned. Outside of constant evaluation, every access is a single
+// memcpy, which compilers turn into one load or store on targets with unaligned access, followed by a byte
+// swap on big-endian hosts only.
+
+template<typename T>
+concept MemoryValue = std::integral<T> and not std::same_as<T, bool>
+                      and (sizeof(T) == 1 or sizeof(T) == 2 or sizeof(T) == 4 or sizeof(T) == 8);
+
+// Unchecked: `bytes` must point to at least sizeof(T) bytes.
+template<MemoryValue T>
+[[nodiscard]] constexpr T load_little_endian(std::byte const* const bytes) {
+    if consteval {
+        using Unsigned = std::make_unsigned_t<T>;
+        auto result = Unsigned{ 0 };
+        for (auto i = usize{ 0 }; i < sizeof(T); ++i) {
+            result |= static_cast<Unsigned>(static_cast<Unsigned>(bytes[i]) << (8 * i));
+        }
+        return static_cast<T>(result);
+    } else {
+        auto value = T{};
+        std::memcpy(&value, bytes, sizeof(value));
+        return from_little_endian(value);
+    }
+}
+
+// Unchecked: `bytes` must point to at least sizeof(T) bytes.
+template<MemoryValue T>
+constexpr void store_little_endian(std::byte* const bytes, T const value) {
+    if consteval {
+        using Unsigned = std::make_unsigned_t<T>;
+        for (auto i = usize{ 0 }; i < sizeof(T); ++i) {
+            bytes[i] = static_cast<std::byte>(static_cast<Unsigned>(value) >> (8 * i));
+        }
+    } else {
+        auto const little_endian = to_little_endian(value);
+        std::memcpy(bytes, &little_endian, sizeof(little_endian));
+    }
+}
+
+[[nodiscard]] constexpr bool is_in_bounds(
+    std::span<std::byte const> const memory,
+    usize const offset,
+    usize const size
+) {
+    return offset <= memory.size() and memory.size() - offset >= size;
+}
+
+// Throws std::out_of_range unless the value lies completely within `memory`.
+template<MemoryValue T>
+[[nodiscard]] constexpr T load_little_endian(std::span<std::byte const> const memory, usize const offset = 0) {
+    if (not is_in_bounds(memory, offset, sizeof(T))) {
+        throw std::out_of_range{ "Memory access out of bounds." };
+    }
+    return load_little_endian<T>(memory.data() + offset);
+}
+
+// Throws std::out_of_range unless the value lies completely within `memory`.
+template<MemoryValue T>
+constexpr void store_little_endian(std::span<std::byte> const memory, usize const offset, T const value) {
+    if (not is_in_bounds(memory, offset, sizeof(T))) {
+        throw std::out_of_range{ "Memory access out of bounds." };
+    }
+    store_little_endian(memory.data() + offset, value);
+}
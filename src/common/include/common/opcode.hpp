@@ -6,4 +6,6 @@ enum class Opcode : u8 {
     HaltAndCatchFire,
     MoveImmediateIntoRegister,
     MoveImmediateIntoMemory,
+    AtomicAddImmediateToMemory,
+    Fence,
 };
@@ -8,10 +8,10 @@ private:
     Register m_register;
 
 public:
-    [[nodiscard]] explicit Pointer(Register const register_)
+    [[nodiscard]] constexpr explicit Pointer(Register const register_)
         : m_register{ register_ } {}
 
-    [[nodiscard]] Register register_() const {
+    [[nodiscard]] constexpr Register register_() const {
         return m_register;
     }
 
@@ -20,7 +20,7 @@ public:
     }
 };
 
-[[nodiscard]] inline Pointer operator*(Register const register_) {
+[[nodiscard]] constexpr Pointer operator*(Register const register_) {
     return Pointer{ register_ };
 }
 
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <fmt/format.h>
+#include <common/common.hpp>
+#include <cstddef>
+#include <lib2k/types.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tl/optional.hpp>
+#include <vector>
+
+// Maps instruction addresses back to the source lines the instructions were assembled from. Entries are
+// sorted by address and grouped into blocks. The first entry of every block is stored in full, the others
+// as variable-length deltas to their predecessor, which takes three to four bytes per instruction. Lookups are
+// a binary search over the blocks followed by decoding at most one block.
+class SourceMap final {
+public:
+    struct Location final {
+        std::string_view filename;
+        u32 line;    // 1-based.
+        u32 column;  // 1-based.
+
+        [[nodiscard]] friend std::string format_as(Location const& location) {
+            return fmt::format("{}:{}:{}", location.filename, location.line, location.column);
+        }
+    };
+
+    class Builder;
+
+private:
+    struct Entry final {
+        Word address;
+        u32 file;
+        u32 line;
+        u32 column;
+    };
+
+    struct Block final {
+        Entry first;
+        u32 deltas_offset;  // Where the deltas of the other entries of the block start.
+    };
+
+    static constexpr auto block_size = usize{ 32 };
+
+    std::vector<std::string> m_filenames;
+    std::vector<Block> m_blocks;
+    std::vector<u8> m_deltas;
+    usize m_num_entries = 0;
+    Word m_end = 0;  // One past the last byte of the last instruction.
+
+public:
+    [[nodiscard]] SourceMap() = default;
+
+    // Location of the instruction that contains the byte at `address`.
+    [[nodiscard]] tl::optional<Location> find(Word address) const;
+
+    // Like calling find() for every address, but in a single sweep over the map. Meant for symbolising
+    // large numbers of samples, which do not need to be sorted.
+    [[nodiscard]] std::vector<tl::optional<Location>> find_all(std::span<Word const> addresses) const;
+
+    [[nodiscard]] usize size() const {
+        return m_num_entries;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return m_num_entries == 0;
+    }
+
+    [[nodiscard]] std::vector<std::byte> serialize() const;
+
+    // Returns nothing if `bytes` is not a serialized source map.
+    [[nodiscard]] static tl::optional<SourceMap> deserialize(std::span<std::byte const> bytes);
+
+private:
+    // Decodes the entry following `entry` from the deltas at `offset`, advancing `offset`. Returns false if
+    // the deltas are malformed.
+    [[nodiscard]] bool decode_next(Entry& entry, usize& offset) const;
+
+    [[nodiscard]] usize num_entries_in_block(usize block) const;
+
+    [[nodiscard]] Location location_of(Entry const& entry) const;
+};
+
+class SourceMap::Builder final {
+private:
+    SourceMap m_source_map;
+    tl::optional<Entry> m_previous;
+
+public:
+    // Addresses must be strictly increasing.
+    void add(Word address, std::string_view filename, u32 line, u32 column);
+
+    // `end` is one past the last byte of the last instruction.
+    [[nodiscard]] SourceMap build(Word end) &&;
+
+private:
+    [[nodiscard]] u32 file_index(std::string_view filename);
+};
@@ -1,50 +1,23 @@
 #include <common/instruction.hpp>
 
 #include <algorithm>
-#include <concepts>
+#include <common/memory.hpp>
 #include <magic_enum.hpp>
 #include <utility>
 
-void write_into(Opcode const opcode, std::span<std::byte> const buffer) {
-    buffer[0] = static_cast<std::byte>(std::to_underlying(opcode));
-}
-
-void write_into(Register const register_, std::span<std::byte> const buffer) {
-    buffer[0] = static_cast<std::byte>(std::to_underlying(register_));
-}
-
-void write_into(Pointer const pointer, std::span<std::byte> const buffer) {
-    write_into(pointer.register_(), buffer);
-}
-
-void write_into(std::integral auto value, std::span<std::byte> const buffer) {
-    if (buffer.size() < sizeof(value)) {
-        throw std::runtime_error{ "Insufficient buffer size." };
+namespace {
+    // Decoders check the length once, after that all fields are read unchecked.
+    template<typename T>
+    void check_length(std::span<std::byte const> const buffer) {
+        if (buffer.size() < T::byte_length) {
+            throw std::runtime_error{ "Insufficient buffer size." };
+        }
     }
 
-    value = to_little_endian(value);
-    auto const begin = reinterpret_cast<std::byte const*>(&value);
-    auto const end = begin + sizeof(value);
-    std::copy(begin, end, buffer.begin());
-}
-
-template<typename T>
-[[nodiscard]] T read_from(std::span<std::byte const> const buffer)
-    requires(std::integral<T> or std::same_as<T, Register>)
-{
-    if (buffer.size() < sizeof(T)) {
-        throw std::runtime_error{ "Insufficient buffer size." };
+    [[nodiscard]] Register read_register(std::byte const* const bytes) {
+        return magic_enum::enum_cast<Register>(load_little_endian<std::underlying_type_t<Register>>(bytes)).value();
     }
-    auto value = T{};
-    auto const begin = reinterpret_cast<std::byte*>(&value);
-    std::copy_n(buffer.begin(), sizeof(T), begin);
-    return value;
-}
-
-template<>
-[[nodiscard]] Register read_from<Register>(std::span<std::byte const> const buffer) {
-    return magic_enum::enum_cast<Register>(std::to_integer<std::underlying_type_t<Register>>(buffer[0])).value();
-}
+}  // namespace
 
 /*[[nodiscard]] std::unique_ptr<Instruction> Instruction::decode(std::span<std::byte const> memory) {
     if (memory.empty()) {
@@ -63,10 +36,6 @@ template<>
     throw std::runtime_error{ "Unreachable." };
 }*/
 
-void HaltAndCatchFire::encode_into(std::span<std::byte> const buffer) const {
-    write_into(opcode, buffer);
-}
-
 [[nodiscard]] Instruction HaltAndCatchFire::decode(std::span<std::byte const> const buffer) {
     assert(std::to_integer<std::underlying_type_t<Opcode>>(buffer[0]) == std::to_underlying(opcode));
     return HaltAndCatchFire{};
@@ -74,37 +43,29 @@ void HaltAndCatchFire::encode_into(std::span<std::byte> const buffer) const {
 
 [[nodiscard]] Instruction MoveImmediateIntoRegister::decode(std::span<std::byte const> const buffer) {
     assert(std::to_integer<std::underlying_type_t<Opcode>>(buffer[0]) == std::to_underlying(opcode));
-    auto const immediate = read_from<Word>(buffer.subspan(1));
-    auto const register_ = read_from<Register>(buffer.subspan(1 + sizeof(immediate)));
+    check_length<MoveImmediateIntoRegister>(buffer);
+    auto const immediate = load_little_endian<Word>(buffer.data() + 1);
+    auto const register_ = read_register(buffer.data() + 1 + sizeof(immediate));
     return MoveImmediateIntoRegister{ immediate, register_ };
 }
 
-void MoveImmediateIntoMemory::encode_into(std::span<std::byte> const buffer) const {
-    write_into(opcode, buffer.subspan(0));
-    write_into(immediate, buffer.subspan(1));
-    write_into(pointer, buffer.subspan(1 + sizeof(immediate)));
-}
-
 [[nodiscard]] Instruction MoveImmediateIntoMemory::decode(std::span<std::byte const> buffer) {
     assert(std::to_integer<std::underlying_type_t<Opcode>>(buffer[0]) == std::to_underlying(opcode));
-    auto const immediate = read_from<Word>(buffer.subspan(1));
-    auto const register_ = read_from<Register>(buffer.subspan(1 + sizeof(immediate)));
+    check_length<MoveImmediateIntoMemory>(buffer);
+    auto const immediate = load_little_endian<Word>(buffer.data() + 1);
+    auto const register_ = read_register(buffer.data() + 1 + sizeof(immediate));
     return MoveImmediateIntoMemory{ immediate, *register_ };
 }
 
-void MoveImmediateIntoRegister::encode_into(std::span<std::byte> const buffer) const {
-    write_into(opcode, buffer.subspan(0));
-    write_into(immediate, buffer.subspan(1));
-    write_into(register_, buffer.subspan(1 + sizeof(immediate)));
+[[nodiscard]] Instruction AtomicAddImmediateToMemory::decode(std::span<std::byte const> buffer) {
+    assert(std::to_integer<std::underlying_type_t<Opcode>>(buffer[0]) == std::to_underlying(opcode));
+    check_length<AtomicAddImmediateToMemory>(buffer);
+    auto const immediate = load_little_endian<Word>(buffer.data() + 1);
+    auto const register_ = read_register(buffer.data() + 1 + sizeof(immediate));
+    return AtomicAddImmediateToMemory{ immediate, *register_ };
 }
 
-[[nodiscard]] std::vector<Instruction> decode(std::span<std::byte const> const memory) {
-    auto instructions = std::vector<Instruction>{};
-    auto subspan = memory.subspan(0);
-    while (not subspan.empty()) {
-        auto instruction = Instruction::decode(subspan);
-        subspan = subspan.subspan(instruction.byte_length());
-        instructions.push_back(instruction);
-    }
-    return instructions;
+[[nodiscard]] Instruction Fence::decode(std::span<std::byte const> const buffer) {
+    assert(std::to_integer<std::underlying_type_t<Opcode>>(buffer[0]) == std::to_underlying(opcode));
+    return Fence{};
 }
@@ -0,0 +1,92 @@
+#include <common/instruction_store.hpp>
+
+[[nodiscard]] InstructionStore::InstructionStore(std::span<::Instruction const> const instructions) {
+    reserve(instructions.size());
+    for (auto const& instruction : instructions) {
+        push_back(instruction);
+    }
+}
+
+[[nodiscard]] InstructionStore InstructionStore::decode(std::span<std::byte const> const bytes) {
+    auto result = InstructionStore{};
+    auto remaining = bytes;
+    while (not remaining.empty()) {
+        auto const instruction = ::Instruction::decode(remaining);
+        remaining = remaining.subspan(instruction.byte_length());
+        result.push_back(instruction);
+    }
+    return result;
+}
+
+void InstructionStore::reserve(usize const num_instructions) {
+    m_opcodes.reserve(num_instructions);
+    m_immediates.reserve(num_instructions);
+    m_registers.reserve(num_instructions);
+    m_checkpoints.reserve((num_instructions + checkpoint_interval - 1) / checkpoint_interval);
+}
+
+void InstructionStore::push_back(::Instruction const& instruction) {
+    if (m_opcodes.size() % checkpoint_interval == 0) {
+        m_checkpoints.push_back(static_cast<Word>(m_byte_length));
+    }
+    auto immediate = Word{ 0 };
+    auto register_ = Register::A;
+    std::visit(
+        [&](auto const& inst) {
+            if constexpr (requires { inst.immediate; }) {
+                immediate = inst.immediate;
+            }
+            if constexpr (requires { inst.register_; }) {
+                register_ = inst.register_;
+            } else if constexpr (requires { inst.pointer; }) {
+                register_ = inst.pointer.register_();
+            }
+        },
+        instruction
+    );
+    m_opcodes.push_back(instruction.opcode());
+    m_immediates.push_back(immediate);
+    m_registers.push_back(register_);
+    m_byte_length += instruction.byte_length();
+}
+
+void InstructionStore::set_immediate(usize const index, Word const value) {
+    auto const has_immediate = visit(index, [](auto const& instruction) {
+        return requires { instruction.immediate; };
+    });
+    if (not has_immediate) {
+        throw std::logic_error{ "Instruction has no immediate operand." };
+    }
+    m_immediates.at(index) = value;
+}
+
+[[nodiscard]] usize InstructionStore::byte_offset(usize const index) const {
+    if (index > size()) {
+        throw std::out_of_range{ "Instruction index out of range." };
+    }
+    if (index == size()) {
+        return m_byte_length;
+    }
+    auto const checkpoint = index / checkpoint_interval;
+    auto result = usize{ m_checkpoints[checkpoint] };
+    for (auto i = checkpoint * checkpoint_interval; i < index; ++i) {
+        result += byte_length_of(m_opcodes[i]);
+    }
+    return result;
+}
+
+[[nodiscard]] std::vector<std::byte> InstructionStore::encode() const {
+    auto result = std::vector<std::byte>(m_byte_length);
+    auto offset = usize{ 0 };
+    for (auto i = usize{ 0 }; i < size(); ++i) {
+        offset += visit(i, [&](auto const& instruction) {
+            instruction.encode_into(std::span{ result }.subspan(offset));
+            return instruction.byte_length;
+        });
+    }
+    return result;
+}
+
+[[nodiscard]] InstructionStore decode(std::span<std::byte const> const memory) {
+    return InstructionStore::decode(memory);
+}
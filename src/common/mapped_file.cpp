@@ -0,0 +1,114 @@
+#include <fmt/format.h>
+#include <common/mapped_file.hpp>
+#include <fstream>
+#include <random>
+#include <system_error>
+#include <utility>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define IUBS2K_HAS_MMAP 1
+#else
+#define IUBS2K_HAS_MMAP 0
+#endif
+
+namespace {
+    [[nodiscard]] tl::optional<std::vector<std::byte>> read_file(std::filesystem::path const& path) {
+        auto file = std::ifstream{ path, std::ios::binary | std::ios::ate };
+        if (not file) {
+            return tl::nullopt;
+        }
+        auto const size = static_cast<std::streamsize>(file.tellg());
+        auto contents = std::vector<std::byte>(static_cast<usize>(size));
+        file.seekg(0);
+        if (not file.read(reinterpret_cast<char*>(contents.data()), size)) {
+            return tl::nullopt;
+        }
+        return contents;
+    }
+
+    // The process ID keeps processes apart, the random part keeps threads and earlier attempts apart.
+    [[nodiscard]] std::string unique_suffix() {
+        thread_local auto random = std::mt19937_64{ std::random_device{}() };
+#if IUBS2K_HAS_MMAP
+        return fmt::format(".{}.{:016x}.tmp", ::getpid(), random());
+#else
+        return fmt::format(".{:016x}.tmp", random());
+#endif
+    }
+}  // namespace
+
+[[nodiscard]] tl::optional<MappedFile> MappedFile::open(std::filesystem::path const& path) {
+    auto result = MappedFile{};
+#if IUBS2K_HAS_MMAP
+    auto const descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor == -1) {
+        return tl::nullopt;
+    }
+    struct stat status {};
+    if (::fstat(descriptor, &status) == 0 and status.st_size > 0) {
+        auto const size = static_cast<usize>(status.st_size);
+        auto const mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapping != MAP_FAILED) {
+            result.m_mapping = mapping;
+            result.m_size = size;
+        }
+    }
+    ::close(descriptor);  // The mapping stays valid after closing the descriptor.
+    if (result.is_mapped()) {
+        return result;
+    }
+#endif
+    auto contents = read_file(path);
+    if (not contents.has_value()) {
+        return tl::nullopt;
+    }
+    result.m_contents = std::move(contents).value();
+    return result;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_mapping{ std::exchange(other.m_mapping, nullptr) },
+      m_size{ std::exchange(other.m_size, 0) },
+      m_contents{ std::move(other.m_contents) } {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        std::swap(m_mapping, other.m_mapping);
+        std::swap(m_size, other.m_size);
+        std::swap(m_contents, other.m_contents);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+#if IUBS2K_HAS_MMAP
+    if (m_mapping != nullptr) {
+        ::munmap(m_mapping, m_size);
+    }
+#endif
+}
+
+[[nodiscard]] bool write_file_atomically(std::filesystem::path const& path, std::span<std::byte const> const contents) {
+    auto temporary_path = path;
+    temporary_path += unique_suffix();
+    auto error = std::error_code{};
+    {
+        auto file = std::ofstream{ temporary_path, std::ios::binary | std::ios::trunc };
+        file.write(reinterpret_cast<char const*>(contents.data()), static_cast<std::streamsize>(contents.size()));
+        if (not file.flush()) {
+            file.close();
+            std::filesystem::remove(temporary_path, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary_path, path, error);
+    if (error) {
+        std::filesystem::remove(temporary_path, error);
+        return false;
+    }
+    return true;
+}
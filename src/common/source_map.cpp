@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <cassert>
+#include <common/byte_stream.hpp>
+#include <common/source_map.hpp>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    // Deltas are LEB128 varints. Signed values are zigzag encoded first, so that small magnitudes stay small.
+    void write_varint(std::vector<u8>& output, u64 value) {
+        while (value >= 0x80) {
+            output.push_back(static_cast<u8>(value | 0x80));
+            value >>= 7;
+        }
+        output.push_back(static_cast<u8>(value));
+    }
+
+    [[nodiscard]] bool read_varint(std::span<u8 const> const input, usize& offset, u64& value) {
+        value = 0;
+        for (auto shift = 0; shift < 64; shift += 7) {
+            if (offset >= input.size()) {
+                return false;
+            }
+            auto const byte = input[offset++];
+            value |= u64{ byte & 0x7Fu } << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] u64 zigzag(i64 const value) {
+        return (static_cast<u64>(value) << 1) ^ static_cast<u64>(value >> 63);
+    }
+
+    [[nodiscard]] i64 unzigzag(u64 const value) {
+        return static_cast<i64>(value >> 1) ^ -static_cast<i64>(value & 1);
+    }
+}  // namespace
+
+[[nodiscard]] tl::optional<SourceMap::Location> SourceMap::find(Word const address) const {
+    if (m_blocks.empty() or address < m_blocks.front().first.address or address >= m_end) {
+        return tl::nullopt;
+    }
+    auto const block = static_cast<usize>(
+        std::ranges::upper_bound(m_blocks, address, {}, [](Block const& b) { return b.first.address; })
+        - m_blocks.begin() - 1
+    );
+    auto entry = m_blocks[block].first;
+    auto offset = usize{ m_blocks[block].deltas_offset };
+    for (auto i = usize{ 1 }; i < num_entries_in_block(block); ++i) {
+        auto next = entry;
+        [[maybe_unused]] auto const decoded = decode_next(next, offset);
+        assert(decoded);
+        if (next.address > address) {
+            break;
+        }
+        entry = next;
+    }
+    return location_of(entry);
+}
+
+[[nodiscard]] std::vector<tl::optional<SourceMap::Location>> SourceMap::find_all(
+    std::span<Word const> const addresses
+) const {
+    auto result = std::vector<tl::optional<Location>>(addresses.size());
+    if (m_blocks.empty()) {
+        return result;
+    }
+
+    auto sorted = std::vector<std::pair<Word, u32>>{};  // Address and index into `addresses`.
+    sorted.reserve(addresses.size());
+    for (auto i = usize{ 0 }; i < addresses.size(); ++i) {
+        sorted.emplace_back(addresses[i], static_cast<u32>(i));
+    }
+    std::ranges::sort(sorted);
+
+    // The entry at or before the current address, never decoded twice. Jumps over blocks without samples.
+    static constexpr auto no_block = std::numeric_limits<usize>::max();
+    auto block = no_block;
+    auto entry = Entry{};
+    auto offset = usize{ 0 };
+    auto index_in_block = usize{ 0 };
+    for (auto const& [address, index] : sorted) {
+        if (address < m_blocks.front().first.address) {
+            continue;
+        }
+        if (address >= m_end) {
+            break;
+        }
+        if (block == no_block or (block + 1 < m_blocks.size() and address >= m_blocks[block + 1].first.address)) {
+            auto const search_from = m_blocks.begin() + static_cast<std::ptrdiff_t>(block == no_block ? 0 : block);
+            auto const found = std::upper_bound(search_from, m_blocks.end(), address, [](Word const a, Block const& b) {
+                return a < b.first.address;
+            });
+            block = static_cast<usize>(found - m_blocks.begin() - 1);
+            entry = m_blocks[block].first;
+            offset = m_blocks[block].deltas_offset;
+            index_in_block = 0;
+        }
+        while (index_in_block + 1 < num_entries_in_block(block)) {
+            auto next = entry;
+            auto next_offset = offset;
+            [[maybe_unused]] auto const decoded = decode_next(next, next_offset);
+            assert(decoded);
+            if (next.address > address) {
+                break;
+            }
+            entry = next;
+            offset = next_offset;
+            ++index_in_block;
+        }
+        result[index] = location_of(entry);
+    }
+    return result;
+}
+
+[[nodiscard]] std::vector<std::byte> SourceMap::serialize() const {
+    // All integers are little endian u32: number of files, then per file the length of its name and the
+    // name, then number of entries, end address and per block its first entry and deltas offset, then
+    // the number of delta bytes and the deltas.
+    auto writer = ByteWriter{};
+    writer.write(static_cast<u32>(m_filenames.size()));
+    for (auto const& filename : m_filenames) {
+        writer.write(static_cast<u32>(filename.length()));
+        writer.write(std::as_bytes(std::span{ filename }));
+    }
+    writer.write(static_cast<u32>(m_num_entries));
+    writer.write(m_end);
+    for (auto const& block : m_blocks) {
+        writer.write(block.first.address);
+        writer.write(block.first.file);
+        writer.write(block.first.line);
+        writer.write(block.first.column);
+        writer.write(block.deltas_offset);
+    }
+    writer.write(static_cast<u32>(m_deltas.size()));
+    writer.write(std::as_bytes(std::span{ m_deltas }));
+    return std::move(writer).take();
+}
+
+[[nodiscard]] tl::optional<SourceMap> SourceMap::deserialize(std::span<std::byte const> const bytes) {
+    auto reader = ByteReader{ bytes };
+    auto result = SourceMap{};
+
+    auto const num_files = reader.read<u32>();
+    if (not num_files.has_value()) {
+        return tl::nullopt;
+    }
+    for (auto i = u32{ 0 }; i < num_files.value(); ++i) {
+        auto const length = reader.read<u32>();
+        if (not length.has_value()) {
+            return tl::nullopt;
+        }
+        auto const name = reader.read(length.value());
+        if (not name.has_value()) {
+            return tl::nullopt;
+        }
+        result.m_filenames.emplace_back(reinterpret_cast<char const*>(name->data()), name->size());
+    }
+
+    auto const num_entries = reader.read<u32>();
+    auto const end = reader.read<u32>();
+    if (not end.has_value()) {
+        return tl::nullopt;
+    }
+    result.m_num_entries = num_entries.value();
+    result.m_end = end.value();
+    auto const num_blocks = (result.m_num_entries + block_size - 1) / block_size;
+    for (auto i = usize{ 0 }; i < num_blocks; ++i) {
+        auto const address = reader.read<u32>();
+        auto const file = reader.read<u32>();
+        auto const line = reader.read<u32>();
+        auto const column = reader.read<u32>();
+        auto const deltas_offset = reader.read<u32>();
+        if (not deltas_offset.has_value() or file.value() >= result.m_filenames.size()) {
+            return tl::nullopt;
+        }
+        result.m_blocks.push_back(Block{
+            Entry{ address.value(), file.value(), line.value(), column.value() },
+            deltas_offset.value(),
+        });
+    }
+    auto const num_deltas = reader.read<u32>();
+    if (not num_deltas.has_value()) {
+        return tl::nullopt;
+    }
+    auto const deltas = reader.read(num_deltas.value());
+    if (not deltas.has_value() or not reader.is_at_end()) {
+        return tl::nullopt;
+    }
+    auto const delta_bytes = std::span{ reinterpret_cast<u8 const*>(deltas->data()), deltas->size() };
+    result.m_deltas.assign(delta_bytes.begin(), delta_bytes.end());
+
+    // Decode everything once, so that lookups can rely on well-formed, strictly increasing entries.
+    auto previous_address = tl::optional<Word>{};
+    for (auto block = usize{ 0 }; block < num_blocks; ++block) {
+        auto entry = result.m_blocks[block].first;
+        auto offset = usize{ result.m_blocks[block].deltas_offset };
+        if (previous_address.has_value() and entry.address <= previous_address.value()) {
+            return tl::nullopt;
+        }
+        for (auto i = usize{ 1 }; i < result.num_entries_in_block(block); ++i) {
+            if (not result.decode_next(entry, offset)) {
+                return tl::nullopt;
+            }
+        }
+        auto const expected_offset = block + 1 < num_blocks ? usize{ result.m_blocks[block + 1].deltas_offset }
+                                                            : result.m_deltas.size();
+        if (offset != expected_offset) {
+            return tl::nullopt;
+        }
+        previous_address = entry.address;
+    }
+    if (previous_address.has_value() and result.m_end <= previous_address.value()) {
+        return tl::nullopt;
+    }
+    return result;
+}
+
+[[nodiscard]] bool SourceMap::decode_next(Entry& entry, usize& offset) const {
+    // Address delta shifted left by one, with the lowest bit telling whether the file changes.
+    auto head = u64{};
+    if (not read_varint(m_deltas, offset, head)) {
+        return false;
+    }
+    auto const address_delta = head >> 1;
+    if (address_delta == 0 or address_delta > u64{ std::numeric_limits<Word>::max() - entry.address }) {
+        return false;
+    }
+    entry.address += static_cast<Word>(address_delta);
+    if ((head & 1) != 0) {
+        auto file = u64{};
+        if (not read_varint(m_deltas, offset, file) or file >= m_filenames.size()) {
+            return false;
+        }
+        entry.file = static_cast<u32>(file);
+    }
+    auto line_delta = u64{};
+    auto column = u64{};
+    if (not read_varint(m_deltas, offset, line_delta) or not read_varint(m_deltas, offset, column)) {
+        return false;
+    }
+    auto const line = i64{ entry.line } + unzigzag(line_delta);
+    if (line < 0 or line > i64{ std::numeric_limits<u32>::max() } or column > std::numeric_limits<u32>::max()) {
+        return false;
+    }
+    entry.line = static_cast<u32>(line);
+    entry.column = static_cast<u32>(column);
+    return true;
+}
+
+[[nodiscard]] usize SourceMap::num_entries_in_block(usize const block) const {
+    return std::min(block_size, m_num_entries - block * block_size);
+}
+
+[[nodiscard]] SourceMap::Location SourceMap::location_of(Entry const& entry) const {
+    return Location{ m_filenames[entry.file], entry.line, entry.column };
+}
+
+void SourceMap::Builder::add(Word const address, std::string_view const filename, u32 const line, u32 const column) {
+    if (m_previous.has_value() and address <= m_previous->address) {
+        throw std::invalid_argument{ "Source map addresses must be strictly increasing." };
+    }
+    auto const entry = Entry{ address, file_index(filename), line, column };
+    auto& map = m_source_map;
+    if (map.m_num_entries % block_size == 0) {
+        map.m_blocks.push_back(Block{ entry, static_cast<u32>(map.m_deltas.size()) });
+    } else {
+        auto const file_changes = entry.file != m_previous->file;
+        write_varint(map.m_deltas, (u64{ address - m_previous->address } << 1) | (file_changes ? 1 : 0));
+        if (file_changes) {
+            write_varint(map.m_deltas, entry.file);
+        }
+        write_varint(map.m_deltas, zigzag(i64{ line } - i64{ m_previous->line }));
+        write_varint(map.m_deltas, column);
+    }
+    ++map.m_num_entries;
+    m_previous = entry;
+}
+
+[[nodiscard]] SourceMap SourceMap::Builder::build(Word const end) && {
+    if (m_previous.has_value() and end <= m_previous->address) {
+        throw std::invalid_argument{ "Source map must end behind its last entry." };
+    }
+    m_source_map.m_end = end;
+    return std::move(m_source_map);
+}
+
+[[nodiscard]] u32 SourceMap::Builder::file_index(std::string_view const filename) {
+    auto& filenames = m_source_map.m_filenames;
+    // Consecutive entries almost always share their file.
+    if (m_previous.has_value() and filenames[m_previous->file] == filename) {
+        return m_previous->file;
+    }
+    auto const found = std::ranges::find(filenames, filename);
+    if (found != filenames.end()) {
+        return static_cast<u32>(found - filenames.begin());
+    }
+    filenames.emplace_back(filename);
+    return static_cast<u32>(filenames.size() - 1);
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <emulator/clock.hpp>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    [[nodiscard]] u64 num_instructions_due(Clock::Duration const elapsed, u64 const frequency) {
+        using namespace std::chrono;
+        auto const nanos = duration_cast<nanoseconds>(elapsed).count();
+        if (nanos <= 0) {
+            return 0;
+        }
+        static constexpr auto nanos_per_second = u64{ 1'000'000'000 };
+        auto const whole_seconds = static_cast<u64>(nanos) / nanos_per_second;
+        auto const remaining_nanos = static_cast<u64>(nanos) % nanos_per_second;
+        return whole_seconds * frequency + remaining_nanos * frequency / nanos_per_second;
+    }
+}  // namespace
+
+[[nodiscard]] Clock::Clock(tl::optional<u64> const frequency, Duration const slice_duration, Duration const spin_threshold)
+    : m_frequency{ frequency },
+      m_slice_duration{ slice_duration },
+      m_spin_threshold{ spin_threshold },
+      m_statistics_start{ SteadyClock::now() } {
+    if (m_frequency.has_value() and m_frequency.value() == 0) {
+        throw std::invalid_argument{ "Clock frequency must not be zero." };
+    }
+    if (m_slice_duration <= Duration::zero()) {
+        throw std::invalid_argument{ "Slice duration must be positive." };
+    }
+}
+
+[[nodiscard]] Clock Clock::unthrottled(Duration const slice_duration) {
+    return Clock{ tl::nullopt, slice_duration, Duration::zero() };
+}
+
+[[nodiscard]] Clock Clock::with_frequency(
+    u64 const instructions_per_second,
+    Duration const slice_duration,
+    Duration const spin_threshold
+) {
+    return Clock{ instructions_per_second, slice_duration, spin_threshold };
+}
+
+usize Clock::run_until(Emulator& emulator, TimePoint const deadline) {
+    auto executed = usize{ 0 };
+    while (true) {
+        auto const now = SteadyClock::now();
+        if (now >= deadline) {
+            break;
+        }
+        if (emulator.is_halted()) {
+            // Nothing left to pace. Start a fresh epoch once execution resumes.
+            m_epoch = tl::nullopt;
+            std::this_thread::sleep_until(deadline);
+            break;
+        }
+        auto const slice_end = std::min(now + m_slice_duration, deadline);
+        executed += is_throttled() ? run_throttled_slice(emulator, slice_end) : run_unthrottled_slice(emulator, slice_end);
+    }
+    m_num_instructions += executed;
+    return executed;
+}
+
+[[nodiscard]] ClockStatistics Clock::statistics() const {
+    using namespace std::chrono;
+    auto const elapsed = duration<double>{ SteadyClock::now() - m_statistics_start }.count();
+    return ClockStatistics{
+        .num_instructions = m_num_instructions,
+        .num_waits = m_num_waits,
+        .instructions_per_second = elapsed > 0.0 ? static_cast<double>(m_num_instructions) / elapsed : 0.0,
+        .mean_jitter = m_num_waits == 0 ? nanoseconds::zero()
+                                        : duration_cast<nanoseconds>(m_total_jitter / static_cast<i64>(m_num_waits)),
+        .max_jitter = duration_cast<nanoseconds>(m_max_jitter),
+    };
+}
+
+void Clock::reset_statistics() {
+    m_statistics_start = SteadyClock::now();
+    m_num_instructions = 0;
+    m_num_waits = 0;
+    m_total_jitter = Duration::zero();
+    m_max_jitter = Duration::zero();
+}
+
+[[nodiscard]] usize Clock::run_throttled_slice(Emulator& emulator, TimePoint const slice_end) {
+    auto const frequency = m_frequency.value();
+    if (not m_epoch.has_value()) {
+        m_epoch = SteadyClock::now();
+        m_num_instructions_since_epoch = 0;
+    }
+
+    auto const due = num_instructions_due(slice_end - m_epoch.value(), frequency);
+    auto const max_burst = num_instructions_due(max_backlog, frequency);
+    if (due > m_num_instructions_since_epoch + max_burst) {
+        // We are too far behind to ever catch up. Forget about the lost time.
+        m_num_instructions_since_epoch = due - max_burst;
+    }
+    auto const owed = due > m_num_instructions_since_epoch ? due - m_num_instructions_since_epoch : u64{ 0 };
+
+    auto const executed = execute(emulator, static_cast<usize>(owed));
+    m_num_instructions_since_epoch += executed;
+    wait_until(slice_end);
+    return executed;
+}
+
+[[nodiscard]] usize Clock::run_unthrottled_slice(Emulator& emulator, TimePoint const slice_end) {
+    // Querying the time is not free, so it's only done once per batch.
+    static constexpr auto batch_size = usize{ 256 };
+    auto executed = usize{ 0 };
+    while (not emulator.is_halted() and SteadyClock::now() < slice_end) {
+        executed += execute(emulator, batch_size);
+    }
+    return executed;
+}
+
+[[nodiscard]] usize Clock::execute(Emulator& emulator, usize const count) {
+    if (m_profiler != nullptr) {
+        return m_profiler->run(emulator, count);
+    }
+    auto executed = usize{ 0 };
+    while (executed < count and not emulator.is_halted()) {
+        emulator.step();
+        ++executed;
+    }
+    return executed;
+}
+
+void Clock::wait_until(TimePoint const target) {
+    if (SteadyClock::now() + m_spin_threshold < target) {
+        std::this_thread::sleep_until(target - m_spin_threshold);
+    }
+    auto now = SteadyClock::now();
+    while (now < target) {
+        std::this_thread::yield();
+        now = SteadyClock::now();
+    }
+
+    auto const jitter = now - target;
+    m_total_jitter += jitter;
+    m_max_jitter = std::max(m_max_jitter, jitter);
+    ++m_num_waits;
+}
@@ -0,0 +1,119 @@
+#include <fmt/format.h>
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <common/instruction.hpp>
+#include <common/memory.hpp>
+#include <emulator/core.hpp>
+#include <lib2k/overloaded.hpp>
+#include <magic_enum.hpp>
+#include <span>
+#include <stdexcept>
+#include <variant>
+
+[[nodiscard]] Core::Core(
+    SharedMemory& memory,
+    SourceMap const& source_map,
+    Word const entry_point,
+    ControlFlowGraph const* const control_flow_graph
+)
+    : m_memory{ &memory },
+      m_source_map{ &source_map },
+      m_control_flow_graph{ control_flow_graph },
+      m_instruction_pointer{ entry_point } {
+    if (m_control_flow_graph != nullptr) {
+        auto const node = m_control_flow_graph->find(entry_point);
+        if (not node.has_value() or m_control_flow_graph->nodes()[node.value()].address != entry_point) {
+            throw std::invalid_argument{ "Entry point is not part of the control-flow graph." };
+        }
+        m_node = node.value();
+    }
+}
+
+void Core::restore(State const& state) {
+    if (m_control_flow_graph != nullptr) {
+        throw std::logic_error{ "Cores of verified programs cannot be restored." };
+    }
+    m_instruction_pointer = state.instruction_pointer;
+    m_is_halted = state.is_halted;
+    m_registers = state.registers;
+}
+
+void Core::step() {
+    if (is_halted()) {
+        throw std::runtime_error{ "Core is halted." };
+    }
+
+    try {
+        if (m_control_flow_graph != nullptr) {
+            // Verification guarantees that the instruction decodes and that nothing overwrites it.
+            auto const& instructions = m_control_flow_graph->instructions();
+            instructions.visit(m_node, [this](auto const& instruction) { execute(instruction); });
+            m_instruction_pointer += static_cast<Word>(instructions.byte_length(m_node));
+            m_node = m_control_flow_graph->nodes()[m_node].next;
+            return;
+        }
+
+        // Fetching goes through the shared memory like any other read, since other cores may write to it.
+        static_assert(Instruction::max_byte_length <= sizeof(u64));
+        auto window = std::array<std::byte, sizeof(u64)>{};
+        store_little_endian(window.data(), m_memory->load_window(m_instruction_pointer));
+        auto const available = std::min(Instruction::max_byte_length, m_memory->size() - m_instruction_pointer);
+        auto const instruction = Instruction::decode(std::span{ window }.first(available));
+        std::visit([this](auto const& inst) { execute(inst); }, instruction);
+        m_instruction_pointer += static_cast<Word>(instruction.byte_length());
+    } catch (std::exception const& exception) {
+        auto const location = this->location();
+        throw Fault{
+            fmt::format(
+                "{} (at address 0x{:08x}{})",
+                exception.what(),
+                m_instruction_pointer,
+                location.has_value() ? fmt::format(", {}", location.value()) : ""
+            ),
+            m_instruction_pointer,
+        };
+    }
+}
+
+template<typename T>
+void Core::execute(T const& instruction) {
+    if constexpr (std::same_as<T, HaltAndCatchFire>) {
+        m_is_halted = true;
+    } else if constexpr (std::same_as<T, MoveImmediateIntoRegister>) {
+        write_register(instruction.register_, instruction.immediate);
+    } else if constexpr (std::same_as<T, MoveImmediateIntoMemory>) {
+        write_into_memory(instruction.pointer, instruction.immediate);
+    } else if constexpr (std::same_as<T, AtomicAddImmediateToMemory>) {
+        m_memory->fetch_add(read_register(instruction.pointer.register_()), instruction.immediate);
+    } else {
+        static_assert(std::same_as<T, Fence>);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+[[nodiscard]] tl::optional<Opcode> Core::next_opcode() const {
+    if (is_halted()) {
+        return tl::nullopt;
+    }
+    if (m_control_flow_graph != nullptr) {
+        return m_control_flow_graph->instructions().opcode(m_node);
+    }
+    if (m_instruction_pointer >= m_memory->size()) {
+        return tl::nullopt;
+    }
+    auto const opcode = magic_enum::enum_cast<Opcode>(static_cast<u8>(m_memory->load_window(m_instruction_pointer)));
+    if (not opcode.has_value()) {
+        return tl::nullopt;
+    }
+    return opcode.value();
+}
+
+u64 Core::run(u64 const max_instructions) {
+    auto executed = u64{ 0 };
+    while (executed < max_instructions and not is_halted()) {
+        step();
+        ++executed;
+    }
+    return executed;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <lib2k/types.hpp>
+#include <tl/optional.hpp>
+#include "emulator.hpp"
+#include "profiler.hpp"
+
+// The emulated machine has no cycle model: every instruction takes exactly one cycle, so
+// the clock frequency is given in instructions per second.
+struct ClockStatistics final {
+    u64 num_instructions;
+    u64 num_waits;
+    double instructions_per_second;
+    std::chrono::nanoseconds mean_jitter;
+    std::chrono::nanoseconds max_jitter;
+};
+
+class Clock final {
+public:
+    using SteadyClock = std::chrono::steady_clock;
+    using TimePoint = SteadyClock::time_point;
+    using Duration = SteadyClock::duration;
+
+    static constexpr auto default_slice_duration = Duration{ std::chrono::milliseconds{ 1 } };
+
+    // Sleeping is only accurate to the scheduler's granularity. The last part of every wait
+    // is spent spinning (and yielding) instead.
+    static constexpr auto default_spin_threshold = Duration{ std::chrono::microseconds{ 200 } };
+
+    // When the host cannot keep up (or the process was suspended), at most this much emulated
+    // time is caught up on. Everything beyond that is dropped instead of bursting.
+    static constexpr auto max_backlog = Duration{ std::chrono::milliseconds{ 100 } };
+
+private:
+    tl::optional<u64> m_frequency;
+    Duration m_slice_duration;
+    Duration m_spin_threshold;
+    Profiler* m_profiler = nullptr;
+
+    // Drift compensation: the number of instructions that are due is always computed relative
+    // to this epoch instead of accumulating per-slice rounding errors and oversleeping.
+    tl::optional<TimePoint> m_epoch;
+    u64 m_num_instructions_since_epoch = 0;
+
+    TimePoint m_statistics_start;
+    u64 m_num_instructions = 0;
+    u64 m_num_waits = 0;
+    Duration m_total_jitter{};
+    Duration m_max_jitter{};
+
+    [[nodiscard]] explicit Clock(tl::optional<u64> frequency, Duration slice_duration, Duration spin_threshold);
+
+public:
+    [[nodiscard]] static Clock unthrottled(Duration slice_duration = default_slice_duration);
+
+    [[nodiscard]] static Clock with_frequency(
+        u64 instructions_per_second,
+        Duration slice_duration = default_slice_duration,
+        Duration spin_threshold = default_spin_threshold
+    );
+
+    [[nodiscard]] bool is_throttled() const {
+        return m_frequency.has_value();
+    }
+
+    [[nodiscard]] tl::optional<u64> frequency() const {
+        return m_frequency;
+    }
+
+    // Executes instructions in time slices until the deadline is reached. Returns the number of
+    // executed instructions. A halted emulator makes this sleep until the deadline.
+    usize run_until(Emulator& emulator, TimePoint deadline);
+
+    // Executes all further instructions through the profiler, or directly again if it is null. The profiler
+    // must outlive its use by the clock.
+    void set_profiler(Profiler* const profiler) {
+        m_profiler = profiler;
+    }
+
+    [[nodiscard]] ClockStatistics statistics() const;
+
+    void reset_statistics();
+
+private:
+    [[nodiscard]] usize run_throttled_slice(Emulator& emulator, TimePoint slice_end);
+
+    [[nodiscard]] usize run_unthrottled_slice(Emulator& emulator, TimePoint slice_end);
+
+    [[nodiscard]] usize execute(Emulator& emulator, usize count);
+
+    void wait_until(TimePoint target);
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <common/common.hpp>
+#include <common/control_flow_graph.hpp>
+#include <common/instruction.hpp>
+#include <common/opcode.hpp>
+#include <common/pointer.hpp>
+#include <common/register.hpp>
+#include <common/source_map.hpp>
+#include <lib2k/types.hpp>
+#include <magic_enum.hpp>
+#include <stdexcept>
+#include <string>
+#include <tl/optional.hpp>
+#include <utility>
+#include "shared_memory.hpp"
+
+// Thrown when an instruction cannot be executed. The message names the source location of the
+// instruction if the emulator has a source map.
+class Fault final : public std::runtime_error {
+private:
+    Word m_address;
+
+public:
+    [[nodiscard]] Fault(std::string const& message, Word const address)
+        : std::runtime_error{ message }, m_address{ address } {}
+
+    [[nodiscard]] Word address() const {
+        return m_address;
+    }
+};
+
+// One CPU: its registers and instruction pointer. Executes instructions from memory that it may share
+// with other cores.
+class Core final {
+public:
+    using Registers = std::array<Word, magic_enum::enum_count<Register>()>;
+
+    // Everything that a save state keeps of a core.
+    struct State final {
+        Word instruction_pointer;
+        bool is_halted;
+        Registers registers;
+    };
+
+private:
+    SharedMemory* m_memory;
+    SourceMap const* m_source_map;
+    ControlFlowGraph const* m_control_flow_graph;  // Only for verified programs.
+    usize m_node = ControlFlowGraph::none;         // The node of the instruction that executes next.
+    Word m_instruction_pointer;
+    bool m_is_halted = false;
+    Registers m_registers{};
+
+public:
+    // With a control-flow graph, the core executes the instructions decoded in it instead of fetching them
+    // from memory. The graph must come from a verified program that contains `entry_point`, and nothing may
+    // write to the instructions of that program from outside.
+    [[nodiscard]] Core(
+        SharedMemory& memory,
+        SourceMap const& source_map,
+        Word entry_point,
+        ControlFlowGraph const* control_flow_graph = nullptr
+    );
+
+    // Throws a Fault if the instruction cannot be executed.
+    void step();
+
+    // Steps until the core halts, but at most `max_instructions` times. Returns the number of steps.
+    u64 run(u64 max_instructions);
+
+    [[nodiscard]] bool is_halted() const {
+        return m_is_halted;
+    }
+
+    [[nodiscard]] Word instruction_pointer() const {
+        return m_instruction_pointer;
+    }
+
+    [[nodiscard]] State state() const {
+        return State{ m_instruction_pointer, m_is_halted, m_registers };
+    }
+
+    // Continues from a saved state. Throws std::logic_error for cores that execute from a control-flow graph,
+    // which only know their position in the graph of their own program.
+    void restore(State const& state);
+
+    // Opcode of the instruction that executes next, if it is valid.
+    [[nodiscard]] tl::optional<Opcode> next_opcode() const;
+
+    // Where the instruction that executes next came from, for tracing.
+    [[nodiscard]] tl::optional<SourceMap::Location> location() const {
+        return m_source_map->find(m_instruction_pointer);
+    }
+
+    [[nodiscard]] Word read_register(Register const which) const {
+        return m_registers.at(std::to_underlying(which));
+    }
+
+    void write_register(Register const which, Word const value) {
+        m_registers.at(std::to_underlying(which)) = value;
+    }
+
+    void write_into_memory(Pointer const pointer, Word const value) {
+        m_memory->store(read_register(pointer.register_()), value);
+    }
+
+    [[nodiscard]] Word read_from_memory(Pointer const pointer) const {
+        return m_memory->load(read_register(pointer.register_()));
+    }
+
+private:
+    // For every alternative of Instruction. Defined and used in core.cpp only.
+    template<typename T>
+    void execute(T const& instruction);
+};
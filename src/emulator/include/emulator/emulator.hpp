@@ -2,28 +2,50 @@
 
 #include <array>
 #include <common/common.hpp>
+#include <common/opcode.hpp>
 #include <common/pointer.hpp>
 #include <common/register.hpp>
+#include <common/source_map.hpp>
 #include <cstddef>
-#include <cstdlib>
+#include <filesystem>
 #include <lib2k/types.hpp>
-#include <magic_enum.hpp>
-#include <optional>
+#include <span>
 #include <stdexcept>
-#include <utility>
-#include <vector>
+#include <tl/optional.hpp>
+#include "core.hpp"
+#include "machine.hpp"
+#include "save_state.hpp"
 #include "text_device.hpp"
+#include "verifier.hpp"
 
+// A machine with a single core.
 class Emulator final {
 private:
-    std::vector<std::byte> m_memory;
-    std::size_t m_instruction_pointer = 0;
-    bool m_is_halted = false;
-    std::array<Word, magic_enum::enum_count<Register>()> m_registers{};
-    TextDevice m_text_device;
+    Machine m_machine;
 
 public:
-    [[nodiscard]] explicit Emulator(std::span<std::byte const> memory);
+    // Programs are loaded directly behind the memory mapped devices.
+    static constexpr auto entry_point = Machine::entry_point;
+
+    // The source map, if any, must have been created for programs placed at `entry_point`.
+    [[nodiscard]] explicit Emulator(std::span<std::byte const> const memory, SourceMap source_map = {})
+        : m_machine{ memory, std::array{ static_cast<Word>(entry_point) }, std::move(source_map) } {}
+
+    // The program must have been verified for a single core, like VerifiedProgram::verify(program) does.
+    [[nodiscard]] explicit Emulator(VerifiedProgram const& program, SourceMap source_map = {})
+        : m_machine{ program, std::move(source_map) } {
+        if (m_machine.num_cores() != 1) {
+            throw std::invalid_argument{ "The program has more than one entry point." };
+        }
+    }
+
+    // Continues a saved emulator. The source map, if any, must belong to the program in the save state.
+    [[nodiscard]] explicit Emulator(SaveState const& state, SourceMap source_map = {})
+        : m_machine{ state, std::move(source_map) } {
+        if (m_machine.num_cores() != 1) {
+            throw std::invalid_argument{ "The save state has more than one core." };
+        }
+    }
 
     Emulator(Emulator const& other) = delete;
     Emulator(Emulator&& other) noexcept = delete;
@@ -31,28 +53,63 @@ public:
     Emulator& operator=(Emulator&& other) noexcept = delete;
     ~Emulator() = default;
 
-    void step();
+    void step() {
+        core().step();
+    }
 
     [[nodiscard]] bool is_halted() const {
-        return m_is_halted;
+        return core().is_halted();
+    }
+
+    // Throws std::runtime_error if the file cannot be written.
+    void save(std::filesystem::path const& path) const {
+        m_machine.save(path);
+    }
+
+    [[nodiscard]] Word instruction_pointer() const {
+        return core().instruction_pointer();
+    }
+
+    [[nodiscard]] SourceMap const& source_map() const {
+        return m_machine.source_map();
+    }
+
+    [[nodiscard]] tl::optional<Opcode> next_opcode() const {
+        return core().next_opcode();
+    }
+
+    // Where the instruction that executes next came from, for tracing.
+    [[nodiscard]] tl::optional<SourceMap::Location> location() const {
+        return core().location();
     }
 
     [[nodiscard]] Word read_register(Register const which) const {
-        return m_registers.at(std::to_underlying(which));
+        return core().read_register(which);
     }
 
     void write_register(Register const which, Word const value) {
-        m_registers.at(std::to_underlying(which)) = value;
+        core().write_register(which, value);
     }
 
+    // Memory is little endian on every host. Throws std::out_of_range if the word does not fit into memory.
     void write_into_memory(Pointer const pointer, Word const value) {
-        auto const address = read_register(pointer.register_());
-        auto const begin = reinterpret_cast<std::byte const*>(&value);
-        auto const end = begin + sizeof(value);
-        std::copy(begin, end, m_memory.begin() + address);
+        core().write_into_memory(pointer, value);
+    }
+
+    [[nodiscard]] Word read_from_memory(Pointer const pointer) const {
+        return core().read_from_memory(pointer);
     }
 
     [[nodiscard]] TextDevice const& text_device() const {
-        return m_text_device;
+        return m_machine.text_device();
+    }
+
+private:
+    [[nodiscard]] Core& core() {
+        return m_machine.core(0);
+    }
+
+    [[nodiscard]] Core const& core() const {
+        return m_machine.core(0);
     }
 };
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <common/common.hpp>
+#include <common/source_map.hpp>
+#include <cstddef>
+#include <filesystem>
+#include <lib2k/types.hpp>
+#include <span>
+#include <tl/optional.hpp>
+#include <vector>
+#include "core.hpp"
+#include "save_state.hpp"
+#include "shared_memory.hpp"
+#include "text_device.hpp"
+#include "verifier.hpp"
+
+enum class Scheduling : u8 {
+    // The cores take turns on the calling thread, a fixed number of instructions each. Every run of the
+    // same program interleaves the same way.
+    Deterministic,
+    // Every core runs on its own host thread. How their memory accesses interleave depends on the host.
+    FreeRunning,
+};
+
+// Any number of cores that share one memory and the memory mapped devices in it.
+class Machine final {
+private:
+    SharedMemory m_memory;
+    TextDevice m_text_device;
+    SourceMap m_source_map;
+    tl::optional<ControlFlowGraph> m_control_flow_graph;
+    std::vector<Core> m_cores;
+
+public:
+    // Programs are loaded directly behind the memory mapped devices.
+    static constexpr auto entry_point = TextDevice::num_mapped_bytes;
+
+    // Number of instructions a core executes in deterministic mode before the next one takes over, and
+    // how often cores check whether to stop early in free-running mode.
+    static constexpr auto default_quantum = u64{ 1'024 };
+
+    // Creates one core per entry point. The source map, if any, must have been created for programs placed
+    // at `entry_point`.
+    [[nodiscard]] Machine(
+        std::span<std::byte const> program,
+        std::span<Word const> entry_points,
+        SourceMap source_map = {}
+    );
+
+    // Creates one core per entry point of the program. The cores skip fetching and decoding instructions.
+    [[nodiscard]] explicit Machine(VerifiedProgram const& program, SourceMap source_map = {});
+
+    // Continues a saved machine. Its memory is loaded lazily from the save state, and its cores fetch their
+    // instructions from memory, even if the saved machine ran a verified program.
+    [[nodiscard]] explicit Machine(SaveState const& state, SourceMap source_map = {});
+
+    Machine(Machine const& other) = delete;
+    Machine(Machine&& other) noexcept = delete;
+    Machine& operator=(Machine const& other) = delete;
+    Machine& operator=(Machine&& other) noexcept = delete;
+    ~Machine() = default;
+
+    // Lets every core that is not halted execute up to `max_instructions_per_core` instructions. Returns
+    // the number of instructions executed by all cores together. A fault is rethrown. When running freely,
+    // the other cores stop at the end of their current quantum first, and if more than one core faults,
+    // the fault of the core with the lowest index wins.
+    u64 run(Scheduling scheduling, u64 max_instructions_per_core, u64 quantum = default_quantum);
+
+    [[nodiscard]] bool is_halted() const;
+
+    // Must not overlap with running cores. Throws std::runtime_error if the file cannot be written.
+    void save(std::filesystem::path const& path) const;
+
+    [[nodiscard]] usize num_cores() const {
+        return m_cores.size();
+    }
+
+    [[nodiscard]] Core& core(usize const index) {
+        return m_cores.at(index);
+    }
+
+    [[nodiscard]] Core const& core(usize const index) const {
+        return m_cores.at(index);
+    }
+
+    [[nodiscard]] SourceMap const& source_map() const {
+        return m_source_map;
+    }
+
+    // Not synchronised with running cores.
+    [[nodiscard]] TextDevice const& text_device() const {
+        return m_text_device;
+    }
+
+private:
+    [[nodiscard]] Machine(
+        std::span<std::byte const> program,
+        std::span<Word const> entry_points,
+        SourceMap source_map,
+        tl::optional<ControlFlowGraph> control_flow_graph
+    );
+
+    [[nodiscard]] u64 run_deterministic(u64 max_instructions_per_core, u64 quantum);
+
+    [[nodiscard]] u64 run_free_running(u64 max_instructions_per_core, u64 quantum);
+};
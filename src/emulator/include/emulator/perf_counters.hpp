@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <lib2k/types.hpp>
+#include <magic_enum.hpp>
+#include <tl/optional.hpp>
+#include <utility>
+#include <vector>
+
+enum class HardwareEvent : u8 {
+    Cycles,
+    Instructions,
+    BranchMisses,
+    L1DataMisses,  // Read misses.
+    LastLevelCacheMisses,
+};
+
+// Counts since the counters were opened, or the difference between two such readings. Events that cannot be
+// counted on this host are missing.
+struct CounterReading final {
+    std::chrono::nanoseconds elapsed{};
+    std::array<tl::optional<u64>, magic_enum::enum_count<HardwareEvent>()> events{};
+
+    [[nodiscard]] tl::optional<u64> operator[](HardwareEvent const event) const {
+        return events.at(std::to_underlying(event));
+    }
+
+    // Saturates at zero: scaled counts of multiplexed events are estimates and may go backwards a little.
+    friend CounterReading operator-(CounterReading const& lhs, CounterReading const& rhs);
+
+    // Events missing on the left count as zero, so that a default-constructed reading can be used as a sum.
+    CounterReading& operator+=(CounterReading const& other);
+};
+
+// Hardware counters of the host for the calling thread, counting user space only. Uses perf_event_open on
+// Linux. Every event that the hardware, the kernel or the permissions do not allow is left out, and without
+// any events, readings only contain the elapsed time.
+class PerfCounters final {
+private:
+    int m_group = -1;  // Descriptor of the group leader, which reads all events at once.
+    std::vector<int> m_descriptors;
+    std::array<tl::optional<usize>, magic_enum::enum_count<HardwareEvent>()> m_slots{};  // Index in a group read.
+    std::chrono::steady_clock::time_point m_start;
+
+    [[nodiscard]] PerfCounters() = default;
+
+public:
+    // Starts counting.
+    [[nodiscard]] static PerfCounters open();
+
+    PerfCounters(PerfCounters const& other) = delete;
+    PerfCounters(PerfCounters&& other) noexcept;
+    PerfCounters& operator=(PerfCounters const& other) = delete;
+    PerfCounters& operator=(PerfCounters&& other) noexcept;
+    ~PerfCounters();
+
+    [[nodiscard]] bool is_available(HardwareEvent const event) const {
+        return m_slots.at(std::to_underlying(event)).has_value();
+    }
+
+    [[nodiscard]] bool has_hardware_events() const {
+        return m_group != -1;
+    }
+
+    // One system call when hardware events are available.
+    [[nodiscard]] CounterReading read() const;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <common/opcode.hpp>
+#include <lib2k/types.hpp>
+#include <magic_enum.hpp>
+#include <random>
+#include <string>
+#include <vector>
+#include "emulator.hpp"
+#include "perf_counters.hpp"
+
+// Host counters over `num_instructions` consecutive emulated instructions.
+struct ProfileInterval final {
+    u64 num_instructions;
+    CounterReading counters;
+};
+
+// Host counters of single sampled instructions with the same opcode, summed up. The cost of reading the
+// counters is subtracted, so these are estimates that are most useful to compare opcodes with each other.
+struct OpcodeProfile final {
+    u64 num_samples = 0;
+    CounterReading counters;
+};
+
+struct ExecutionProfile final {
+    u64 num_instructions = 0;
+    CounterReading counters;  // Only while executing, including the overhead of sampling.
+    std::vector<ProfileInterval> intervals;
+    std::array<OpcodeProfile, magic_enum::enum_count<Opcode>()> opcodes;
+    bool has_hardware_events = false;
+
+    [[nodiscard]] double instructions_per_second() const;
+
+    // A human-readable report: emulated MIPS next to host events per emulated instruction, overall, per
+    // opcode and across intervals.
+    friend std::string format_as(ExecutionProfile const& profile);
+};
+
+// Runs an emulator while attributing host hardware events (cycles, instructions, branch misses, cache misses)
+// to the emulated instructions. Counters are read at the start and end of every run, every `interval`
+// instructions, and around one in every `sampling_period` instructions on average, which is attributed to its
+// opcode. The gaps between samples are random so that they do not line up with loops in the program. Where
+// hardware counters are not available, only time is measured.
+class Profiler final {
+public:
+    static constexpr auto default_interval = u64{ 1 } << 16;
+    static constexpr auto default_sampling_period = u64{ 1 } << 12;
+
+private:
+    PerfCounters m_counters;
+    u64 m_interval;
+    u64 m_sampling_period;
+    CounterReading m_read_overhead;
+    std::minstd_rand m_random;
+    u64 m_until_sample = 0;
+    ProfileInterval m_current_interval{};
+    ExecutionProfile m_profile;
+
+public:
+    [[nodiscard]] explicit Profiler(
+        u64 interval = default_interval,
+        u64 sampling_period = default_sampling_period
+    );
+
+    // Steps until the emulator halts, but at most `max_instructions` times. Returns the number of steps.
+    u64 run(Emulator& emulator, u64 max_instructions);
+
+    [[nodiscard]] ExecutionProfile const& profile() const {
+        return m_profile;
+    }
+
+private:
+    void sample_step(Emulator& emulator);
+};
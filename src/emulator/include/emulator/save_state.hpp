@@ -0,0 +1,75 @@
+#pragma once
+
+#include <common/mapped_file.hpp>
+#include <cstddef>
+#include <filesystem>
+#include <lib2k/types.hpp>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+#include <tl/expected.hpp>
+#include <vector>
+#include "core.hpp"
+#include "shared_memory.hpp"
+
+// A machine saved to a file: all of its memory, which includes the memory mapped devices and with them their
+// state, and the registers, instruction pointer and halt flag of every core.
+//
+// Memory is stored in pages of SharedMemory::page_size bytes. Pages that are all zero are left out, pages with
+// the same contents are stored once, and every stored page is compressed on its own. Loading only reads the
+// header and the tables from the memory mapped file. A machine restored from the state decompresses every page
+// when it first accesses it, so resuming takes about the same time however large memory is.
+class SaveState final {
+public:
+    static constexpr auto format_version = u64{ 1 };
+
+private:
+    static constexpr auto zero_page = std::numeric_limits<u32>::max();
+
+    struct StoredPage final {
+        usize offset;  // In the file.
+        usize size;
+        bool is_compressed;  // Pages that do not get smaller are stored as they are.
+    };
+
+    std::shared_ptr<MappedFile const> m_file;
+    usize m_memory_size = 0;
+    std::vector<Core::State> m_cores;
+    std::vector<u32> m_pages;  // Per page of memory, the index of its stored page or `zero_page`.
+    std::vector<StoredPage> m_stored_pages;
+
+public:
+    // Replaces the file atomically. Throws std::runtime_error if it cannot be written.
+    static void write(
+        std::filesystem::path const& path,
+        std::span<std::byte const> memory,
+        std::span<Core::State const> cores
+    );
+
+    // Fails if the file cannot be read, has another format version or is malformed. The contents of pages are
+    // only checked when they are loaded.
+    [[nodiscard]] static tl::expected<SaveState, std::string> load(std::filesystem::path const& path);
+
+    [[nodiscard]] usize memory_size() const {
+        return m_memory_size;
+    }
+
+    [[nodiscard]] std::span<Core::State const> cores() const {
+        return m_cores;
+    }
+
+    // After leaving out zero pages and duplicates.
+    [[nodiscard]] usize num_stored_pages() const {
+        return m_stored_pages.size();
+    }
+
+    // Decompresses pages from this save state, which stays mapped for as long as the loader exists. Throws
+    // std::runtime_error if a page is corrupt.
+    [[nodiscard]] SharedMemory::PageLoader page_loader() const;
+
+private:
+    [[nodiscard]] SaveState() = default;
+
+    void load_page(usize index, std::span<std::byte> page) const;
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <common/common.hpp>
+#include <cstddef>
+#include <functional>
+#include <lib2k/types.hpp>
+#include <memory>
+#include <span>
+#include <stdexcept>
+
+// Memory shared by all cores of a machine. Cores access it concurrently, so every access is made up of
+// atomic operations on the aligned words the memory consists of:
+//  - Aligned word loads and stores are single-copy atomic and relaxed. Other cores may observe relaxed
+//    stores in any order, unless an atomic add or a fence orders them.
+//  - Unaligned loads and stores touch two words, each of them atomically, but not both at once. Stores merge
+//    their bytes into each word with a compare-and-swap, so concurrent stores to neighbouring bytes are never
+//    lost.
+//  - Atomic adds require an aligned word and are sequentially consistent.
+// The contents are little endian on every host, as devices see them byte by byte.
+//
+// Memory can also be filled lazily, a page at a time: a page loader provides the contents of every page when
+// it is first accessed, e.g. from a save state. Until then, pages cost nothing but address space.
+class SharedMemory final {
+public:
+    static constexpr auto page_size = usize{ 4'096 };
+
+    // Writes the contents of the page with index `page_index` into `page`, which is zero beforehand. The last
+    // page may be shorter than page_size. Called at most once per page, unless it throws.
+    using PageLoader = std::function<void(usize page_index, std::span<std::byte> page)>;
+
+private:
+    static_assert(std::atomic_ref<Word>::is_always_lock_free);
+    static_assert(alignof(Word) >= std::atomic_ref<Word>::required_alignment);
+    static_assert(page_size % sizeof(Word) == 0);
+
+    enum class PageState : u8 {
+        Missing,
+        Loading,
+        Loaded,
+    };
+
+    struct Deallocate final {
+        void operator()(Word* words) const;
+    };
+
+    usize m_size;
+    std::unique_ptr<Word[], Deallocate> m_words;
+    PageLoader m_page_loader;
+    std::unique_ptr<std::atomic<PageState>[]> m_page_states;  // Only with a page loader.
+
+public:
+    // Zero-initialised.
+    [[nodiscard]] explicit SharedMemory(usize size);
+
+    // Every page is loaded by `page_loader` on first access, on whatever thread accesses it. Cores that
+    // access a page while it is being loaded wait for it.
+    [[nodiscard]] SharedMemory(usize size, PageLoader page_loader);
+
+    [[nodiscard]] usize size() const {
+        return m_size;
+    }
+
+    [[nodiscard]] usize num_pages() const {
+        return (m_size + page_size - 1) / page_size;
+    }
+
+    // Plain access, for devices and for loading programs. Must not overlap with cores running. Loads all pages
+    // of the range that are not loaded yet.
+    [[nodiscard]] std::span<std::byte> bytes(usize const address, usize const size) {
+        check_bounds(address, size);
+        make_resident(address, size);
+        return std::span{ reinterpret_cast<std::byte*>(m_words.get()) + address, size };
+    }
+
+    [[nodiscard]] std::span<std::byte const> bytes(usize const address, usize const size) const {
+        check_bounds(address, size);
+        make_resident(address, size);
+        return std::span{ reinterpret_cast<std::byte const*>(m_words.get()) + address, size };
+    }
+
+    [[nodiscard]] std::span<std::byte> bytes() {
+        return bytes(0, m_size);
+    }
+
+    [[nodiscard]] std::span<std::byte const> bytes() const {
+        return bytes(0, m_size);
+    }
+
+    // All of the following throw std::out_of_range if the access does not lie completely within memory.
+
+    // Copies `output.size()` bytes.
+    void read(usize address, std::span<std::byte> output) const;
+
+    // The eight bytes from `address` on as a little-endian number, with zeros past the end of memory. Meant
+    // for fetching instructions. Assembling the bytes in a register avoids storing words and then reading
+    // them back at another offset, which defeats store forwarding.
+    [[nodiscard]] u64 load_window(usize const address) const {
+        check_bounds(address, 1);
+        make_resident(address, std::min(sizeof(u64), m_size - address));
+        auto const num_words = (m_size + sizeof(Word) - 1) / sizeof(Word);
+        auto const word_at = [&](usize const index) {
+            if (index >= num_words) {
+                return u64{ 0 };
+            }
+            return u64{ from_little_endian(word(index).load(std::memory_order_relaxed)) };
+        };
+        auto const index = address / sizeof(Word);
+        auto const shift = address % sizeof(Word) * 8;
+        auto const low = word_at(index) | word_at(index + 1) << 32;
+        if (shift == 0) {
+            return low;
+        }
+        return low >> shift | word_at(index + 2) << (64 - shift);
+    }
+
+    [[nodiscard]] Word load(usize const address) const {
+        if (address % sizeof(Word) != 0) {
+            return load_unaligned(address);
+        }
+        check_bounds(address, sizeof(Word));
+        make_resident(address, sizeof(Word));
+        return from_little_endian(word(address / sizeof(Word)).load(std::memory_order_relaxed));
+    }
+
+    void store(usize const address, Word const value) {
+        if (address % sizeof(Word) != 0) {
+            store_unaligned(address, value);
+            return;
+        }
+        check_bounds(address, sizeof(Word));
+        make_resident(address, sizeof(Word));
+        word(address / sizeof(Word)).store(to_little_endian(value), std::memory_order_relaxed);
+    }
+
+    // Returns the previous value. Throws std::invalid_argument if `address` is not aligned.
+    Word fetch_add(usize address, Word value);
+
+private:
+    void check_bounds(usize const address, usize const size) const {
+        if (address > m_size or m_size - address < size) {
+            throw std::out_of_range{ "Memory access out of bounds." };
+        }
+    }
+
+    // Only has to check a pointer while no page loader is set.
+    void make_resident(usize const address, usize const size) const {
+        if (m_page_states != nullptr) [[unlikely]] {
+            load_pages(address, size);
+        }
+    }
+
+    void load_pages(usize address, usize size) const;
+
+    void load_page(usize index) const;
+
+    [[nodiscard]] Word load_unaligned(usize address) const;
+
+    void store_unaligned(usize address, Word value);
+
+    [[nodiscard]] std::atomic_ref<Word> word(usize index) const {
+        return std::atomic_ref<Word>{ m_words[index] };
+    }
+};
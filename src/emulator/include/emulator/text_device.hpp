@@ -1,9 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <fmt/format.h>
+#include <iterator>
+#include <ranges>
 #include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include "memory_mapped_device.hpp"
 
 class TextDevice final {
@@ -13,6 +17,15 @@ public:
     static constexpr auto num_mapped_bytes = usize{ num_rows * num_columns };
     static constexpr auto alignment = usize{ 1 };
 
+    // Number of characters written by format_to(): all rows, separated by newlines.
+    static constexpr auto formatted_size = usize{ num_rows * num_columns + (num_rows - 1) };
+
+    struct Cell final {
+        usize column;
+        usize row;
+        char value;
+    };
+
 private:
     std::span<std::byte> m_mapped_memory;
 
@@ -32,15 +45,49 @@ public:
         return std::to_integer<char>(m_mapped_memory[index]);
     }
 
+    // Raw contents of a single row, without any translation (i.e. unused cells are '\0').
+    [[nodiscard]] std::string_view row(usize const y) const {
+        if (y >= num_rows) {
+            throw std::out_of_range{ fmt::format("Invalid row: {}", y) };
+        }
+        return std::string_view{ reinterpret_cast<char const*>(m_mapped_memory.data() + y * num_columns), num_columns };
+    }
+
+    // All cells in row-major order.
+    [[nodiscard]] auto cells() const {
+        auto const to_cell = [memory = m_mapped_memory](usize const i) {
+            return Cell{ i % num_columns, i / num_columns, std::to_integer<char>(memory[i]) };
+        };
+        return std::views::iota(usize{ 0 }, num_mapped_bytes) | std::views::transform(to_cell);
+    }
+
+    // Writes the screen contents as text (rows separated by newlines, '\0' replaced by spaces)
+    // without allocating. Works with any output iterator, e.g. fmt::appender for a fmt::memory_buffer.
+    template<std::output_iterator<char> Output>
+    Output format_to(Output output) const {
+        for (auto y = usize{ 0 }; y < num_rows; ++y) {
+            if (y != 0) {
+                *output++ = '\n';
+            }
+            output = std::ranges::transform(row(y), output, [](char const c) { return c == '\0' ? ' ' : c; }).out;
+        }
+        return output;
+    }
+
+    // Same as format_to(), but into a caller-provided buffer of at least formatted_size characters.
+    // Returns the number of characters written.
+    usize format_into(std::span<char> const buffer) const {
+        if (buffer.size() < formatted_size) {
+            throw std::invalid_argument{ "Buffer too small." };
+        }
+        return static_cast<usize>(format_to(buffer.begin()) - buffer.begin());
+    }
+
     [[nodiscard]] std::string text() const {
         auto result = std::string{};
         result.reserve(num_rows * num_columns + (num_rows - 1));
         for (auto row = usize{ 0 }; row < num_rows; ++row) {
-            auto const line = std::string_view{
-                reinterpret_cast<char const*>(&m_mapped_memory[row * num_columns]),
-                num_columns,
-            };
-            result += line;
+            result += this->row(row);
             if (row != num_rows - 1) {
                 result += '\n';
             }
@@ -50,3 +97,10 @@ public:
 };
 
 static_assert(MemoryMappedDevice<TextDevice>);
+
+template<>
+struct fmt::formatter<TextDevice> : fmt::formatter<std::string_view> {
+    auto format(TextDevice const& text_device, format_context& context) const {
+        return text_device.format_to(context.out());
+    }
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <fmt/format.h>
+#include <common/common.hpp>
+#include <common/control_flow_graph.hpp>
+#include <cstddef>
+#include <lib2k/types.hpp>
+#include <span>
+#include <string>
+#include <tl/expected.hpp>
+#include <utility>
+#include <vector>
+
+// A program that has been checked once when loading it, for all of its entry points together:
+//  - Every reachable instruction decodes, and no core runs off the end of memory.
+//  - The address of every memory access is known, lies within memory, is aligned for atomic adds, and no
+//    store overwrites a reachable instruction.
+// Registers start out as zero and only ever receive immediates, so addresses are known unless paths with
+// different register contents meet. Machines run verified programs from the decoded control-flow graph
+// instead of fetching and decoding every instruction.
+class VerifiedProgram final {
+public:
+    struct Error final {
+        Word address;  // Of the instruction that would fault.
+        std::string message;
+
+        [[nodiscard]] friend std::string format_as(Error const& error) {
+            return fmt::format("0x{:08x}: {}", error.address, error.message);
+        }
+    };
+
+private:
+    std::vector<std::byte> m_program;
+    std::vector<Word> m_entry_points;
+    ControlFlowGraph m_control_flow_graph;
+
+public:
+    // Entry points are addresses in the memory of a machine, which has the program loaded at
+    // Machine::entry_point. Returns all errors, sorted by address.
+    [[nodiscard]] static tl::expected<VerifiedProgram, std::vector<Error>> verify(
+        std::span<std::byte const> program,
+        std::span<Word const> entry_points
+    );
+
+    // For a single core that starts at the first instruction of the program.
+    [[nodiscard]] static tl::expected<VerifiedProgram, std::vector<Error>> verify(std::span<std::byte const> program);
+
+    [[nodiscard]] std::span<std::byte const> program() const {
+        return m_program;
+    }
+
+    [[nodiscard]] std::span<Word const> entry_points() const {
+        return m_entry_points;
+    }
+
+    [[nodiscard]] ControlFlowGraph const& control_flow_graph() const {
+        return m_control_flow_graph;
+    }
+
+    // Addresses of the loop headers, where hot paths start.
+    [[nodiscard]] std::vector<Word> hot_loop_candidates() const;
+
+private:
+    [[nodiscard]] VerifiedProgram(
+        std::vector<std::byte> program,
+        std::vector<Word> entry_points,
+        ControlFlowGraph control_flow_graph
+    )
+        : m_program{ std::move(program) },
+          m_entry_points{ std::move(entry_points) },
+          m_control_flow_graph{ std::move(control_flow_graph) } {}
+};
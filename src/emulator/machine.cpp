@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <emulator/machine.hpp>
+#include <exception>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+[[nodiscard]] Machine::Machine(
+    std::span<std::byte const> const program,
+    std::span<Word const> const entry_points,
+    SourceMap source_map
+)
+    : Machine{ program, entry_points, std::move(source_map), tl::nullopt } {}
+
+[[nodiscard]] Machine::Machine(VerifiedProgram const& program, SourceMap source_map)
+    : Machine{ program.program(), program.entry_points(), std::move(source_map), program.control_flow_graph() } {}
+
+[[nodiscard]] Machine::Machine(SaveState const& state, SourceMap source_map)
+    : m_memory{ state.memory_size(), state.page_loader() },
+      m_text_device{ m_memory.bytes(0, TextDevice::num_mapped_bytes) },
+      m_source_map{ std::move(source_map) } {
+    if (state.cores().empty()) {
+        throw std::invalid_argument{ "A machine needs at least one core." };
+    }
+    m_cores.reserve(state.cores().size());
+    for (auto const& core : state.cores()) {
+        m_cores.emplace_back(m_memory, m_source_map, core.instruction_pointer).restore(core);
+    }
+}
+
+[[nodiscard]] Machine::Machine(
+    std::span<std::byte const> const program,
+    std::span<Word const> const entry_points,
+    SourceMap source_map,
+    tl::optional<ControlFlowGraph> control_flow_graph
+)
+    : m_memory{ TextDevice::num_mapped_bytes + program.size() },
+      m_text_device{ m_memory.bytes().subspan(0, TextDevice::num_mapped_bytes) },
+      m_source_map{ std::move(source_map) },
+      m_control_flow_graph{ std::move(control_flow_graph) } {
+    if (entry_points.empty()) {
+        throw std::invalid_argument{ "A machine needs at least one core." };
+    }
+    std::ranges::copy(program, m_memory.bytes().begin() + entry_point);
+    m_cores.reserve(entry_points.size());
+    for (auto const address : entry_points) {
+        m_cores.emplace_back(
+            m_memory,
+            m_source_map,
+            address,
+            m_control_flow_graph.has_value() ? &m_control_flow_graph.value() : nullptr
+        );
+    }
+}
+
+void Machine::save(std::filesystem::path const& path) const {
+    auto cores = std::vector<Core::State>{};
+    cores.reserve(m_cores.size());
+    for (auto const& core : m_cores) {
+        cores.push_back(core.state());
+    }
+    SaveState::write(path, m_memory.bytes(), cores);
+}
+
+u64 Machine::run(Scheduling const scheduling, u64 const max_instructions_per_core, u64 const quantum) {
+    if (quantum == 0) {
+        throw std::invalid_argument{ "Quantum must not be zero." };
+    }
+    switch (scheduling) {
+        case Scheduling::Deterministic:
+            return run_deterministic(max_instructions_per_core, quantum);
+        case Scheduling::FreeRunning:
+            return run_free_running(max_instructions_per_core, quantum);
+    }
+    throw std::invalid_argument{ "Invalid scheduling." };
+}
+
+[[nodiscard]] bool Machine::is_halted() const {
+    return std::ranges::all_of(m_cores, &Core::is_halted);
+}
+
+[[nodiscard]] u64 Machine::run_deterministic(u64 const max_instructions_per_core, u64 const quantum) {
+    auto remaining = std::vector<u64>(m_cores.size(), max_instructions_per_core);
+    auto executed = u64{ 0 };
+    auto progress = true;
+    while (progress) {
+        progress = false;
+        for (auto i = usize{ 0 }; i < m_cores.size(); ++i) {
+            auto const steps = m_cores[i].run(std::min(quantum, remaining[i]));
+            remaining[i] -= steps;
+            executed += steps;
+            progress = progress or steps > 0;
+        }
+    }
+    return executed;
+}
+
+[[nodiscard]] u64 Machine::run_free_running(u64 const max_instructions_per_core, u64 const quantum) {
+    auto executed = std::vector<u64>(m_cores.size(), 0);
+    auto faults = std::vector<std::exception_ptr>(m_cores.size());
+    auto stop_source = std::stop_source{};
+    auto const work = [&](usize const index) {
+        auto& core = m_cores[index];
+        try {
+            while (executed[index] < max_instructions_per_core and not core.is_halted()
+                   and not stop_source.stop_requested()) {
+                executed[index] += core.run(std::min(quantum, max_instructions_per_core - executed[index]));
+            }
+        } catch (...) {
+            faults[index] = std::current_exception();
+            stop_source.request_stop();
+        }
+    };
+
+    auto const num_running = std::ranges::count_if(m_cores, [](Core const& core) { return not core.is_halted(); });
+    if (num_running <= 1) {
+        for (auto i = usize{ 0 }; i < m_cores.size(); ++i) {
+            work(i);
+        }
+    } else {
+        auto threads = std::vector<std::jthread>{};
+        threads.reserve(m_cores.size());
+        for (auto i = usize{ 0 }; i < m_cores.size(); ++i) {
+            if (not m_cores[i].is_halted()) {
+                threads.emplace_back(work, i);
+            }
+        }
+    }
+
+    for (auto const& fault : faults) {
+        if (fault) {
+            std::rethrow_exception(fault);
+        }
+    }
+    auto result = u64{ 0 };
+    for (auto const count : executed) {
+        result += count;
+    }
+    return result;
+}
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <emulator/perf_counters.hpp>
+
+#if __has_include(<linux/perf_event.h>)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define IUBS2K_HAS_PERF_EVENTS 1
+#else
+#define IUBS2K_HAS_PERF_EVENTS 0
+#endif
+
+namespace {
+    [[nodiscard]] tl::optional<u64> subtract(tl::optional<u64> const lhs, tl::optional<u64> const rhs) {
+        if (not lhs.has_value() or not rhs.has_value()) {
+            return tl::nullopt;
+        }
+        return lhs.value() > rhs.value() ? lhs.value() - rhs.value() : u64{ 0 };
+    }
+
+#if IUBS2K_HAS_PERF_EVENTS
+    struct EventConfig final {
+        u32 type;
+        u64 config;
+    };
+
+    [[nodiscard]] EventConfig config_of(HardwareEvent const event) {
+        switch (event) {
+            case HardwareEvent::Cycles:
+                return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES };
+            case HardwareEvent::Instructions:
+                return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS };
+            case HardwareEvent::BranchMisses:
+                return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES };
+            case HardwareEvent::L1DataMisses:
+                return {
+                    PERF_TYPE_HW_CACHE,
+                    PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+                };
+            case HardwareEvent::LastLevelCacheMisses:
+                return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES };
+        }
+        return { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES };
+    }
+
+    // Returns -1 if the event cannot be counted.
+    [[nodiscard]] int open_event(HardwareEvent const event, int const group) {
+        auto const [type, config] = config_of(event);
+        auto attributes = perf_event_attr{};
+        attributes.size = sizeof(attributes);
+        attributes.type = type;
+        attributes.config = config;
+        attributes.disabled = group == -1 ? 1 : 0;  // The leader starts the whole group.
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attributes, 0, -1, group, PERF_FLAG_FD_CLOEXEC));
+    }
+#endif
+}  // namespace
+
+[[nodiscard]] CounterReading operator-(CounterReading const& lhs, CounterReading const& rhs) {
+    auto result = CounterReading{ .elapsed = std::max(lhs.elapsed - rhs.elapsed, std::chrono::nanoseconds::zero()) };
+    for (auto i = usize{ 0 }; i < result.events.size(); ++i) {
+        result.events[i] = subtract(lhs.events[i], rhs.events[i]);
+    }
+    return result;
+}
+
+CounterReading& CounterReading::operator+=(CounterReading const& other) {
+    elapsed += other.elapsed;
+    for (auto i = usize{ 0 }; i < events.size(); ++i) {
+        if (other.events[i].has_value()) {
+            events[i] = events[i].value_or(0) + other.events[i].value();
+        }
+    }
+    return *this;
+}
+
+[[nodiscard]] PerfCounters PerfCounters::open() {
+    auto result = PerfCounters{};
+#if IUBS2K_HAS_PERF_EVENTS
+    for (auto const event : magic_enum::enum_values<HardwareEvent>()) {
+        auto const descriptor = open_event(event, result.m_group);
+        if (descriptor == -1) {
+            continue;
+        }
+        if (result.m_group == -1) {
+            result.m_group = descriptor;
+        }
+        result.m_slots.at(std::to_underlying(event)) = result.m_descriptors.size();
+        result.m_descriptors.push_back(descriptor);
+    }
+    if (result.m_group != -1) {
+        ::ioctl(result.m_group, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ::ioctl(result.m_group, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+    result.m_start = std::chrono::steady_clock::now();
+    return result;
+}
+
+PerfCounters::PerfCounters(PerfCounters&& other) noexcept
+    : m_group{ std::exchange(other.m_group, -1) },
+      m_descriptors{ std::move(other.m_descriptors) },
+      m_slots{ std::exchange(other.m_slots, {}) },
+      m_start{ other.m_start } {}
+
+PerfCounters& PerfCounters::operator=(PerfCounters&& other) noexcept {
+    if (this != &other) {
+        std::swap(m_group, other.m_group);
+        std::swap(m_descriptors, other.m_descriptors);
+        std::swap(m_slots, other.m_slots);
+        std::swap(m_start, other.m_start);
+    }
+    return *this;
+}
+
+PerfCounters::~PerfCounters() {
+#if IUBS2K_HAS_PERF_EVENTS
+    for (auto const descriptor : m_descriptors) {
+        ::close(descriptor);
+    }
+#endif
+}
+
+[[nodiscard]] CounterReading PerfCounters::read() const {
+    auto result = CounterReading{
+        .elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start),
+    };
+#if IUBS2K_HAS_PERF_EVENTS
+    if (m_group == -1) {
+        return result;
+    }
+    // Layout of a group read: number of events, time enabled, time running, one value per event.
+    auto buffer = std::array<u64, 3 + magic_enum::enum_count<HardwareEvent>()>{};
+    auto const size = (3 + m_descriptors.size()) * sizeof(u64);
+    if (::read(m_group, buffer.data(), size) != static_cast<ssize_t>(size)) {
+        return result;
+    }
+    auto const enabled = buffer[1];
+    auto const running = buffer[2];
+    if (running == 0) {
+        return result;  // The group never got onto the hardware.
+    }
+    for (auto i = usize{ 0 }; i < m_slots.size(); ++i) {
+        if (m_slots[i].has_value()) {
+            // Scales up if the kernel had to multiplex the counters with other users.
+            auto const value = buffer.at(3 + m_slots[i].value());
+            result.events[i] = running == enabled ? value
+                                                  : static_cast<u64>(static_cast<double>(value)
+                                                                     * static_cast<double>(enabled)
+                                                                     / static_cast<double>(running));
+        }
+    }
+#endif
+    return result;
+}
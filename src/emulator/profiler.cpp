@@ -0,0 +1,170 @@
+#include <fmt/format.h>
+#include <algorithm>
+#include <chrono>
+#include <emulator/profiler.hpp>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    // Smallest value of every event.
+    [[nodiscard]] CounterReading minimum(CounterReading const& lhs, CounterReading const& rhs) {
+        auto result = CounterReading{ .elapsed = std::min(lhs.elapsed, rhs.elapsed) };
+        for (auto i = usize{ 0 }; i < result.events.size(); ++i) {
+            if (lhs.events[i].has_value() and rhs.events[i].has_value()) {
+                result.events[i] = std::min(lhs.events[i].value(), rhs.events[i].value());
+            }
+        }
+        return result;
+    }
+
+    [[nodiscard]] double per_instruction(u64 const value, u64 const num_instructions) {
+        return num_instructions == 0 ? 0.0 : static_cast<double>(value) / static_cast<double>(num_instructions);
+    }
+
+    [[nodiscard]] double instructions_per_second(u64 const num_instructions, std::chrono::nanoseconds const elapsed) {
+        auto const seconds = std::chrono::duration<double>{ elapsed }.count();
+        return seconds > 0.0 ? static_cast<double>(num_instructions) / seconds : 0.0;
+    }
+
+    // Time and every available event, per emulated instruction.
+    [[nodiscard]] std::string format_per_instruction(CounterReading const& counters, u64 const num_instructions) {
+        auto result = fmt::format(
+            "{:.2f} ns",
+            per_instruction(static_cast<u64>(counters.elapsed.count()), num_instructions)
+        );
+        for (auto const event : magic_enum::enum_values<HardwareEvent>()) {
+            if (auto const value = counters[event]; value.has_value()) {
+                fmt::format_to(
+                    std::back_inserter(result),
+                    ", {} {:.3f}",
+                    magic_enum::enum_name(event),
+                    per_instruction(value.value(), num_instructions)
+                );
+            }
+        }
+        return result;
+    }
+}  // namespace
+
+[[nodiscard]] double ExecutionProfile::instructions_per_second() const {
+    return ::instructions_per_second(num_instructions, counters.elapsed);
+}
+
+[[nodiscard]] std::string format_as(ExecutionProfile const& profile) {
+    auto result = fmt::format(
+        "Executed {} instructions in {:.3f} ms ({:.2f} MIPS).\n",
+        profile.num_instructions,
+        std::chrono::duration<double, std::milli>{ profile.counters.elapsed }.count(),
+        profile.instructions_per_second() / 1'000'000.0
+    );
+    auto out = std::back_inserter(result);
+    if (not profile.has_hardware_events) {
+        fmt::format_to(out, "Hardware counters are not available, only time was measured.\n");
+    }
+    fmt::format_to(
+        out,
+        "Per instruction: {}\n",
+        format_per_instruction(profile.counters, profile.num_instructions)
+    );
+
+    fmt::format_to(out, "Per sampled instruction, by opcode:\n");
+    for (auto const opcode : magic_enum::enum_values<Opcode>()) {
+        auto const& opcode_profile = profile.opcodes.at(std::to_underlying(opcode));
+        if (opcode_profile.num_samples > 0) {
+            fmt::format_to(
+                out,
+                "  {} ({} samples): {}\n",
+                magic_enum::enum_name(opcode),
+                opcode_profile.num_samples,
+                format_per_instruction(opcode_profile.counters, opcode_profile.num_samples)
+            );
+        }
+    }
+
+    if (not profile.intervals.empty()) {
+        auto const mips = [](ProfileInterval const& interval) {
+            return instructions_per_second(interval.num_instructions, interval.counters.elapsed) / 1'000'000.0;
+        };
+        auto const [slowest, fastest] = std::ranges::minmax_element(profile.intervals, {}, mips);
+        fmt::format_to(
+            out,
+            "{} intervals of {} instructions, {:.2f} to {:.2f} MIPS.\n",
+            profile.intervals.size(),
+            profile.intervals.front().num_instructions,
+            mips(*slowest),
+            mips(*fastest)
+        );
+        fmt::format_to(
+            out,
+            "  Slowest: {}\n",
+            format_per_instruction(slowest->counters, slowest->num_instructions)
+        );
+    }
+    return result;
+}
+
+[[nodiscard]] Profiler::Profiler(u64 const interval, u64 const sampling_period)
+    : m_counters{ PerfCounters::open() }, m_interval{ interval }, m_sampling_period{ sampling_period } {
+    if (m_interval == 0 or m_sampling_period == 0) {
+        throw std::invalid_argument{ "Interval and sampling period must not be zero." };
+    }
+    m_profile.has_hardware_events = m_counters.has_hardware_events();
+
+    // What two back-to-back reads measure is what reading adds to every sample.
+    static constexpr auto num_calibration_rounds = 32;
+    for (auto i = 0; i < num_calibration_rounds; ++i) {
+        auto const before = m_counters.read();
+        auto const overhead = m_counters.read() - before;
+        m_read_overhead = i == 0 ? overhead : minimum(m_read_overhead, overhead);
+    }
+}
+
+u64 Profiler::run(Emulator& emulator, u64 const max_instructions) {
+    auto const start = m_counters.read();
+    auto interval_start = start;
+    auto executed = u64{ 0 };
+    auto const finish = [&] {
+        auto const end = m_counters.read();
+        m_current_interval.counters += end - interval_start;
+        m_profile.counters += end - start;
+    };
+
+    try {
+        while (executed < max_instructions and not emulator.is_halted()) {
+            if (m_until_sample == 0) {
+                sample_step(emulator);
+                m_until_sample = m_sampling_period / 2 + m_random() % m_sampling_period;
+            } else {
+                emulator.step();
+                --m_until_sample;
+            }
+            ++executed;
+            ++m_profile.num_instructions;
+            ++m_current_interval.num_instructions;
+            if (m_current_interval.num_instructions == m_interval) {
+                auto const now = m_counters.read();
+                m_current_interval.counters += now - interval_start;
+                m_profile.intervals.push_back(std::exchange(m_current_interval, ProfileInterval{}));
+                interval_start = now;
+            }
+        }
+    } catch (...) {
+        finish();
+        throw;
+    }
+    finish();
+    return executed;
+}
+
+void Profiler::sample_step(Emulator& emulator) {
+    auto const opcode = emulator.next_opcode();
+    auto const before = m_counters.read();
+    emulator.step();
+    auto const after = m_counters.read();
+    if (opcode.has_value()) {
+        auto& opcode_profile = m_profile.opcodes.at(std::to_underlying(opcode.value()));
+        ++opcode_profile.num_samples;
+        opcode_profile.counters += after - before - m_read_overhead;
+    }
+}
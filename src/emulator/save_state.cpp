@@ -0,0 +1,225 @@
+#include <fmt/format.h>
+#include <algorithm>
+#include <common/byte_stream.hpp>
+#include <common/compression.hpp>
+#include <common/mapped_file.hpp>
+#include <common/memory.hpp>
+#include <emulator/save_state.hpp>
+#include <emulator/text_device.hpp>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+    // File layout (all integers little endian):
+    //   header:       magic, format version, memory size, page size, number of cores, registers per core,
+    //                 number of stored pages (u64 each)
+    //   cores:        per core the instruction pointer, the halt flag and the registers (u32 each)
+    //   page table:   per page of memory the index of its stored page, or 0xFFFFFFFF if it is all zeros (u32)
+    //   stored pages: per stored page its offset in the file (u64), its size (u32) and its encoding (u32)
+    //   data:         the stored pages
+    inline constexpr auto magic = u64{ 0x53'53'4B'32'53'42'55'49 };  // "IUBS2KSS"
+    inline constexpr auto page_size = SharedMemory::page_size;
+    inline constexpr auto num_registers = std::tuple_size_v<Core::Registers>;
+
+    enum class Encoding : u32 {
+        Raw,
+        Compressed,
+    };
+
+    [[nodiscard]] std::string_view as_string_view(std::span<std::byte const> const bytes) {
+        return std::string_view{ reinterpret_cast<char const*>(bytes.data()), bytes.size() };
+    }
+
+    [[nodiscard]] bool is_zero(std::span<std::byte const> const page) {
+        return std::ranges::all_of(page, [](std::byte const byte) { return byte == std::byte{ 0 }; });
+    }
+}  // namespace
+
+void SaveState::write(
+    std::filesystem::path const& path,
+    std::span<std::byte const> const memory,
+    std::span<Core::State const> const cores
+) {
+    auto const num_pages = (memory.size() + page_size - 1) / page_size;
+    auto const page = [&](usize const index) {
+        return memory.subspan(index * page_size, std::min(page_size, memory.size() - index * page_size));
+    };
+
+    // Pages with equal contents share one stored page.
+    auto pages = std::vector<u32>{};
+    pages.reserve(num_pages);
+    auto first_pages = std::vector<usize>{};  // Per stored page, the first page of memory with its contents.
+    auto stored_by_hash = std::unordered_multimap<usize, u32>{};
+    for (auto index = usize{ 0 }; index < num_pages; ++index) {
+        auto const contents = page(index);
+        if (is_zero(contents)) {
+            pages.push_back(zero_page);
+            continue;
+        }
+        auto const hash = std::hash<std::string_view>{}(as_string_view(contents));
+        auto const [begin, end] = stored_by_hash.equal_range(hash);
+        auto const duplicate = std::find_if(begin, end, [&](auto const& entry) {
+            return std::ranges::equal(page(first_pages[entry.second]), contents);
+        });
+        if (duplicate != end) {
+            pages.push_back(duplicate->second);
+            continue;
+        }
+        auto const stored = static_cast<u32>(first_pages.size());
+        first_pages.push_back(index);
+        stored_by_hash.emplace(hash, stored);
+        pages.push_back(stored);
+    }
+
+    auto writer = ByteWriter{};
+    writer.write(magic);
+    writer.write(format_version);
+    writer.write(u64{ memory.size() });
+    writer.write(u64{ page_size });
+    writer.write(u64{ cores.size() });
+    writer.write(u64{ num_registers });
+    writer.write(u64{ first_pages.size() });
+    for (auto const& core : cores) {
+        writer.write(u32{ core.instruction_pointer });
+        writer.write(u32{ core.is_halted });
+        for (auto const value : core.registers) {
+            writer.write(u32{ value });
+        }
+    }
+    for (auto const stored : pages) {
+        writer.write(stored);
+    }
+
+    auto data = std::vector<std::byte>{};
+    auto const data_offset = writer.bytes().size() + first_pages.size() * (sizeof(u64) + 2 * sizeof(u32));
+    for (auto const index : first_pages) {
+        auto const contents = page(index);
+        auto compressed = compress(contents);
+        auto const encoding = compressed.size() < contents.size() ? Encoding::Compressed : Encoding::Raw;
+        auto const stored = encoding == Encoding::Compressed ? std::span<std::byte const>{ compressed } : contents;
+        writer.write(u64{ data_offset + data.size() });
+        writer.write(static_cast<u32>(stored.size()));
+        writer.write(std::to_underlying(encoding));
+        data.insert(data.end(), stored.begin(), stored.end());
+    }
+    writer.write(data);
+
+    // Readers never see partial save states, and a failed write keeps the previous one.
+    if (not write_file_atomically(path, writer.bytes())) {
+        throw std::runtime_error{ fmt::format("Unable to write save state '{}'.", path.string()) };
+    }
+}
+
+[[nodiscard]] tl::expected<SaveState, std::string> SaveState::load(std::filesystem::path const& path) {
+    auto file = MappedFile::open(path);
+    if (not file.has_value()) {
+        return tl::unexpected{ fmt::format("Unable to read save state '{}'.", path.string()) };
+    }
+    auto result = SaveState{};
+    result.m_file = std::make_shared<MappedFile const>(std::move(file).value());
+    auto const bytes = result.m_file->bytes();
+    auto const malformed = [&] {
+        return tl::unexpected{ fmt::format("Malformed save state '{}'.", path.string()) };
+    };
+
+    auto reader = ByteReader{ bytes };
+    auto const file_magic = reader.read<u64>();
+    auto const file_format_version = reader.read<u64>();
+    if (not file_format_version.has_value() or file_magic.value() != magic) {
+        return malformed();
+    }
+    if (file_format_version.value() != format_version) {
+        return tl::unexpected{ fmt::format(
+            "Save state '{}' has format version {}, expected {}.",
+            path.string(),
+            file_format_version.value(),
+            format_version
+        ) };
+    }
+    auto const memory_size = reader.read<u64>();
+    auto const file_page_size = reader.read<u64>();
+    auto const num_cores = reader.read<u64>();
+    auto const file_num_registers = reader.read<u64>();
+    auto const num_stored_pages = reader.read<u64>();
+    if (not num_stored_pages.has_value() or file_page_size.value() != page_size
+        or file_num_registers.value() != num_registers or memory_size.value() < TextDevice::num_mapped_bytes
+        or memory_size.value() > std::numeric_limits<usize>::max() - page_size) {
+        return malformed();
+    }
+    result.m_memory_size = static_cast<usize>(memory_size.value());
+
+    // Every table entry takes at least four bytes, which bounds the counts by the file size before allocating.
+    auto const num_pages = (result.m_memory_size + page_size - 1) / page_size;
+    if (num_cores.value() > bytes.size() / sizeof(u32) or num_pages > bytes.size() / sizeof(u32)
+        or num_stored_pages.value() > bytes.size() / sizeof(u32)) {
+        return malformed();
+    }
+
+    result.m_cores.reserve(static_cast<usize>(num_cores.value()));
+    for (auto i = u64{ 0 }; i < num_cores.value(); ++i) {
+        auto const instruction_pointer = reader.read<u32>();
+        auto const is_halted = reader.read<u32>();
+        if (not is_halted.has_value() or is_halted.value() > 1) {
+            return malformed();
+        }
+        auto core = Core::State{ instruction_pointer.value(), is_halted.value() == 1, {} };
+        for (auto& value : core.registers) {
+            auto const register_value = reader.read<u32>();
+            if (not register_value.has_value()) {
+                return malformed();
+            }
+            value = register_value.value();
+        }
+        result.m_cores.push_back(core);
+    }
+
+    result.m_pages.reserve(num_pages);
+    for (auto i = usize{ 0 }; i < num_pages; ++i) {
+        auto const stored = reader.read<u32>();
+        if (not stored.has_value() or (stored.value() != zero_page and stored.value() >= num_stored_pages.value())) {
+            return malformed();
+        }
+        result.m_pages.push_back(stored.value());
+    }
+
+    result.m_stored_pages.reserve(static_cast<usize>(num_stored_pages.value()));
+    for (auto i = u64{ 0 }; i < num_stored_pages.value(); ++i) {
+        auto const offset = reader.read<u64>();
+        auto const size = reader.read<u32>();
+        auto const encoding = reader.read<u32>();
+        if (not encoding.has_value() or encoding.value() > std::to_underlying(Encoding::Compressed)
+            or offset.value() > bytes.size() or size.value() > bytes.size() - offset.value()
+            or (encoding.value() == std::to_underlying(Encoding::Raw) and size.value() > page_size)) {
+            return malformed();
+        }
+        result.m_stored_pages.push_back(StoredPage{
+            static_cast<usize>(offset.value()),
+            usize{ size.value() },
+            encoding.value() == std::to_underlying(Encoding::Compressed),
+        });
+    }
+    return result;
+}
+
+[[nodiscard]] SharedMemory::PageLoader SaveState::page_loader() const {
+    return [state = *this](usize const index, std::span<std::byte> const page) { state.load_page(index, page); };
+}
+
+void SaveState::load_page(usize const index, std::span<std::byte> const page) const {
+    auto const stored = m_pages.at(index);
+    if (stored == zero_page) {
+        return;
+    }
+    auto const& stored_page = m_stored_pages.at(stored);
+    auto const bytes = m_file->bytes().subspan(stored_page.offset, stored_page.size);
+    auto const is_valid = stored_page.is_compressed ? decompress(bytes, page) : bytes.size() == page.size();
+    if (not is_valid) {
+        throw std::runtime_error{ fmt::format("Page {} of the save state is corrupt.", index) };
+    }
+    if (not stored_page.is_compressed) {
+        std::ranges::copy(bytes, page.begin());
+    }
+}
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <common/memory.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <emulator/shared_memory.hpp>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    using WordBytes = std::array<std::byte, sizeof(Word)>;
+
+    [[nodiscard]] usize num_words_for(usize const num_bytes) {
+        return (num_bytes + sizeof(Word) - 1) / sizeof(Word);
+    }
+
+    // Replaces the bits of `mask` in the word with those of `bits`, leaving the others as they are.
+    void store_masked(std::atomic_ref<Word> const word, Word const bits, Word const mask) {
+        auto expected = word.load(std::memory_order_relaxed);
+        while (not word.compare_exchange_weak(
+            expected,
+            to_little_endian((from_little_endian(expected) & ~mask) | bits),
+            std::memory_order_relaxed,
+            std::memory_order_relaxed
+        )) { }
+    }
+}  // namespace
+
+void SharedMemory::Deallocate::operator()(Word* const words) const {
+    std::free(words);
+}
+
+// calloc() gets large blocks as fresh pages from the OS, which are zero already, instead of clearing them. So
+// only the pages that are actually used are ever touched.
+[[nodiscard]] SharedMemory::SharedMemory(usize const size)
+    : m_size{ size },
+      m_words{ static_cast<Word*>(std::calloc(std::max(num_words_for(size), usize{ 1 }), sizeof(Word))) } {
+    if (m_words == nullptr) {
+        throw std::bad_alloc{};
+    }
+}
+
+[[nodiscard]] SharedMemory::SharedMemory(usize const size, PageLoader page_loader) : SharedMemory{ size } {
+    if (not page_loader) {
+        throw std::invalid_argument{ "Page loader must not be empty." };
+    }
+    m_page_loader = std::move(page_loader);
+    m_page_states = std::make_unique<std::atomic<PageState>[]>(num_pages());
+}
+
+void SharedMemory::read(usize const address, std::span<std::byte> const output) const {
+    check_bounds(address, output.size());
+    make_resident(address, output.size());
+    // Loads a few words at a time and copies the requested bytes out of their in-memory representation.
+    auto words = std::array<Word, 4>{};
+    auto const end = num_words_for(address + output.size());
+    auto offset = address % sizeof(Word);
+    auto written = usize{ 0 };
+    for (auto index = address / sizeof(Word); index < end; index += words.size()) {
+        auto const num_words = std::min(words.size(), end - index);
+        for (auto i = usize{ 0 }; i < num_words; ++i) {
+            words[i] = word(index + i).load(std::memory_order_relaxed);
+        }
+        auto const count = std::min(num_words * sizeof(Word) - offset, output.size() - written);
+        std::memcpy(output.data() + written, std::as_bytes(std::span{ words }).data() + offset, count);
+        written += count;
+        offset = 0;
+    }
+}
+
+[[nodiscard]] Word SharedMemory::load_unaligned(usize const address) const {
+    auto bytes = WordBytes{};
+    read(address, bytes);
+    return load_little_endian<Word>(bytes.data());
+}
+
+void SharedMemory::store_unaligned(usize const address, Word const value) {
+    check_bounds(address, sizeof(Word));
+    make_resident(address, sizeof(Word));
+    // The value spans two words. Merging it into each of them with a compare-and-swap never loses concurrent
+    // stores to their other bytes, and every access to a word stays an atomic access of the whole word.
+    auto const index = address / sizeof(Word);
+    auto const shift = address % sizeof(Word) * 8;
+    auto const bits = u64{ value } << shift;
+    auto const mask = u64{ std::numeric_limits<Word>::max() } << shift;
+    store_masked(word(index), static_cast<Word>(bits), static_cast<Word>(mask));
+    store_masked(word(index + 1), static_cast<Word>(bits >> 32), static_cast<Word>(mask >> 32));
+}
+
+Word SharedMemory::fetch_add(usize const address, Word const value) {
+    if (address % sizeof(Word) != 0) {
+        throw std::invalid_argument{ "Unaligned atomic access." };
+    }
+    check_bounds(address, sizeof(Word));
+    make_resident(address, sizeof(Word));
+    auto const target = word(address / sizeof(Word));
+    if constexpr (std::endian::native == std::endian::little) {
+        return target.fetch_add(value, std::memory_order_seq_cst);
+    } else {
+        auto expected = target.load(std::memory_order_relaxed);
+        while (not target.compare_exchange_weak(
+            expected,
+            to_little_endian(from_little_endian(expected) + value),
+            std::memory_order_seq_cst,
+            std::memory_order_relaxed
+        )) { }
+        return from_little_endian(expected);
+    }
+}
+
+void SharedMemory::load_pages(usize const address, usize const size) const {
+    if (size == 0) {
+        return;
+    }
+    for (auto index = address / page_size; index <= (address + size - 1) / page_size; ++index) {
+        if (m_page_states[index].load(std::memory_order_acquire) != PageState::Loaded) {
+            load_page(index);
+        }
+    }
+}
+
+void SharedMemory::load_page(usize const index) const {
+    auto& state = m_page_states[index];
+    auto current = state.load(std::memory_order_acquire);
+    while (current != PageState::Loaded) {
+        if (current == PageState::Loading) {
+            state.wait(PageState::Loading, std::memory_order_acquire);
+            current = state.load(std::memory_order_acquire);
+            continue;
+        }
+        if (not state.compare_exchange_weak(current, PageState::Loading, std::memory_order_acquire)) {
+            continue;
+        }
+        // Nobody else accesses the page until it is loaded, so it can be written without atomics.
+        auto const offset = index * page_size;
+        auto const first_byte = reinterpret_cast<std::byte*>(m_words.get()) + offset;
+        auto const page = std::span{ first_byte, std::min(page_size, m_size - offset) };
+        try {
+            m_page_loader(index, page);
+        } catch (...) {
+            std::ranges::fill(page, std::byte{ 0 });  // The next attempt starts from zeros again.
+            state.store(PageState::Missing, std::memory_order_release);
+            state.notify_all();
+            throw;
+        }
+        state.store(PageState::Loaded, std::memory_order_release);
+        state.notify_all();
+        return;
+    }
+}
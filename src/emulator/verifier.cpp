@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <array>
+#include <emulator/text_device.hpp>
+#include <emulator/verifier.hpp>
+#include <lib2k/overloaded.hpp>
+#include <magic_enum.hpp>
+#include <tl/optional.hpp>
+#include <utility>
+
+namespace {
+    // What is known about the registers when entering a block. Every core starts with all registers zero.
+    using RegisterValues = std::array<tl::optional<Word>, magic_enum::enum_count<Register>()>;
+
+    // Keeps the values both sides agree on. Returns whether `values` changed.
+    bool merge(RegisterValues& values, RegisterValues const& incoming) {
+        auto changed = false;
+        for (auto i = usize{ 0 }; i < values.size(); ++i) {
+            if (values[i].has_value() and (not incoming[i].has_value() or incoming[i].value() != values[i].value())) {
+                values[i] = tl::nullopt;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    void apply(InstructionStore const& instructions, usize const index, RegisterValues& values) {
+        instructions.visit(
+            index,
+            c2k::Overloaded{
+                [&](MoveImmediateIntoRegister const& move) {
+                    values.at(std::to_underlying(move.register_)) = move.immediate;
+                },
+                [](auto const&) {},
+            }
+        );
+    }
+
+    // Applies all instructions of the block to the values at its start.
+    void apply(ControlFlowGraph const& graph, ControlFlowGraph::BasicBlock const& block, RegisterValues& values) {
+        for (auto i = block.first_node; i < block.first_node + block.num_nodes; ++i) {
+            apply(graph.instructions(), i, values);
+        }
+    }
+
+    // Computes the register values at the start of every reachable block.
+    [[nodiscard]] std::vector<tl::optional<RegisterValues>> propagate_registers(ControlFlowGraph const& graph) {
+        auto entry_values = std::vector<tl::optional<RegisterValues>>(graph.blocks().size());
+        auto worklist = std::vector<usize>{};
+        auto const enter = [&](usize const block, RegisterValues const& values) {
+            auto& known = entry_values.at(block);
+            if (not known.has_value()) {
+                known = values;
+                worklist.push_back(block);
+            } else if (merge(known.value(), values)) {
+                worklist.push_back(block);
+            }
+        };
+
+        auto zeros = RegisterValues{};
+        zeros.fill(Word{ 0 });
+        for (auto const block : graph.entry_blocks()) {
+            if (block != ControlFlowGraph::none) {
+                enter(block, zeros);
+            }
+        }
+        while (not worklist.empty()) {
+            auto const block = worklist.back();
+            worklist.pop_back();
+            auto values = entry_values.at(block).value();
+            apply(graph, graph.blocks()[block], values);
+            for (auto const successor : graph.blocks()[block].successors) {
+                enter(successor, values);
+            }
+        }
+        return entry_values;
+    }
+
+    class Checker final {
+    private:
+        ControlFlowGraph const* m_graph;
+        usize m_memory_size;
+        std::vector<VerifiedProgram::Error>* m_errors;
+
+    public:
+        [[nodiscard]] Checker(
+            ControlFlowGraph const& graph,
+            usize const memory_size,
+            std::vector<VerifiedProgram::Error>& errors
+        )
+            : m_graph{ &graph }, m_memory_size{ memory_size }, m_errors{ &errors } {}
+
+        void check(usize const node_index, RegisterValues const& values) const {
+            auto const& node = m_graph->nodes()[node_index];
+            m_graph->instructions().visit(
+                node_index,
+                c2k::Overloaded{
+                    [&](MoveImmediateIntoMemory const& instruction) {
+                        check_access(node.address, instruction.pointer, values, false);
+                    },
+                    [&](AtomicAddImmediateToMemory const& instruction) {
+                        check_access(node.address, instruction.pointer, values, true);
+                    },
+                    [](auto const&) {},
+                }
+            );
+        }
+
+    private:
+        void check_access(
+            Word const address,
+            Pointer const pointer,
+            RegisterValues const& values,
+            bool const is_atomic
+        ) const {
+            auto const target = values.at(std::to_underlying(pointer.register_()));
+            if (not target.has_value()) {
+                fail(address, fmt::format("The address in register {} is not known.", pointer.register_()));
+                return;
+            }
+            if (target.value() > m_memory_size or m_memory_size - target.value() < sizeof(Word)) {
+                fail(address, fmt::format("Memory access at 0x{:08x} is out of bounds.", target.value()));
+                return;
+            }
+            if (is_atomic and target.value() % sizeof(Word) != 0) {
+                fail(address, fmt::format("Unaligned atomic access at 0x{:08x}.", target.value()));
+            }
+            for (auto byte = target.value(); byte < target.value() + sizeof(Word); ++byte) {
+                if (auto const overwritten = m_graph->find(byte); overwritten.has_value()) {
+                    fail(
+                        address,
+                        fmt::format(
+                            "Store at 0x{:08x} overwrites the instruction at 0x{:08x}.",
+                            target.value(),
+                            m_graph->nodes()[overwritten.value()].address
+                        )
+                    );
+                    return;
+                }
+            }
+        }
+
+        void fail(Word const address, std::string message) const {
+            m_errors->push_back(VerifiedProgram::Error{ address, std::move(message) });
+        }
+    };
+}  // namespace
+
+[[nodiscard]] tl::expected<VerifiedProgram, std::vector<VerifiedProgram::Error>> VerifiedProgram::verify(
+    std::span<std::byte const> const program,
+    std::span<Word const> const entry_points
+) {
+    // The memory of a machine, with the devices in front of the program.
+    auto memory = std::vector<std::byte>(TextDevice::num_mapped_bytes + program.size());
+    std::ranges::copy(program, memory.begin() + TextDevice::num_mapped_bytes);
+    auto graph = ControlFlowGraph::build(memory, 0, entry_points);
+
+    auto errors = std::vector<Error>{};
+    for (auto const& failure : graph.decode_failures()) {
+        errors.push_back(Error{ failure.address, failure.message });
+    }
+
+    auto const entry_values = propagate_registers(graph);
+    auto const checker = Checker{ graph, memory.size(), errors };
+    for (auto block = usize{ 0 }; block < graph.blocks().size(); ++block) {
+        if (not entry_values.at(block).has_value()) {
+            continue;
+        }
+        auto const& basic_block = graph.blocks()[block];
+        auto values = entry_values.at(block).value();
+        for (auto i = basic_block.first_node; i < basic_block.first_node + basic_block.num_nodes; ++i) {
+            checker.check(i, values);
+            apply(graph.instructions(), i, values);
+        }
+    }
+
+    if (not errors.empty()) {
+        std::ranges::stable_sort(errors, {}, &Error::address);
+        return tl::unexpected{ std::move(errors) };
+    }
+    return VerifiedProgram{
+        std::vector(program.begin(), program.end()),
+        std::vector(entry_points.begin(), entry_points.end()),
+        std::move(graph),
+    };
+}
+
+[[nodiscard]] tl::expected<VerifiedProgram, std::vector<VerifiedProgram::Error>> VerifiedProgram::verify(
+    std::span<std::byte const> const program
+) {
+    return verify(program, std::array{ static_cast<Word>(TextDevice::num_mapped_bytes) });
+}
+
+[[nodiscard]] std::vector<Word> VerifiedProgram::hot_loop_candidates() const {
+    auto result = std::vector<Word>{};
+    for (auto const& block : m_control_flow_graph.blocks()) {
+        if (block.is_loop_header) {
+            result.push_back(m_control_flow_graph.nodes()[block.first_node].address);
+        }
+    }
+    std::ranges::sort(result);
+    return result;
+}
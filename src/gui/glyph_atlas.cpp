@@ -0,0 +1,93 @@
+#include <cmath>
+#include <fmt/format.h>
+#include <ft2build.h>
+#include <gui/glyph_atlas.hpp>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include FT_FREETYPE_H
+
+namespace {
+    struct LibraryDeleter final {
+        void operator()(FT_Library const library) const {
+            FT_Done_FreeType(library);
+        }
+    };
+
+    struct FaceDeleter final {
+        void operator()(FT_Face const face) const {
+            FT_Done_Face(face);
+        }
+    };
+
+    using Library = std::unique_ptr<std::remove_pointer_t<FT_Library>, LibraryDeleter>;
+    using Face = std::unique_ptr<std::remove_pointer_t<FT_Face>, FaceDeleter>;
+
+    // The same hinting that sf::Font uses, so that glyphs look like sf::Text would draw them.
+    constexpr auto load_flags = FT_LOAD_RENDER | FT_LOAD_TARGET_NORMAL | FT_LOAD_FORCE_AUTOHINT;
+
+    // FreeType measures in 1/64 pixels.
+    [[nodiscard]] unsigned to_pixels(FT_Pos const value) {
+        return static_cast<unsigned>(std::ceil(static_cast<double>(value) / 64.0));
+    }
+}  // namespace
+
+[[nodiscard]] GlyphAtlas::GlyphAtlas(std::filesystem::path const& font_path, unsigned const character_size) {
+    auto library_handle = FT_Library{};
+    if (FT_Init_FreeType(&library_handle) != 0) {
+        throw std::runtime_error{ "Unable to initialize FreeType." };
+    }
+    auto const library = Library{ library_handle };
+
+    auto face_handle = FT_Face{};
+    if (FT_New_Face(library.get(), font_path.string().c_str(), 0, &face_handle) != 0) {
+        throw std::runtime_error{ fmt::format("Unable to load font {}.", font_path.string()) };
+    }
+    auto const face = Face{ face_handle };
+    if (FT_Set_Pixel_Sizes(face.get(), 0, character_size) != 0) {
+        throw std::runtime_error{ fmt::format("Font {} has no size {}.", font_path.string(), character_size) };
+    }
+
+    // The font is monospaced, so the advance of any glyph determines the cell width. The line
+    // spacing matches what sf::Text would use to lay out multiple rows.
+    if (FT_Load_Char(face.get(), U'M', load_flags) != 0) {
+        throw std::runtime_error{ fmt::format("Unable to rasterise font {}.", font_path.string()) };
+    }
+    m_cell_size = sf::Vector2u{
+        to_pixels(face->glyph->advance.x),
+        to_pixels(face->size->metrics.height),
+    };
+
+    auto const atlas_size = sf::Vector2u{
+        m_cell_size.x * static_cast<unsigned>(num_tile_columns),
+        m_cell_size.y * static_cast<unsigned>(num_tile_rows),
+    };
+    m_image = sf::Image{ atlas_size, sf::Color::Transparent };
+
+    for (auto index = usize{ 0 }; index < num_tile_columns * num_tile_rows; ++index) {
+        auto const c = static_cast<char>(index);
+        if (not is_printable(c) or FT_Load_Char(face.get(), static_cast<FT_ULong>(c), load_flags) != 0) {
+            continue;
+        }
+        // Like sf::Text, which puts the baseline one character size below the top of the text. Parts of
+        // the glyph outside of its tile are cut off.
+        auto const& bitmap = face->glyph->bitmap;
+        auto const left = i64{ face->glyph->bitmap_left };
+        auto const top = i64{ character_size } - face->glyph->bitmap_top;
+        auto const tile = tile_position(c);
+        for (auto y = i64{ 0 }; y < i64{ bitmap.rows }; ++y) {
+            for (auto x = i64{ 0 }; x < i64{ bitmap.width }; ++x) {
+                auto const cell_x = left + x;
+                auto const cell_y = top + y;
+                if (cell_x < 0 or cell_x >= i64{ m_cell_size.x } or cell_y < 0 or cell_y >= i64{ m_cell_size.y }) {
+                    continue;
+                }
+                auto const coverage = bitmap.buffer[y * bitmap.pitch + x];
+                m_image.setPixel(
+                    sf::Vector2u{ tile.x + static_cast<unsigned>(cell_x), tile.y + static_cast<unsigned>(cell_y) },
+                    sf::Color{ 255, 255, 255, coverage }
+                );
+            }
+        }
+    }
+}
@@ -1,40 +1,66 @@
-#include <fmt/format.h>
 #include <gui/gui.hpp>
-#include <ranges>
+#include <stdexcept>
 
-[[nodiscard]] Gui::Gui()
+[[nodiscard]] Gui::Gui(FramePacing const pacing)
     : m_window{ sf::VideoMode{ { 1024, 768 } },
                 "Inherently Unsafe Backseat System 2k",
-                sf::Style::Titlebar | sf::Style::Close } {
-    static constexpr auto font_path = "resources/fonts/JetBrainsMono-Regular.ttf";
-    if (not m_font.openFromFile(font_path)) {
-        throw std::runtime_error{ fmt::format("Unable to load font {}.", font_path) };
+                sf::Style::Titlebar | sf::Style::Close },
+      m_atlas{},
+      m_text_renderer{ m_atlas },
+      m_next_frame{ SteadyClock::now() } {
+    if (pacing.frames_per_second == 0) {
+        throw std::invalid_argument{ "Frame rate must not be zero." };
     }
+    m_frame_duration = std::chrono::duration_cast<Duration>(std::chrono::seconds{ 1 }) / pacing.frames_per_second;
+
+    // Frames are paced by the caller (see next_frame()) instead of sf::Window::setFramerateLimit(),
+    // since the latter would sleep inside display() and waste time that could be used for emulation.
+    m_window.setVerticalSyncEnabled(pacing.vertical_sync);
 }
 
 void Gui::update(Emulator const& emulator) {
+    schedule_next_frame();
+
+    if (not m_window.isOpen()) {
+        m_is_running = false;
+        return;
+    }
+
+    process_events();
     if (not m_window.isOpen()) {
         m_is_running = false;
         return;
     }
 
+    if (m_text_renderer.update(emulator.text_device())) {
+        m_needs_redraw = true;
+    }
+    if (not m_needs_redraw) {
+        return;
+    }
+
+    m_window.clear(sf::Color::Black);
+    m_window.draw(m_text_renderer);
+    m_window.display();
+    m_needs_redraw = false;
+}
+
+void Gui::process_events() {
     while (auto const event = m_window.pollEvent()) {
         if (event->is<sf::Event::Closed>()) {
             m_window.close();
+            return;
         }
+        // The window contents may have been damaged. Without knowing better, we redraw.
+        m_needs_redraw = true;
     }
+}
 
-    m_window.clear(sf::Color::Black);
-
-    auto const& text_device = emulator.text_device();
-
-    auto const text_contents = text_device.text()
-                               | std::views::transform([](char const c) { return c == '\0' ? ' ' : c; })
-                               | std::ranges::to<std::string>();
-
-    auto const text = sf::Text{ m_font, text_contents, 20 };
-
-    m_window.draw(text);
-
-    m_window.display();
+void Gui::schedule_next_frame() {
+    auto const now = SteadyClock::now();
+    m_next_frame += m_frame_duration;
+    if (m_next_frame <= now) {
+        // We fell behind. Don't try to catch up with a burst of frames.
+        m_next_frame = now + m_frame_duration;
+    }
 }
@@ -0,0 +1,52 @@
+#include <algorithm>
+#include <gui/headless_renderer.hpp>
+
+[[nodiscard]] HeadlessRenderer::HeadlessRenderer(std::filesystem::path const& font_path, unsigned const character_size)
+    : m_atlas{ font_path, character_size },
+      m_tiles_stride{ m_atlas.image().getSize().x * Image::num_channels },
+      m_frame{ m_atlas.cell_size().x * TextDevice::num_columns, m_atlas.cell_size().y * TextDevice::num_rows } {
+    // The Gui draws the white glyphs of the atlas with alpha blending onto a black background, so
+    // the resulting color is the atlas color multiplied by its alpha.
+    auto const& atlas_image = m_atlas.image();
+    auto const num_pixels = usize{ atlas_image.getSize().x } * atlas_image.getSize().y;
+    auto const rgba = atlas_image.getPixelsPtr();
+    m_tiles.resize(num_pixels * Image::num_channels);
+    for (auto i = usize{ 0 }; i < num_pixels; ++i) {
+        auto const alpha = rgba[i * 4 + 3];
+        for (auto channel = usize{ 0 }; channel < Image::num_channels; ++channel) {
+            m_tiles[i * Image::num_channels + channel] = static_cast<u8>(rgba[i * 4 + channel] * alpha / 255);
+        }
+    }
+
+    // The frame starts out black, which is exactly what '\0' cells look like.
+}
+
+[[nodiscard]] Image const& HeadlessRenderer::render(TextDevice const& text_device) {
+    for (auto row = usize{ 0 }; row < TextDevice::num_rows; ++row) {
+        auto const contents = text_device.row(row);
+        for (auto column = usize{ 0 }; column < TextDevice::num_columns; ++column) {
+            auto const cell_index = row * TextDevice::num_columns + column;
+            auto const c = contents[column];
+            if (c == m_cells[cell_index]) {
+                continue;
+            }
+            m_cells[cell_index] = c;
+            blit(column, row, c);
+        }
+    }
+    return m_frame;
+}
+
+void HeadlessRenderer::blit(usize const column, usize const row, char const c) {
+    auto const cell_size = m_atlas.cell_size();
+    auto const tile_position = m_atlas.tile_position(c);
+    auto const row_length = cell_size.x * Image::num_channels;
+    for (auto y = usize{ 0 }; y < cell_size.y; ++y) {
+        auto const source = m_tiles.begin()
+                            + static_cast<std::ptrdiff_t>(
+                                (tile_position.y + y) * m_tiles_stride + tile_position.x * Image::num_channels
+                            );
+        auto const destination = m_frame.row(row * cell_size.y + y).subspan(column * row_length, row_length);
+        std::copy_n(source, row_length, destination.begin());
+    }
+}
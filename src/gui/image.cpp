@@ -0,0 +1,173 @@
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cctype>
+#include <fmt/format.h>
+#include <fstream>
+#include <gui/image.hpp>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    [[nodiscard]] bool is_ppm(std::filesystem::path const& path) {
+        return path.extension() == ".ppm";
+    }
+
+    // Reads the next whitespace-separated header field of a PPM file, skipping comments.
+    [[nodiscard]] usize read_ppm_header_field(std::istream& stream, std::filesystem::path const& path) {
+        while (true) {
+            auto const c = stream.peek();
+            if (c == '#') {
+                auto comment = std::string{};
+                std::getline(stream, comment);
+            } else if (std::isspace(c)) {
+                stream.get();
+            } else {
+                break;
+            }
+        }
+        auto value = usize{ 0 };
+        if (not(stream >> value)) {
+            throw std::runtime_error{ fmt::format("Invalid PPM header in {}.", path.string()) };
+        }
+        return value;
+    }
+
+    [[nodiscard]] Image load_ppm(std::filesystem::path const& path) {
+        auto stream = std::ifstream{ path, std::ios::binary };
+        if (not stream) {
+            throw std::runtime_error{ fmt::format("Unable to open {}.", path.string()) };
+        }
+        auto magic = std::array<char, 2>{};
+        if (not stream.read(magic.data(), magic.size()) or magic != std::array{ 'P', '6' }) {
+            throw std::runtime_error{ fmt::format("{} is not a binary PPM file.", path.string()) };
+        }
+        auto const width = read_ppm_header_field(stream, path);
+        auto const height = read_ppm_header_field(stream, path);
+        auto const max_value = read_ppm_header_field(stream, path);
+        if (max_value != 255) {
+            throw std::runtime_error{ fmt::format("Unsupported PPM color depth in {}.", path.string()) };
+        }
+        stream.get();  // Single whitespace character after the header.
+
+        auto image = Image{ width, height };
+        for (auto y = usize{ 0 }; y < height; ++y) {
+            auto const row = image.row(y);
+            if (not stream.read(reinterpret_cast<char*>(row.data()), static_cast<std::streamsize>(row.size()))) {
+                throw std::runtime_error{ fmt::format("Unexpected end of file in {}.", path.string()) };
+            }
+        }
+        return image;
+    }
+
+    void save_ppm(Image const& image, std::filesystem::path const& path) {
+        auto stream = std::ofstream{ path, std::ios::binary };
+        if (not stream) {
+            throw std::runtime_error{ fmt::format("Unable to open {} for writing.", path.string()) };
+        }
+        auto const header = fmt::format("P6\n{} {}\n255\n", image.width(), image.height());
+        stream.write(header.data(), static_cast<std::streamsize>(header.size()));
+        stream.write(
+            reinterpret_cast<char const*>(image.pixels().data()),
+            static_cast<std::streamsize>(image.pixels().size())
+        );
+        if (not stream) {
+            throw std::runtime_error{ fmt::format("Unable to write {}.", path.string()) };
+        }
+    }
+
+    [[nodiscard]] u8 channel_difference(u8 const lhs, u8 const rhs) {
+        return static_cast<u8>(lhs > rhs ? lhs - rhs : rhs - lhs);
+    }
+}  // namespace
+
+[[nodiscard]] Image::Image(usize const width, usize const height)
+    : m_width{ width }, m_height{ height }, m_pixels(width * height * num_channels) {}
+
+[[nodiscard]] Image Image::load(std::filesystem::path const& path) {
+    if (is_ppm(path)) {
+        return load_ppm(path);
+    }
+
+    auto sfml_image = sf::Image{};
+    if (not sfml_image.loadFromFile(path)) {
+        throw std::runtime_error{ fmt::format("Unable to load image {}.", path.string()) };
+    }
+    auto const size = sfml_image.getSize();
+    auto image = Image{ size.x, size.y };
+    auto const rgba = sfml_image.getPixelsPtr();
+    for (auto i = usize{ 0 }; i < image.m_pixels.size() / num_channels; ++i) {
+        std::copy_n(rgba + i * 4, num_channels, image.m_pixels.begin() + static_cast<std::ptrdiff_t>(i * num_channels));
+    }
+    return image;
+}
+
+void Image::save(std::filesystem::path const& path) const {
+    if (is_ppm(path)) {
+        save_ppm(*this, path);
+        return;
+    }
+
+    auto rgba = std::vector<u8>{};
+    rgba.reserve(m_width * m_height * 4);
+    for (auto i = usize{ 0 }; i < m_pixels.size(); i += num_channels) {
+        auto const pixel = m_pixels.begin() + static_cast<std::ptrdiff_t>(i);
+        rgba.insert(rgba.end(), pixel, pixel + num_channels);
+        rgba.push_back(255);
+    }
+    auto const sfml_image =
+        sf::Image{ sf::Vector2u{ static_cast<unsigned>(m_width), static_cast<unsigned>(m_height) }, rgba.data() };
+    if (not sfml_image.saveToFile(path)) {
+        throw std::runtime_error{ fmt::format("Unable to save image {}.", path.string()) };
+    }
+}
+
+[[nodiscard]] ImageDifference compare(Image const& actual, Image const& expected, u8 const tolerance) {
+    if (actual.width() != expected.width() or actual.height() != expected.height()) {
+        return ImageDifference{ .sizes_match = false, .num_differing_pixels = 0, .max_channel_difference = 0 };
+    }
+
+    auto result = ImageDifference{ .sizes_match = true, .num_differing_pixels = 0, .max_channel_difference = 0 };
+    auto const lhs = actual.pixels();
+    auto const rhs = expected.pixels();
+    for (auto i = usize{ 0 }; i < lhs.size(); i += Image::num_channels) {
+        auto pixel_difference = u8{ 0 };
+        for (auto channel = usize{ 0 }; channel < Image::num_channels; ++channel) {
+            pixel_difference = std::max(pixel_difference, channel_difference(lhs[i + channel], rhs[i + channel]));
+        }
+        result.max_channel_difference = std::max(result.max_channel_difference, pixel_difference);
+        if (pixel_difference > tolerance) {
+            ++result.num_differing_pixels;
+        }
+    }
+    return result;
+}
+
+[[nodiscard]] Image difference_image(Image const& actual, Image const& expected, u8 const tolerance) {
+    if (actual.width() != expected.width() or actual.height() != expected.height()) {
+        throw std::invalid_argument{ "Images must have the same size." };
+    }
+
+    auto result = Image{ actual.width(), actual.height() };
+    for (auto y = usize{ 0 }; y < actual.height(); ++y) {
+        for (auto x = usize{ 0 }; x < actual.width(); ++x) {
+            auto const lhs = actual.pixel(x, y);
+            auto const rhs = expected.pixel(x, y);
+            auto differs = false;
+            for (auto channel = usize{ 0 }; channel < Image::num_channels; ++channel) {
+                differs = differs or channel_difference(lhs[channel], rhs[channel]) > tolerance;
+            }
+            if (differs) {
+                result.set_pixel(x, y, Image::Pixel{ 255, 0, 0 });
+            } else {
+                auto const dimmed = Image::Pixel{
+                    static_cast<u8>(lhs[0] / 4),
+                    static_cast<u8>(lhs[1] / 4),
+                    static_cast<u8>(lhs[2] / 4),
+                };
+                result.set_pixel(x, y, dimmed);
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <filesystem>
+#include <lib2k/types.hpp>
+
+// Every possible byte value gets a tile of the same size in a 16x16 grid. Glyphs are rasterised
+// exactly once. Drawing a character afterwards is only a matter of choosing the right texture
+// coordinates. Non-printable characters (including '\0') map to empty tiles.
+//
+// The atlas is rasterised on the CPU with FreeType, hinted like sf::Font does it, so building it needs
+// no OpenGL context. It is white, with the coverage of the glyphs in the alpha channel.
+class GlyphAtlas final {
+public:
+    static constexpr auto num_tile_columns = usize{ 16 };
+    static constexpr auto num_tile_rows = usize{ 16 };
+    static constexpr auto default_font_path = "resources/fonts/JetBrainsMono-Regular.ttf";
+    static constexpr auto default_character_size = 20u;
+
+private:
+    sf::Image m_image;
+    sf::Vector2u m_cell_size;
+
+public:
+    [[nodiscard]] explicit GlyphAtlas(
+        std::filesystem::path const& font_path = default_font_path,
+        unsigned character_size = default_character_size
+    );
+
+    [[nodiscard]] sf::Image const& image() const {
+        return m_image;
+    }
+
+    [[nodiscard]] sf::Vector2u cell_size() const {
+        return m_cell_size;
+    }
+
+    [[nodiscard]] sf::Vector2u tile_position(char const c) const {
+        auto const index = static_cast<unsigned char>(c);
+        return sf::Vector2u{
+            static_cast<unsigned>(index % num_tile_columns) * m_cell_size.x,
+            static_cast<unsigned>(index / num_tile_columns) * m_cell_size.y,
+        };
+    }
+
+    [[nodiscard]] static bool is_printable(char const c) {
+        return c >= 0x20 and c < 0x7F;
+    }
+};
@@ -1,20 +1,57 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <chrono>
 #include <emulator/emulator.hpp>
+#include "glyph_atlas.hpp"
+#include "text_renderer.hpp"
+
+struct FramePacing final {
+    unsigned frames_per_second = 60;
+    bool vertical_sync = false;
+};
 
 class Gui final {
+public:
+    using SteadyClock = std::chrono::steady_clock;
+    using TimePoint = SteadyClock::time_point;
+    using Duration = SteadyClock::duration;
+
 private:
     sf::RenderWindow m_window;
-    sf::Font m_font;
+    GlyphAtlas m_atlas;
+    TextRenderer m_text_renderer;
+    Duration m_frame_duration;
+    TimePoint m_next_frame;
+    bool m_needs_redraw = true;
     bool m_is_running = true;
 
 public:
-    [[nodiscard]] Gui();
+    [[nodiscard]] explicit Gui(FramePacing pacing = {});
+
+    // The text renderer points at the atlas, which would dangle in a copied or moved-to Gui.
+    Gui(Gui const& other) = delete;
+    Gui(Gui&& other) = delete;
+    Gui& operator=(Gui const& other) = delete;
+    Gui& operator=(Gui&& other) = delete;
+    ~Gui() = default;
 
+    // Handles pending window events and presents a new frame if (and only if) the screen contents
+    // changed or an event arrived since the last presented frame.
     void update(Emulator const& emulator);
 
+    // The point in time when update() should be called next. The time until then is free to be
+    // spent on emulation.
+    [[nodiscard]] TimePoint next_frame() const {
+        return m_next_frame;
+    }
+
     [[nodiscard]] bool is_running() const {
         return m_is_running;
     }
+
+private:
+    void process_events();
+
+    void schedule_next_frame();
 };
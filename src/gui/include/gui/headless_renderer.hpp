@@ -0,0 +1,31 @@
+#pragma once
+
+#include <array>
+#include <emulator/text_device.hpp>
+#include <filesystem>
+#include <vector>
+#include "glyph_atlas.hpp"
+#include "image.hpp"
+
+// Renders the text display into an Image on the CPU, using the same glyph atlas (and therefore the
+// same font rasterisation) as the Gui. Needs neither a window nor an OpenGL context. Only cells that
+// changed since the previous frame are copied, which makes rendering long sequences of frames cheap.
+class HeadlessRenderer final {
+private:
+    GlyphAtlas m_atlas;
+    std::vector<u8> m_tiles;  // The atlas, composited onto black in the same way the Gui does it.
+    usize m_tiles_stride;
+    Image m_frame;
+    std::array<char, TextDevice::num_mapped_bytes> m_cells{};
+
+public:
+    [[nodiscard]] explicit HeadlessRenderer(
+        std::filesystem::path const& font_path = GlyphAtlas::default_font_path,
+        unsigned character_size = GlyphAtlas::default_character_size
+    );
+
+    [[nodiscard]] Image const& render(TextDevice const& text_device);
+
+private:
+    void blit(usize column, usize row, char c);
+};
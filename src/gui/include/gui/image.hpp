@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <lib2k/types.hpp>
+#include <span>
+#include <vector>
+
+// 8-bit RGB image without any dependency on a graphics context.
+class Image final {
+public:
+    static constexpr auto num_channels = usize{ 3 };
+    using Pixel = std::array<u8, num_channels>;
+
+private:
+    usize m_width;
+    usize m_height;
+    std::vector<u8> m_pixels;
+
+public:
+    [[nodiscard]] Image(usize width, usize height);
+
+    [[nodiscard]] usize width() const {
+        return m_width;
+    }
+
+    [[nodiscard]] usize height() const {
+        return m_height;
+    }
+
+    [[nodiscard]] std::span<u8> row(usize const y) {
+        return std::span{ m_pixels }.subspan(y * m_width * num_channels, m_width * num_channels);
+    }
+
+    [[nodiscard]] std::span<u8 const> row(usize const y) const {
+        return std::span{ m_pixels }.subspan(y * m_width * num_channels, m_width * num_channels);
+    }
+
+    [[nodiscard]] Pixel pixel(usize const x, usize const y) const {
+        auto const offset = (x + y * m_width) * num_channels;
+        return Pixel{ m_pixels[offset], m_pixels[offset + 1], m_pixels[offset + 2] };
+    }
+
+    void set_pixel(usize const x, usize const y, Pixel const pixel) {
+        auto const offset = (x + y * m_width) * num_channels;
+        std::ranges::copy(pixel, m_pixels.begin() + static_cast<std::ptrdiff_t>(offset));
+    }
+
+    [[nodiscard]] std::span<u8 const> pixels() const {
+        return m_pixels;
+    }
+
+    // The file format is chosen by extension: ".ppm" (binary P6) is handled directly, everything
+    // else is delegated to SFML (e.g. ".png"). Throws std::runtime_error on failure.
+    [[nodiscard]] static Image load(std::filesystem::path const& path);
+
+    void save(std::filesystem::path const& path) const;
+
+    [[nodiscard]] friend bool operator==(Image const& lhs, Image const& rhs) = default;
+};
+
+struct ImageDifference final {
+    bool sizes_match;
+    usize num_differing_pixels;
+    u8 max_channel_difference;
+
+    [[nodiscard]] bool is_within_tolerance() const {
+        return sizes_match and num_differing_pixels == 0;
+    }
+};
+
+// Pixels whose channels all differ by at most `tolerance` are considered equal.
+[[nodiscard]] ImageDifference compare(Image const& actual, Image const& expected, u8 tolerance = 0);
+
+// Visualises the difference between two images of the same size. Matching pixels are dimmed,
+// differing pixels are drawn in red.
+[[nodiscard]] Image difference_image(Image const& actual, Image const& expected, u8 tolerance = 0);
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <emulator/text_device.hpp>
+#include "glyph_atlas.hpp"
+
+// Draws the contents of a TextDevice as one persistent vertex array with one quad per cell. Cell
+// positions never change, so updating the screen only touches the texture coordinates of cells
+// whose contents differ from the previous update.
+class TextRenderer final : public sf::Drawable {
+private:
+    static constexpr auto vertices_per_cell = usize{ 6 };
+
+    GlyphAtlas const* m_atlas;
+    sf::Texture m_texture;  // Of the atlas.
+    sf::VertexArray m_vertices;
+    std::array<char, TextDevice::num_mapped_bytes> m_cells{};
+
+public:
+    // Uploads the atlas, which needs an OpenGL context. Throws std::runtime_error on failure.
+    [[nodiscard]] explicit TextRenderer(GlyphAtlas const& atlas);
+
+    // Returns whether any cell changed.
+    bool update(TextDevice const& text_device);
+
+    [[nodiscard]] sf::Vector2u size() const {
+        return sf::Vector2u{
+            m_atlas->cell_size().x * static_cast<unsigned>(TextDevice::num_columns),
+            m_atlas->cell_size().y * static_cast<unsigned>(TextDevice::num_rows),
+        };
+    }
+
+private:
+    void set_glyph(usize cell_index, char c);
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+};
@@ -0,0 +1,66 @@
+#include <gui/text_renderer.hpp>
+#include <stdexcept>
+
+[[nodiscard]] TextRenderer::TextRenderer(GlyphAtlas const& atlas)
+    : m_atlas{ &atlas }, m_vertices{ sf::PrimitiveType::Triangles, TextDevice::num_mapped_bytes * vertices_per_cell } {
+    if (not m_texture.loadFromImage(m_atlas->image())) {
+        throw std::runtime_error{ "Unable to create texture for glyph atlas." };
+    }
+
+    auto const cell_size = sf::Vector2f{ m_atlas->cell_size() };
+    for (auto row = usize{ 0 }; row < TextDevice::num_rows; ++row) {
+        for (auto column = usize{ 0 }; column < TextDevice::num_columns; ++column) {
+            auto const top_left = sf::Vector2f{
+                static_cast<float>(column) * cell_size.x,
+                static_cast<float>(row) * cell_size.y,
+            };
+            auto const bottom_right = top_left + cell_size;
+            auto const index = (row * TextDevice::num_columns + column) * vertices_per_cell;
+            m_vertices[index + 0].position = top_left;
+            m_vertices[index + 1].position = sf::Vector2f{ bottom_right.x, top_left.y };
+            m_vertices[index + 2].position = sf::Vector2f{ top_left.x, bottom_right.y };
+            m_vertices[index + 3].position = sf::Vector2f{ top_left.x, bottom_right.y };
+            m_vertices[index + 4].position = sf::Vector2f{ bottom_right.x, top_left.y };
+            m_vertices[index + 5].position = bottom_right;
+        }
+    }
+
+    for (auto cell_index = usize{ 0 }; cell_index < m_cells.size(); ++cell_index) {
+        set_glyph(cell_index, m_cells[cell_index]);
+    }
+}
+
+bool TextRenderer::update(TextDevice const& text_device) {
+    auto changed = false;
+    for (auto row = usize{ 0 }; row < TextDevice::num_rows; ++row) {
+        auto const contents = text_device.row(row);
+        for (auto column = usize{ 0 }; column < TextDevice::num_columns; ++column) {
+            auto const cell_index = row * TextDevice::num_columns + column;
+            auto const c = contents[column];
+            if (c == m_cells[cell_index]) {
+                continue;
+            }
+            m_cells[cell_index] = c;
+            set_glyph(cell_index, c);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void TextRenderer::set_glyph(usize const cell_index, char const c) {
+    auto const top_left = sf::Vector2f{ m_atlas->tile_position(c) };
+    auto const bottom_right = top_left + sf::Vector2f{ m_atlas->cell_size() };
+    auto const index = cell_index * vertices_per_cell;
+    m_vertices[index + 0].texCoords = top_left;
+    m_vertices[index + 1].texCoords = sf::Vector2f{ bottom_right.x, top_left.y };
+    m_vertices[index + 2].texCoords = sf::Vector2f{ top_left.x, bottom_right.y };
+    m_vertices[index + 3].texCoords = sf::Vector2f{ top_left.x, bottom_right.y };
+    m_vertices[index + 4].texCoords = sf::Vector2f{ bottom_right.x, top_left.y };
+    m_vertices[index + 5].texCoords = bottom_right;
+}
+
+void TextRenderer::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    states.texture = &m_texture;
+    target.draw(m_vertices, states);
+}
@@ -1,17 +1,30 @@
+#include <fmt/chrono.h>
 #include <fmt/format.h>
-#include <assembler/assembler.hpp>
+#include <algorithm>
+#include <assembler/compile_time.hpp>
 #include <cassert>
-#include <iterator>
 #include <common/instruction.hpp>
+#include <common/instruction_store.hpp>
 #include <common/pointer.hpp>
+#include <cstdlib>
+#include <emulator/save_state.hpp>
+#include <emulator/clock.hpp>
 #include <emulator/emulator.hpp>
+#include <emulator/profiler.hpp>
+#include <emulator/verifier.hpp>
+#include <filesystem>
 #include <gui/gui.hpp>
+#include <iterator>
 #include <string_view>
+#include <tl/optional.hpp>
 #include <vector>
 
-int main() {
-    using namespace std::string_view_literals;
-    static constexpr auto assembly = R"(
+int main(int const argc, char** const argv) {
+    static constexpr auto clock_frequency = u64{ 1'000'000 };  // Instructions per second.
+
+    // Assembled during compilation, assembly errors are compile errors.
+    static constexpr auto instruction_memory = assembler::compile_time::assemble<
+        R"(
 copy 0, A
 copy 0x6C6C6548, *A ; "Hell"
 copy 4, A
@@ -21,46 +34,73 @@ copy 0x646C726F, *A ; "orld"
 copy 12, A
 copy 0x00000021, *A ; "!"
 halt
-)"sv;
-    auto const instructions = assembler::assemble("test.asm", assembly);
-    if (not instructions.has_value()) {
-        if (auto const source_location = instructions.error().source_location()) {
-            auto const& location = source_location.value();
-            fmt::println(
-                std::cerr,
-                "{}:{}:{}: {}",
-                location.filename(),
-                location.row(),
-                location.column(),
-                instructions.error()
-            );
-            auto const num_digits = static_cast<int>(std::to_string(location.row()).length());
-            auto const surrounding_line = location.surrounding_line();
-            fmt::println(std::cerr, "{} | {}", location.row(), surrounding_line);
-            auto const offset = std::distance(surrounding_line.data(), location.lexeme().data());
-            fmt::println(std::cerr, "{:{}} | {:>{}}{:~>{}}^", "", num_digits, "", offset, "", location.lexeme().length() - 1);
-        } else {
-            fmt::println(std::cerr, "Error: {}", instructions.error());
+)",
+        static_cast<Word>(Emulator::entry_point)>();
+
+    fmt::println("Decoded memory:");
+    for (auto const& instruction : decode(instruction_memory)) {
+        fmt::println("{}", instruction);
+    }
+
+    auto const program = VerifiedProgram::verify(instruction_memory);
+    if (not program.has_value()) {
+        for (auto const& error : program.error()) {
+            fmt::println("Verification failed: {}", error);
         }
         return EXIT_FAILURE;
     }
-    auto instruction_memory = std::vector<std::byte>{};
-    for (auto const& instruction : instructions.value()) {
-        instruction.encode(std::back_inserter(instruction_memory));
+
+    auto const arguments = std::vector<std::string_view>(argv + 1, argv + argc);
+
+    // `--save-state <path>` resumes from the save state if it exists and saves to it when quitting.
+    auto save_state_path = tl::optional<std::filesystem::path>{};
+    if (auto const flag = std::ranges::find(arguments, "--save-state"); flag != arguments.end()) {
+        if (std::next(flag) == arguments.end()) {
+            fmt::println("--save-state requires a path.");
+            return EXIT_FAILURE;
+        }
+        save_state_path = std::filesystem::path{ *std::next(flag) };
     }
 
-    fmt::println("Decoded memory:");
-    for (auto const& instruction : decode(instruction_memory)) {
-        fmt::println("{}", instruction);
+    auto emulator = tl::optional<Emulator>{};
+    if (save_state_path.has_value() and std::filesystem::exists(save_state_path.value())) {
+        auto const state = SaveState::load(save_state_path.value());
+        if (not state.has_value()) {
+            fmt::println("{}", state.error());
+            return EXIT_FAILURE;
+        }
+        emulator.emplace(state.value());
+    } else {
+        emulator.emplace(program.value());
     }
 
     auto gui = Gui{};
-    auto emulator = Emulator{ instruction_memory };
+    auto clock = Clock::with_frequency(clock_frequency);
+
+    // `--profile` measures host hardware events while emulating.
+    auto profiler = tl::optional<Profiler>{};
+    if (std::ranges::find(arguments, "--profile") != arguments.end()) {
+        profiler.emplace();
+        clock.set_profiler(&profiler.value());
+    }
 
     while (gui.is_running()) {
-        if (not emulator.is_halted()) {
-            emulator.step();
-        }
-        gui.update(emulator);
+        clock.run_until(emulator.value(), gui.next_frame());
+        gui.update(emulator.value());
+    }
+    if (save_state_path.has_value()) {
+        emulator->save(save_state_path.value());
+    }
+
+    auto const statistics = clock.statistics();
+    fmt::println(
+        "Executed {} instructions ({:.0f} instructions/s, mean jitter {}, max jitter {}).",
+        statistics.num_instructions,
+        statistics.instructions_per_second,
+        statistics.mean_jitter,
+        statistics.max_jitter
+    );
+    if (profiler.has_value()) {
+        fmt::print("{}", profiler->profile());
     }
 }
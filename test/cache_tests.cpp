@@ -0,0 +1,165 @@
+#include <assembler/assembler.hpp>
+#include <assembler/diagnostic.hpp>
+#include <common/mapped_file.hpp>
+#include <common/memory.hpp>
+#include <filesystem>
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "temporary_directory.hpp"
+
+namespace {
+    constexpr auto source = std::string_view{ "start:\ncopy 1, A\ncopy 2, A\ncopy start, *A\nhalt\nend:\n" };
+
+    // Cache entries start with a header of 64 bytes, followed by the image.
+    constexpr auto image_offset = usize{ 64 };
+
+    struct Assembled final {
+        std::vector<std::byte> bytes;
+        std::vector<std::pair<std::string, Word>> symbols;
+        std::vector<std::string> locations;  // Per byte.
+
+        [[nodiscard]] friend bool operator==(Assembled const&, Assembled const&) = default;
+    };
+
+    [[nodiscard]] Assembled assemble(std::string_view const text, assembler::Options const& options) {
+        auto const source_file = assembler::SourceFile{ "test.asm", text };
+        auto const image = assembler::assemble_image(source_file, options);
+        if (not image.has_value()) {
+            ADD_FAILURE() << assembler::render(image.error());
+            return {};
+        }
+        auto result = Assembled{ { image->bytes().begin(), image->bytes().end() }, {}, {} };
+        for (auto const& symbol : image->symbols()) {
+            result.symbols.emplace_back(symbol.name, symbol.address);
+        }
+        for (auto i = usize{ 0 }; i <= image->bytes().size(); ++i) {
+            auto const location = image->source_map().find(options.base_address + static_cast<Word>(i));
+            result.locations.push_back(location.has_value() ? fmt::format("{}", location.value()) : "none");
+        }
+        return result;
+    }
+
+    [[nodiscard]] std::vector<std::filesystem::path> entries(std::filesystem::path const& directory) {
+        auto result = std::vector<std::filesystem::path>{};
+        for (auto const& entry : std::filesystem::directory_iterator{ directory }) {
+            result.push_back(entry.path());
+        }
+        return result;
+    }
+
+    [[nodiscard]] std::vector<std::byte> read(std::filesystem::path const& path) {
+        auto const file = MappedFile::open(path);
+        if (not file.has_value()) {
+            ADD_FAILURE() << "Unable to read " << path;
+            return {};
+        }
+        return std::vector<std::byte>{ file->bytes().begin(), file->bytes().end() };
+    }
+
+    // Replaces the immediate of the first instruction in the only entry of the cache. Assembling from the
+    // cache then gives a different result than assembling from scratch.
+    void tamper_with_entry(std::filesystem::path const& directory) {
+        auto const paths = entries(directory);
+        ASSERT_EQ(paths.size(), usize{ 1 });
+        auto contents = read(paths.front());
+        ASSERT_GT(contents.size(), image_offset + 1);
+        contents[image_offset + 1] = std::byte{ 0x2A };
+        ASSERT_TRUE(write_file_atomically(paths.front(), contents));
+    }
+
+    class CacheTest : public testing::Test {
+    protected:
+        TemporaryDirectory m_directory;
+        Assembled m_uncached = assemble(source, {});
+
+        [[nodiscard]] assembler::Options cached(assembler::Options options = {}) const {
+            options.cache_directory = m_directory.path();
+            return options;
+        }
+    };
+}  // namespace
+
+TEST_F(CacheTest, UnchangedSourceHits) {
+    EXPECT_EQ(assemble(source, cached()), m_uncached);
+    ASSERT_EQ(entries(m_directory.path()).size(), usize{ 1 });
+    EXPECT_EQ(assemble(source, cached()), m_uncached);
+
+    tamper_with_entry(m_directory.path());
+    auto const hit = assemble(source, cached());
+    EXPECT_EQ(hit.bytes.at(1), std::byte{ 0x2A });
+    EXPECT_EQ(hit.symbols, m_uncached.symbols);
+    EXPECT_EQ(hit.locations, m_uncached.locations);
+}
+
+TEST_F(CacheTest, ChangedSourceMisses) {
+    [[maybe_unused]] auto const first = assemble(source, cached());
+    tamper_with_entry(m_directory.path());
+    auto const changed_source = std::string{ source } + "\n";
+    EXPECT_EQ(assemble(changed_source, cached()), assemble(changed_source, {}));
+    EXPECT_EQ(entries(m_directory.path()).size(), usize{ 2 });
+}
+
+TEST_F(CacheTest, ChangedOptionsMiss) {
+    [[maybe_unused]] auto const first = assemble(source, cached());
+    tamper_with_entry(m_directory.path());
+
+    auto const optimized = assemble(source, cached({ .optimize = true }));
+    EXPECT_EQ(optimized, assemble(source, { .optimize = true }));
+    EXPECT_NE(optimized, m_uncached);
+    EXPECT_EQ(entries(m_directory.path()).size(), usize{ 2 });
+
+    auto const relocated = assemble(source, cached({ .base_address = 0x1000 }));
+    EXPECT_EQ(relocated, assemble(source, { .base_address = 0x1000 }));
+    EXPECT_NE(relocated, m_uncached);
+    EXPECT_EQ(entries(m_directory.path()).size(), usize{ 3 });
+}
+
+// Neither the number of threads nor the threshold change the output, so they share entries.
+TEST_F(CacheTest, ParallelismDoesNotMiss) {
+    [[maybe_unused]] auto const first = assemble(source, cached());
+    tamper_with_entry(m_directory.path());
+    EXPECT_EQ(assemble(source, cached({ .parallel_threshold = 0, .num_threads = 3 })).bytes.at(1), std::byte{ 0x2A });
+}
+
+TEST_F(CacheTest, TruncatedEntriesFallBackToAssembling) {
+    [[maybe_unused]] auto const first = assemble(source, cached());
+    auto const path = entries(m_directory.path()).front();
+    auto const contents = read(path);
+    for (auto size = usize{ 0 }; size < contents.size(); ++size) {
+        ASSERT_TRUE(write_file_atomically(path, std::span{ contents }.first(size)));
+        EXPECT_EQ(assemble(source, cached()), m_uncached) << "Truncated to " << size << " bytes";
+        // Assembling replaced the entry.
+        EXPECT_EQ(read(path), contents);
+    }
+}
+
+TEST_F(CacheTest, CorruptEntriesFallBackToAssembling) {
+    [[maybe_unused]] auto const first = assemble(source, cached());
+    auto const path = entries(m_directory.path()).front();
+    auto const contents = read(path);
+    auto const metadata_offset = load_little_endian<u64>(std::span{ contents }, 4 * sizeof(u64));
+
+    auto const corrupt_at = [&](u64 const offset, u64 const value, std::string_view const what) {
+        auto corrupt = contents;
+        store_little_endian(std::span{ corrupt }, static_cast<usize>(offset), value);
+        ASSERT_TRUE(write_file_atomically(path, corrupt));
+        EXPECT_EQ(assemble(source, cached()), m_uncached) << what;
+        EXPECT_EQ(read(path), contents) << what;
+    };
+    corrupt_at(0, 0, "Magic");
+    corrupt_at(sizeof(u64), 1, "Format version");
+    corrupt_at(2 * sizeof(u64), contents.size(), "Image offset");
+    corrupt_at(3 * sizeof(u64), u64{ 1 } << 62, "Image size");
+    corrupt_at(4 * sizeof(u64), contents.size() - 1, "Metadata offset");
+    corrupt_at(5 * sizeof(u64), contents.size(), "Metadata size");
+    corrupt_at(metadata_offset, u64{ 1 } << 40, "Number of symbols");
+    corrupt_at(metadata_offset + sizeof(u64) + sizeof(u32), 0xFFFF'FFFF, "Length of a symbol name");
+    // The size of the source map, which follows the symbols "start" and "end".
+    corrupt_at(metadata_offset + sizeof(u64) + 4 * sizeof(u32) + 8, 1, "Size of the source map");
+    corrupt_at(contents.size() - sizeof(u64), ~u64{ 0 }, "Source map");
+}
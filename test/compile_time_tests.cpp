@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <assembler/assembler.hpp>
+#include <assembler/compile_time.hpp>
+#include <assembler/token.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <tl/optional.hpp>
+#include "random_source.hpp"
+
+// The compile-time assembler is a separate implementation of the language. Its functions are constexpr, so
+// they run at runtime as well, which lets them be compared against the runtime assembler on many inputs.
+namespace {
+    [[nodiscard]] tl::optional<std::vector<std::byte>> assemble_at_runtime(std::string_view const source) {
+        auto const source_file = assembler::SourceFile{ "test.asm", source };
+        auto const image = assembler::assemble_image(source_file);
+        if (not image.has_value()) {
+            return tl::nullopt;
+        }
+        return std::vector<std::byte>{ image->bytes().begin(), image->bytes().end() };
+    }
+
+    [[nodiscard]] tl::optional<std::vector<std::byte>> assemble_at_compile_time(std::string_view const source) {
+        try {
+            return assembler::compile_time::detail::assemble(source, 0);
+        } catch (char const*) {
+            return tl::nullopt;
+        }
+    }
+
+    void expect_same_result(std::string_view const source) {
+        auto const expected = assemble_at_runtime(source);
+        auto const actual = assemble_at_compile_time(source);
+        ASSERT_EQ(actual.has_value(), expected.has_value()) << "Source: '" << source << "'";
+        if (expected.has_value()) {
+            EXPECT_EQ(actual.value(), expected.value()) << "Source: '" << source << "'";
+        }
+    }
+}  // namespace
+
+TEST(CompileTimeAssembler, MatchesRuntimeAssemblerOnEdgeCases) {
+    static constexpr auto sources = std::array<std::string_view, 36>{
+        "",
+        "halt",
+        "halt  ",
+        "halt\t",
+        "halt ; comment",
+        "halt\n  ",
+        " \t \n",
+        "copy 0x1F, A\nhalt",
+        "copy 0x, A",
+        "copy 0xG, A",
+        "copy 0x1g, A",
+        "copy 4294967295, A",
+        "copy 4294967296, A",
+        "copy 0xFFFFFFFF, A",
+        "copy 0x100000000, A",
+        "copy 00012, A",
+        "start:\ncopy start, A\nhalt",
+        "start:",
+        "a: b: halt",
+        "a: a: halt",
+        "copy nowhere, A",
+        "copy *A, B",
+        "copy *1, A",
+        "copy **A, B",
+        "halt halt",
+        "copy 1, A halt",
+        "copy 1,",
+        "copy 1, A,",
+        ",",
+        ":",
+        "$",
+        "halt $",
+        "HALT",
+        "copy 1, a",
+        "halt\r\n",
+        "1x: halt",
+    };
+    for (auto const source : sources) {
+        expect_same_result(source);
+    }
+}
+
+TEST(CompileTimeAssembler, MatchesRuntimeAssemblerOnRandomSources) {
+    auto random = RandomSource{ 41 };
+    for (auto i = 0; i < 5000; ++i) {
+        expect_same_result(random.next_source(1 + random.next() % 24));
+    }
+}
+
+TEST(CompileTimeAssembler, MatchesRuntimeAssemblerOnValidPrograms) {
+    auto random = RandomSource{ 42 };
+    for (auto i = 0; i < 200; ++i) {
+        auto source = std::string{ "start:\n" };
+        for (auto line = 0; line < 20; ++line) {
+            source += random.next_line();
+        }
+        source += "copy start, A\nhalt\n";
+        ASSERT_TRUE(assemble_at_runtime(source).has_value()) << "Source: '" << source << "'";
+        expect_same_result(source);
+    }
+}
+
+// Only a label, so that nothing but the length of its token can make the source invalid.
+TEST(CompileTimeAssembler, MatchesRuntimeAssemblerOnTheLongestTokens) {
+    auto const longest = std::string(assembler::Token::max_length, 'x');
+    expect_same_result(longest + ":");
+    EXPECT_FALSE(assemble_at_runtime(longest + "x:").has_value());
+    expect_same_result(longest + "x:");
+}
+
+// The program is as large as it can get for the length of its source.
+TEST(CompileTimeAssembler, AssemblesTheDensestProgramDuringConstantEvaluation) {
+    static constexpr auto bytes = assembler::compile_time::assemble<"copy 1,A">();
+    EXPECT_EQ(bytes.size(), MoveImmediateIntoRegister::byte_length);
+    auto const expected = assemble_at_runtime("copy 1,A");
+    ASSERT_TRUE(expected.has_value());
+    EXPECT_TRUE(std::ranges::equal(bytes, expected.value()));
+}
+
+TEST(CompileTimeAssembler, AssemblesDuringConstantEvaluation) {
+    static constexpr auto bytes = assembler::compile_time::assemble<"start: copy start, A  \nhalt  ", 0x100>();
+    auto const source_file = assembler::SourceFile{ "test.asm", "start: copy start, A  \nhalt  " };
+    auto const image = assembler::assemble_image(source_file, assembler::Options{ .base_address = 0x100 });
+    ASSERT_TRUE(image.has_value());
+    EXPECT_TRUE(std::ranges::equal(bytes, image->bytes()));
+}
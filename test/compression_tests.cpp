@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <common/compression.hpp>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "random_source.hpp"
+
+namespace {
+    [[nodiscard]] std::vector<std::byte> random_bytes(RandomSource& random, usize const size) {
+        auto result = std::vector<std::byte>(size);
+        for (auto& byte : result) {
+            byte = static_cast<std::byte>(random.next());
+        }
+        return result;
+    }
+
+    [[nodiscard]] std::vector<std::byte> bytes_of(std::string_view const text) {
+        return std::vector<std::byte>{ reinterpret_cast<std::byte const*>(text.data()),
+                                       reinterpret_cast<std::byte const*>(text.data() + text.size()) };
+    }
+
+    // Returns the compressed data.
+    std::vector<std::byte> expect_round_trip(std::span<std::byte const> const input) {
+        auto const compressed = compress(input);
+        auto output = std::vector<std::byte>(input.size(), std::byte{ 0xCC });
+        EXPECT_TRUE(decompress(compressed, output)) << input.size() << " bytes";
+        EXPECT_TRUE(std::ranges::equal(output, input)) << input.size() << " bytes";
+        return compressed;
+    }
+}  // namespace
+
+TEST(Compression, RoundTripsEmptyInput) {
+    EXPECT_EQ(expect_round_trip({}).size(), usize{ 1 });
+}
+
+TEST(Compression, RoundTripsShortInputs) {
+    auto random = RandomSource{ 50 };
+    for (auto size = usize{ 1 }; size < 40; ++size) {
+        expect_round_trip(random_bytes(random, size));
+        expect_round_trip(std::vector<std::byte>(size, std::byte{ 7 }));
+    }
+}
+
+TEST(Compression, RoundTripsIncompressibleInput) {
+    auto random = RandomSource{ 51 };
+    for (auto const size : { usize{ 15 }, usize{ 16 }, usize{ 270 }, usize{ 4'096 }, usize{ 100'000 } }) {
+        auto const input = random_bytes(random, size);
+        auto const compressed = expect_round_trip(input);
+        EXPECT_LE(compressed.size(), size + size / 100 + 16);
+    }
+}
+
+// Matches whose offset is shorter than their length overlap with the bytes they produce.
+TEST(Compression, RoundTripsRuns) {
+    for (auto const size : { usize{ 4 }, usize{ 19 }, usize{ 20 }, usize{ 300 }, usize{ 70'000 } }) {
+        auto const compressed = expect_round_trip(std::vector<std::byte>(size, std::byte{ 0xAB }));
+        EXPECT_LT(compressed.size(), size / 200 + 16);
+    }
+    auto pattern = std::string{};
+    while (pattern.size() < 1'000) {
+        pattern += "abc";
+    }
+    EXPECT_LT(expect_round_trip(bytes_of(pattern)).size(), usize{ 20 });
+}
+
+// Offsets only reach back 64 KiB, so repetitions further back than that must not be matched.
+TEST(Compression, RoundTripsInputsLargerThanTheMaximumOffset) {
+    auto random = RandomSource{ 52 };
+    auto const block = random_bytes(random, 40'000);
+    auto input = std::vector<std::byte>{};
+    for (auto i = 0; i < 4; ++i) {
+        input.insert(input.end(), block.begin(), block.end());
+        auto const noise = random_bytes(random, 30'000);
+        input.insert(input.end(), noise.begin(), noise.end());
+    }
+    auto const page = bytes_of("A page of text that repeats itself over and over again.\n");
+    while (input.size() < 1'000'000) {
+        input.insert(input.end(), page.begin(), page.end());
+    }
+    expect_round_trip(input);
+}
+
+TEST(Compression, RejectsTruncatedInput) {
+    auto random = RandomSource{ 53 };
+    // Ends in literals, since a stream that ends in a match is still complete without the empty last sequence.
+    auto input = random_bytes(random, 1'000);
+    input.insert(input.end(), input.begin(), input.begin() + 500);
+    auto const tail = random_bytes(random, 10);
+    input.insert(input.end(), tail.begin(), tail.end());
+    auto const compressed = compress(input);
+    auto output = std::vector<std::byte>(input.size());
+    for (auto size = usize{ 0 }; size < compressed.size(); ++size) {
+        EXPECT_FALSE(decompress(std::span{ compressed }.first(size), output)) << size << " bytes";
+    }
+}
+
+TEST(Compression, RejectsOffsetsBeforeTheStart) {
+    auto output = std::vector<std::byte>(8);
+    // One literal, then a match of four bytes at offset two, then four literals.
+    auto input = std::vector<std::byte>{ std::byte{ 0x10 }, std::byte{ 'a' }, std::byte{ 2 },   std::byte{ 0 },
+                                         std::byte{ 0x30 }, std::byte{ 'b' }, std::byte{ 'c' }, std::byte{ 'd' } };
+    EXPECT_FALSE(decompress(input, output));
+    // Offset zero.
+    input[2] = std::byte{ 0 };
+    EXPECT_FALSE(decompress(input, output));
+    // Offset one is fine and repeats the literal.
+    input[2] = std::byte{ 1 };
+    EXPECT_TRUE(decompress(input, output));
+    EXPECT_EQ(output, bytes_of("aaaaabcd"));
+}
+
+TEST(Compression, RejectsInputThatDoesNotFitTheOutput) {
+    auto const input = bytes_of("Some text, some more text, and then some more text.");
+    auto const compressed = compress(input);
+    for (auto const size : { usize{ 0 }, input.size() - 1, input.size() + 1 }) {
+        auto output = std::vector<std::byte>(size);
+        EXPECT_FALSE(decompress(compressed, output)) << size << " bytes";
+    }
+
+    // Another sequence after the last one, which has to consist of literals only.
+    auto overlong = compressed;
+    overlong.push_back(std::byte{ 0 });
+    auto output = std::vector<std::byte>(input.size());
+    EXPECT_FALSE(decompress(overlong, output));
+
+    // A literal length that reaches past the end of the input.
+    auto const too_many_literals = std::vector<std::byte>{ std::byte{ 0xF0 }, std::byte{ 0xFF }, std::byte{ 0xFF } };
+    auto large_output = std::vector<std::byte>(1'000);
+    EXPECT_FALSE(decompress(too_many_literals, large_output));
+}
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <assembler/assembler.hpp>
+#include <cstddef>
+#include <fmt/format.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "chunk.hpp"
+#include "random_source.hpp"
+
+namespace {
+    using testing::Contains;
+    using testing::ElementsAre;
+
+    // Row and message, e.g. "3: Unknown mnemonic: 'jump'".
+    [[nodiscard]] std::string describe(assembler::Error const& error) {
+        auto const location = error.source_location();
+        return fmt::format("{}: {}", location.has_value() ? location->row() : usize{ 0 }, error);
+    }
+
+    [[nodiscard]] std::vector<std::string> describe(std::vector<assembler::Error> const& errors) {
+        auto result = std::vector<std::string>{};
+        for (auto const& error : errors) {
+            result.push_back(describe(error));
+        }
+        return result;
+    }
+
+    [[nodiscard]] std::vector<std::string> collect_errors(
+        std::string_view const source,
+        usize const max_errors,
+        assembler::Options const& options = {}
+    ) {
+        auto const source_file = assembler::SourceFile{ "test.asm", source };
+        return describe(assembler::collect_errors(source_file, max_errors, options));
+    }
+
+    // One error of every phase, and of linking, on separate lines.
+    constexpr auto source_with_errors = std::string_view{
+        "copy 1, A\n"
+        "copy $, A\n"
+        "twice:\n"
+        "copy 1\n"
+        "copy missing, B\n"
+        "twice:\n"
+        "jump A\n"
+        "halt\n"
+        "copy 1, *A, B\n"
+    };
+}  // namespace
+
+TEST(ErrorRecovery, ReportsErrorsOnSeparateLinesInSourceOrder) {
+    EXPECT_THAT(
+        collect_errors(source_with_errors, 100),
+        ElementsAre(
+            "2: Invalid character: '$'",
+            "4: Arity mismatch for mnemonic 'copy'. Expected 2, but got 1.",
+            "5: Undefined symbol: 'missing'",
+            "6: Duplicate label: 'twice'",
+            "7: Unknown mnemonic: 'jump'",
+            "9: Arity mismatch for mnemonic 'copy'. Expected 2, but got 3."
+        )
+    );
+    EXPECT_TRUE(collect_errors("start:\ncopy start, A\nhalt\n", 100).empty());
+}
+
+TEST(ErrorRecovery, TruncatesToMaxErrors) {
+    auto const all = collect_errors(source_with_errors, 100);
+    for (auto max_errors = usize{ 1 }; max_errors <= all.size() + 1; ++max_errors) {
+        auto const num_expected = static_cast<std::ptrdiff_t>(std::min(max_errors, all.size()));
+        auto const expected = std::vector(all.begin(), all.begin() + num_expected);
+        EXPECT_EQ(collect_errors(source_with_errors, max_errors), expected) << max_errors;
+    }
+    EXPECT_THROW([[maybe_unused]] auto const errors = collect_errors(source_with_errors, 0), std::invalid_argument);
+}
+
+TEST(ErrorRecovery, LabelsOnLinesThatFailToLexStillDefineTheirSymbols) {
+    EXPECT_THAT(
+        collect_errors("copy later, A\nlater: copy $, A\nhalt\n", 100),
+        ElementsAre("2: Invalid character: '$'")
+    );
+    EXPECT_THAT(
+        collect_errors("first: copy 1, $\nsecond: copy 4294967296, B\ncopy first, A\ncopy second, B\n", 100),
+        ElementsAre("1: Invalid character: '$'", "2: Invalid integer: '4294967296'")
+    );
+}
+
+// Assembling stops at the first error of the first phase that fails, which is among the errors of the
+// recovering pass.
+TEST(ErrorRecovery, FindsTheErrorThatAssemblingStopsAt) {
+    auto random = RandomSource{ 39 };
+    for (auto i = 0; i < 2'000; ++i) {
+        auto const source = random.next_source(random.next() % 40);
+        auto const source_file = assembler::SourceFile{ "test.asm", source };
+        auto const image = assembler::assemble_image(source_file);
+        auto const errors = collect_errors(source, 1'000);
+        if (image.has_value()) {
+            EXPECT_TRUE(errors.empty()) << source;
+        } else {
+            EXPECT_THAT(errors, Contains(describe(image.error()))) << source;
+        }
+    }
+}
+
+// Large sources are split into chunks that are assembled in parallel, each of which reports its own errors.
+TEST(ErrorRecovery, ReportsErrorsOfAllChunksInSourceOrder) {
+    auto source = std::string{};
+    auto expected = std::vector<std::string>{};
+    for (auto row = usize{ 1 }; row <= 20'000; ++row) {
+        if (row % 997 == 0) {
+            source += "copy " + std::to_string(row) + "\n";
+            expected.push_back(fmt::format("{}: Arity mismatch for mnemonic 'copy'. Expected 2, but got 1.", row));
+        } else {
+            source += "copy " + std::to_string(row) + ", *A\n";
+        }
+    }
+    ASSERT_GT(assembler::split(source).size(), usize{ 2 });
+    auto const options = assembler::Options{ .parallel_threshold = 0, .num_threads = 4 };
+    EXPECT_EQ(collect_errors(source, 100, options), expected);
+    EXPECT_EQ(collect_errors(source, 3, options), std::vector(expected.begin(), expected.begin() + 3));
+}
+
+TEST(ErrorRecovery, AssemblesChunksAroundTheirErrors) {
+    constexpr auto source = std::string_view{ "copy 1, A\nfirst: copy $, A\ncopy 2\nsecond:\nhalt\nfence\n" };
+    auto const source_file = assembler::SourceFile{ "test.asm", source };
+    // From the second line up to and including the fifth.
+    auto const chunk = assembler::Chunk{ source.find("first"), source.find("fence") };
+    auto const result =
+        assembler::assemble_chunk_recovering(source_file, chunk, false, 100, std::pmr::get_default_resource());
+    ASSERT_FALSE(result.exception);
+    EXPECT_THAT(
+        describe(result.errors),
+        ElementsAre("2: Invalid character: '$'", "3: Arity mismatch for mnemonic 'copy'. Expected 2, but got 1.")
+    );
+    EXPECT_EQ(result.section.instructions.size(), usize{ 1 });
+    auto labels = std::vector<std::string_view>{};
+    for (auto const& label : result.section.labels) {
+        labels.push_back(label.name.lexeme());
+    }
+    EXPECT_THAT(labels, ElementsAre("first", "second"));
+
+    auto const truncated =
+        assembler::assemble_chunk_recovering(source_file, chunk, false, 1, std::pmr::get_default_resource());
+    EXPECT_THAT(describe(truncated.errors), ElementsAre("2: Invalid character: '$'"));
+}
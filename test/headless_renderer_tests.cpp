@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <emulator/text_device.hpp>
+#include <gtest/gtest.h>
+#include <gui/headless_renderer.hpp>
+#include <string>
+#include <string_view>
+
+// Renders a fixed screen and compares it against test/golden/text_device.ppm. Set the environment variable
+// IUBS2K_UPDATE_GOLDEN_IMAGES to write the golden image instead, e.g. after changing the font.
+namespace {
+    constexpr auto character_size = 12u;
+
+    // Allows for small differences in rasterisation between FreeType versions.
+    constexpr auto tolerance = u8{ 8 };
+
+    [[nodiscard]] std::filesystem::path source_directory() {
+        return std::filesystem::path{ IUBS2K_SOURCE_DIR };
+    }
+
+    [[nodiscard]] HeadlessRenderer make_renderer() {
+        return HeadlessRenderer{ source_directory() / GlyphAtlas::default_font_path, character_size };
+    }
+
+    class Screen final {
+    private:
+        std::array<std::byte, TextDevice::num_mapped_bytes> m_memory{};
+
+    public:
+        void write(usize const column, usize const row, std::string_view const text) {
+            auto const offset = row * TextDevice::num_columns + column;
+            std::ranges::transform(text, m_memory.begin() + static_cast<std::ptrdiff_t>(offset), [](char const c) {
+                return static_cast<std::byte>(c);
+            });
+        }
+
+        [[nodiscard]] TextDevice device() {
+            return TextDevice{ m_memory };
+        }
+    };
+
+    // Every printable character, non-printable ones in between (which stay empty) and text at the edges.
+    [[nodiscard]] Screen golden_screen() {
+        auto screen = Screen{};
+        screen.write(0, 0, "Inherently Unsafe Backseat System 2k");
+        auto printable = std::string{};
+        for (auto c = ' '; c < '\x7F'; ++c) {
+            printable += c;
+        }
+        screen.write(0, 2, printable);
+        screen.write(0, 5, "copy 0x1F, *A ; store");
+        screen.write(0, 7, "a\x01" "b\x1F" "c\x7F" "d\xFF" "e");
+        screen.write(TextDevice::num_columns - 3, 12, "end");
+        for (auto column = usize{ 0 }; column < TextDevice::num_columns; column += 10) {
+            screen.write(column, TextDevice::num_rows - 1, "0123456789");
+        }
+        return screen;
+    }
+}  // namespace
+
+TEST(HeadlessRenderer, MatchesGoldenImage) {
+    auto renderer = make_renderer();
+    auto screen = golden_screen();
+    auto const& frame = renderer.render(screen.device());
+
+    auto const golden_path = source_directory() / "test" / "golden" / "text_device.ppm";
+    if (std::getenv("IUBS2K_UPDATE_GOLDEN_IMAGES") != nullptr) {
+        frame.save(golden_path);
+        GTEST_SKIP() << "Updated " << golden_path;
+    }
+
+    auto const golden = Image::load(golden_path);
+    auto const difference = compare(frame, golden, tolerance);
+    if (not difference.is_within_tolerance()) {
+        if (difference.sizes_match) {
+            difference_image(frame, golden, tolerance).save("text_device_difference.ppm");
+        }
+        FAIL() << difference.num_differing_pixels << " pixels differ by up to "
+               << int{ difference.max_channel_difference } << ", see text_device_difference.ppm";
+    }
+}
+
+// Only cells that changed are drawn again, which has to give the same frame as drawing everything.
+TEST(HeadlessRenderer, IncrementalFrameMatchesFullFrame) {
+    auto renderer = make_renderer();
+    auto screen = golden_screen();
+    [[maybe_unused]] auto const& first = renderer.render(screen.device());
+    screen.write(0, 0, "Changed");
+    screen.write(0, 2, std::string(20, '\0'));
+    auto const& incremental = renderer.render(screen.device());
+
+    auto fresh_renderer = make_renderer();
+    EXPECT_TRUE(incremental == fresh_renderer.render(screen.device()));
+}
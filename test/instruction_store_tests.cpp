@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <array>
+#include <common/instruction_store.hpp>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "random_source.hpp"
+
+namespace {
+    constexpr auto interval = InstructionStore::checkpoint_interval;
+
+    // Mostly long instructions with the odd short one, so that byte offsets are not a multiple of the index.
+    [[nodiscard]] std::vector<Instruction> random_instructions(RandomSource& random, usize const count) {
+        auto result = std::vector<Instruction>{};
+        for (auto i = usize{ 0 }; i < count; ++i) {
+            auto const register_ = static_cast<Register>(random.next() % 4);
+            switch (random.next() % 5) {
+                case 0:
+                    result.emplace_back(MoveImmediateIntoRegister{ random.next(), register_ });
+                    break;
+                case 1:
+                    result.emplace_back(MoveImmediateIntoMemory{ random.next(), Pointer{ register_ } });
+                    break;
+                case 2:
+                    result.emplace_back(AtomicAddImmediateToMemory{ random.next(), Pointer{ register_ } });
+                    break;
+                case 3:
+                    result.emplace_back(Fence{});
+                    break;
+                default:
+                    result.emplace_back(HaltAndCatchFire{});
+                    break;
+            }
+        }
+        return result;
+    }
+
+    [[nodiscard]] std::vector<std::byte> encode(Instruction const& instruction) {
+        auto result = std::vector<std::byte>{};
+        instruction.encode(std::back_inserter(result));
+        return result;
+    }
+
+    [[nodiscard]] std::vector<std::byte> encode(std::vector<Instruction> const& instructions) {
+        auto result = std::vector<std::byte>{};
+        for (auto const& instruction : instructions) {
+            instruction.encode(std::back_inserter(result));
+        }
+        return result;
+    }
+
+    // Compares every instruction and byte offset, by index and by iterating.
+    void expect_matches(InstructionStore const& store, std::vector<Instruction> const& instructions) {
+        ASSERT_EQ(store.size(), instructions.size());
+        auto offset = usize{ 0 };
+        auto iterator = store.begin();
+        for (auto i = usize{ 0 }; i < instructions.size(); ++i, ++iterator) {
+            ASSERT_EQ(store.byte_offset(i), offset) << "Instruction " << i;
+            ASSERT_EQ(iterator.index(), i);
+            ASSERT_EQ(iterator.byte_offset(), offset) << "Instruction " << i;
+            ASSERT_EQ(encode(*iterator), encode(instructions[i])) << "Instruction " << i;
+            ASSERT_EQ(encode(store[i]), encode(instructions[i])) << "Instruction " << i;
+            ASSERT_EQ(store.opcode(i), instructions[i].opcode());
+            ASSERT_EQ(store.byte_length(i), instructions[i].byte_length());
+            offset += instructions[i].byte_length();
+        }
+        EXPECT_EQ(iterator, store.end());
+        EXPECT_EQ(store.end().byte_offset(), offset);
+        EXPECT_EQ(store.byte_offset(store.size()), offset);
+        EXPECT_EQ(store.byte_length(), offset);
+        EXPECT_THROW([[maybe_unused]] auto const result = store.byte_offset(store.size() + 1), std::out_of_range);
+        EXPECT_EQ(store.encode(), encode(instructions));
+    }
+}  // namespace
+
+// Sizes around multiples of the checkpoint interval, so that lookups sum up from the first and the last
+// checkpoint, and the end lies right on a checkpoint that does not exist yet.
+TEST(InstructionStore, StoresInstructionsAcrossCheckpoints) {
+    auto random = RandomSource{ 49 };
+    auto const counts = std::array<usize, 7>{ 0, 1, interval - 1, interval, interval + 1, 2 * interval + 1, 1'000 };
+    for (auto const count : counts) {
+        auto const instructions = random_instructions(random, count);
+        auto pushed = InstructionStore{};
+        for (auto const& instruction : instructions) {
+            pushed.push_back(instruction);
+        }
+        expect_matches(pushed, instructions);
+        expect_matches(InstructionStore{ std::span{ instructions } }, instructions);
+    }
+}
+
+TEST(InstructionStore, DecodesWhatItEncodes) {
+    auto random = RandomSource{ 50 };
+    auto const instructions = random_instructions(random, 5 * interval + 3);
+    auto const bytes = encode(instructions);
+    expect_matches(decode(bytes), instructions);
+    expect_matches(InstructionStore::decode(bytes), instructions);
+    EXPECT_EQ(decode(InstructionStore{ std::span{ instructions } }.encode()).encode(), bytes);
+
+    // A trailing instruction that is cut off.
+    auto truncated = bytes;
+    truncated.push_back(std::byte{ std::to_underlying(Opcode::MoveImmediateIntoRegister) });
+    EXPECT_ANY_THROW([[maybe_unused]] auto const store = decode(truncated));
+}
+
+TEST(InstructionStore, SetsImmediatesBehindCheckpoints) {
+    auto random = RandomSource{ 51 };
+    auto instructions = random_instructions(random, 3 * interval);
+    auto store = InstructionStore{ std::span{ instructions } };
+    for (auto i = usize{ 0 }; i < instructions.size(); ++i) {
+        auto const value = random.next();
+        auto const has_immediate = std::visit(
+            [&](auto& instruction) {
+                if constexpr (requires { instruction.immediate = value; }) {
+                    instruction.immediate = value;
+                    return true;
+                } else {
+                    return false;
+                }
+            },
+            instructions[i]
+        );
+        if (has_immediate) {
+            store.set_immediate(i, value);
+        } else {
+            EXPECT_THROW(store.set_immediate(i, value), std::logic_error) << "Instruction " << i;
+        }
+    }
+    expect_matches(store, instructions);
+    EXPECT_THROW(store.set_immediate(store.size(), 0), std::out_of_range);
+}
+
+TEST(InstructionStore, CountsOpcodes) {
+    auto random = RandomSource{ 52 };
+    auto const instructions = random_instructions(random, 300);
+    auto const store = InstructionStore{ std::span{ instructions } };
+    auto total = usize{ 0 };
+    for (auto const opcode : magic_enum::enum_values<Opcode>()) {
+        auto const has_opcode = [&](Instruction const& instruction) { return instruction.opcode() == opcode; };
+        auto const expected = static_cast<usize>(std::ranges::count_if(instructions, has_opcode));
+        EXPECT_EQ(store.count(opcode), expected);
+        total += expected;
+    }
+    EXPECT_EQ(total, instructions.size());
+}
@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <array>
+#include <assembler/source_file.hpp>
+#include <gtest/gtest.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+#include "lexer.hpp"
+#include "random_source.hpp"
+
+namespace {
+    using assembler::TokenType;
+    using namespace std::string_view_literals;
+
+    struct ExpectedToken final {
+        TokenType type;
+        std::string_view lexeme;
+
+        [[nodiscard]] friend bool operator==(ExpectedToken const&, ExpectedToken const&) = default;
+    };
+
+    [[nodiscard]] std::vector<ExpectedToken> to_expected(std::span<assembler::Token const> const tokens) {
+        auto result = std::vector<ExpectedToken>{};
+        for (auto const& token : tokens) {
+            result.push_back(ExpectedToken{ token.type(), token.lexeme() });
+        }
+        return result;
+    }
+
+    // The tokens, or the offset of the first invalid character.
+    using LexResult = std::variant<std::vector<ExpectedToken>, usize>;
+
+    [[nodiscard]] LexResult lex(std::string_view const source) {
+        auto const source_file = assembler::SourceFile{ "test.asm", source };
+        auto lexer = assembler::Lexer{ source_file };
+        if (auto const result = lexer.tokenize(); not result.has_value()) {
+            return usize{ result.error().source_location()->offset() };
+        }
+        auto const tokens = std::move(lexer).take();
+        return to_expected(tokens);
+    }
+
+    [[nodiscard]] bool is_letter(char const c) {
+        return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z');
+    }
+
+    [[nodiscard]] bool is_digit(char const c) {
+        return c >= '0' and c <= '9';
+    }
+
+    [[nodiscard]] bool is_hexadecimal_digit(char const c) {
+        return is_digit(c) or (c >= 'a' and c <= 'f') or (c >= 'A' and c <= 'F');
+    }
+
+    // One character at a time, without the scanner, as a reference for the lexer.
+    [[nodiscard]] LexResult reference_lex(std::string_view const source) {
+        static constexpr auto registers = std::array{ "A"sv, "B"sv, "C"sv, "D"sv };
+        auto tokens = std::vector<ExpectedToken>{};
+        auto index = usize{ 0 };
+        while (true) {
+            while (index < source.length() and std::string_view{ " \t\v\f\r" }.contains(source[index])) {
+                ++index;
+            }
+            if (index == source.length()) {
+                tokens.push_back(ExpectedToken{ TokenType::EndOfInput, source.substr(index) });
+                return tokens;
+            }
+            auto const start = index;
+            auto const c = source[index];
+            auto type = TokenType::EndOfInput;
+            if (c == ';') {
+                while (index < source.length() and source[index] != '\n') {
+                    ++index;
+                }
+                continue;
+            }
+            if (c == '\n' or c == ',' or c == '*' or c == ':') {
+                ++index;
+                type = c == '\n' ? TokenType::Newline
+                       : c == ',' ? TokenType::Comma
+                       : c == '*' ? TokenType::Asterisk
+                                  : TokenType::Colon;
+            } else if (is_digit(c)) {
+                if (c == '0' and index + 2 < source.length() and source[index + 1] == 'x'
+                    and is_hexadecimal_digit(source[index + 2])) {
+                    index += 2;
+                    while (index < source.length() and is_hexadecimal_digit(source[index])) {
+                        ++index;
+                    }
+                } else {
+                    while (index < source.length() and is_digit(source[index])) {
+                        ++index;
+                    }
+                }
+                type = TokenType::Integer;
+            } else if (is_letter(c)) {
+                while (index < source.length()
+                       and (is_letter(source[index]) or is_digit(source[index]) or source[index] == '_')) {
+                    ++index;
+                }
+                auto const lexeme = source.substr(start, index - start);
+                auto const is_register = std::ranges::find(registers, lexeme) != registers.end();
+                type = is_register ? TokenType::Register : TokenType::Identifier;
+            } else {
+                return start;
+            }
+            tokens.push_back(ExpectedToken{ type, source.substr(start, index - start) });
+        }
+    }
+
+    [[nodiscard]] std::vector<ExpectedToken> tokens_of(std::string_view const source) {
+        auto const result = lex(source);
+        if (not std::holds_alternative<std::vector<ExpectedToken>>(result)) {
+            ADD_FAILURE() << "Unexpected lexer error in '" << source << "'";
+            return {};
+        }
+        return std::get<std::vector<ExpectedToken>>(result);
+    }
+}  // namespace
+
+TEST(Lexer, HexadecimalPrefixNeedsADigit) {
+    EXPECT_EQ(
+        tokens_of("0x1F 0x 0xG 0x1g"),
+        (std::vector<ExpectedToken>{
+            { TokenType::Integer, "0x1F" },
+            { TokenType::Integer, "0" },
+            { TokenType::Identifier, "x" },
+            { TokenType::Integer, "0" },
+            { TokenType::Identifier, "xG" },
+            { TokenType::Integer, "0x1" },
+            { TokenType::Identifier, "g" },
+            { TokenType::EndOfInput, "" },
+        })
+    );
+    EXPECT_EQ(
+        tokens_of("0x"),
+        (std::vector<ExpectedToken>{
+            { TokenType::Integer, "0" },
+            { TokenType::Identifier, "x" },
+            { TokenType::EndOfInput, "" },
+        })
+    );
+}
+
+TEST(Lexer, CommentAtEndOfInput) {
+    EXPECT_EQ(
+        tokens_of("halt ; no newline behind this comment"),
+        (std::vector<ExpectedToken>{
+            { TokenType::Identifier, "halt" },
+            { TokenType::EndOfInput, "" },
+        })
+    );
+}
+
+TEST(Lexer, TrailingWhitespaceEndsInput) {
+    for (auto const source : { "halt  "sv, "halt\t"sv, "halt \r"sv, "halt\n   "sv }) {
+        auto const tokens = tokens_of(source);
+        ASSERT_FALSE(tokens.empty());
+        EXPECT_EQ(tokens.front(), (ExpectedToken{ TokenType::Identifier, "halt" }));
+        EXPECT_EQ(tokens.back().type, TokenType::EndOfInput);
+    }
+}
+
+TEST(Lexer, ReportsInvalidCharacters) {
+    EXPECT_EQ(lex("halt $"), LexResult{ usize{ 5 } });
+    EXPECT_EQ(lex("copy 1, _A"), LexResult{ usize{ 8 } });
+}
+
+// Long runs of whitespace, comments, digits and identifier characters let the scanner take full vector
+// batches and then finish in the scalar tail.
+TEST(Lexer, MatchesReferenceOnLongRuns) {
+    auto random = RandomSource{ 33 };
+    for (auto round = 0; round < 500; ++round) {
+        auto source = std::string{};
+        for (auto piece = 0; piece < 8; ++piece) {
+            auto const length = usize{ random.next() % 80 };
+            switch (random.next() % 5) {
+                case 0:
+                    source += std::string(length, " \t"[random.next() % 2]);
+                    break;
+                case 1:
+                    source += "; " + std::string(length, 'c') + "\n";
+                    break;
+                case 2:
+                    source += "1" + std::string(length, '0') + " ";
+                    break;
+                case 3:
+                    source += "0x" + std::string(length + 1, 'F') + ",";
+                    break;
+                default:
+                    source += "l" + std::string(length, '_') + ":";
+                    break;
+            }
+        }
+        ASSERT_EQ(lex(source), reference_lex(source)) << "Source: '" << source << "'";
+    }
+}
+
+TEST(Lexer, MatchesReferenceOnRandomSources) {
+    auto random = RandomSource{ 34 };
+    for (auto round = 0; round < 5000; ++round) {
+        auto const source = random.next_source(1 + random.next() % 40);
+        ASSERT_EQ(lex(source), reference_lex(source)) << "Source: '" << source << "'";
+    }
+}
@@ -0,0 +1,130 @@
+#include <assembler/assembler.hpp>
+#include <assembler/diagnostic.hpp>
+#include <common/mapped_file.hpp>
+#include <emulator/machine.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "random_source.hpp"
+#include "temporary_directory.hpp"
+
+namespace {
+    struct Program final {
+        std::vector<std::byte> bytes;
+        std::vector<Word> label_addresses;
+    };
+
+    [[nodiscard]] Program assemble(std::string_view const source) {
+        auto const source_file = assembler::SourceFile{ "test.asm", source };
+        auto const image = assembler::assemble_image(source_file, { .base_address = Machine::entry_point });
+        if (not image.has_value()) {
+            ADD_FAILURE() << assembler::render(image.error());
+            return {};
+        }
+        auto result = Program{ { image->bytes().begin(), image->bytes().end() }, {} };
+        for (auto const& symbol : image->symbols()) {
+            result.label_addresses.push_back(symbol.address);
+        }
+        return result;
+    }
+
+    [[nodiscard]] std::string repeat(std::string_view const line, usize const count) {
+        auto result = std::string{};
+        for (auto i = usize{ 0 }; i < count; ++i) {
+            result += line;
+        }
+        return result;
+    }
+
+    void run_until_halted(Machine& machine, Scheduling const scheduling, u64 const quantum) {
+        while (not machine.is_halted()) {
+            ASSERT_GT(machine.run(scheduling, 1'000'000, quantum), u64{ 0 });
+        }
+    }
+
+    // The first word of the text device.
+    [[nodiscard]] Word first_word(Machine const& machine) {
+        auto const row = machine.text_device().row(0);
+        auto result = Word{ 0 };
+        for (auto i = usize{ 0 }; i < sizeof(Word); ++i) {
+            result |= Word{ static_cast<u8>(row[i]) } << (8 * i);
+        }
+        return result;
+    }
+
+    // The memory and the state of every core.
+    [[nodiscard]] std::vector<std::byte> snapshot(Machine const& machine) {
+        auto const directory = TemporaryDirectory{};
+        auto const path = directory.path() / "snapshot.sav";
+        machine.save(path);
+        auto const file = MappedFile::open(path);
+        if (not file.has_value()) {
+            ADD_FAILURE() << "Unable to read " << path;
+            return {};
+        }
+        return std::vector<std::byte>{ file->bytes().begin(), file->bytes().end() };
+    }
+}  // namespace
+
+TEST(Machine, AtomicAddsOfAllCoresReachTheExactTotal) {
+    constexpr auto num_cores = usize{ 8 };
+    constexpr auto num_adds = usize{ 2'000 };
+    auto const program = assemble("copy 0, A\n" + repeat("atomic_add 3, *A\n", num_adds) + "halt\n");
+    auto const entry_points = std::vector<Word>(num_cores, Machine::entry_point);
+    for (auto const scheduling : { Scheduling::Deterministic, Scheduling::FreeRunning }) {
+        for (auto const quantum : { u64{ 1 }, u64{ 7 }, Machine::default_quantum }) {
+            auto machine = Machine{ program.bytes, entry_points };
+            run_until_halted(machine, scheduling, quantum);
+            EXPECT_EQ(first_word(machine), Word{ 3 * num_adds * num_cores }) << "Quantum " << quantum;
+        }
+    }
+}
+
+TEST(Machine, FaultsOnUnalignedAtomicAdds) {
+    auto const program = assemble("copy 2, A\natomic_add 1, *A\nhalt\n");
+    auto const entry_points = std::vector<Word>{ Machine::entry_point };
+    auto machine = Machine{ program.bytes, entry_points };
+    EXPECT_THROW(machine.run(Scheduling::Deterministic, 10), Fault);
+    EXPECT_EQ(first_word(machine), Word{ 0 });
+}
+
+// The cores store to overlapping, unaligned addresses, so the final memory depends on how they interleave.
+TEST(Machine, DeterministicSchedulingIsReproducible) {
+    auto random = RandomSource{ 46 };
+    auto source = std::string{};
+    for (auto core = 0; core < 5; ++core) {
+        source += "core_" + std::to_string(core) + ":\n";
+        for (auto i = 0; i < 500; ++i) {
+            auto const address = std::to_string(random.next() % 64);
+            switch (random.next() % 4) {
+                case 0:
+                    source += "copy " + address + ", A\ncopy " + std::to_string(random.next()) + ", *A\n";
+                    break;
+                case 1:
+                    source += "copy " + std::to_string(random.next() % 16 * 4) + ", B\natomic_add 1, *B\n";
+                    break;
+                case 2:
+                    source += "copy " + std::to_string(core) + ", C\nfence\n";
+                    break;
+                default:
+                    source += "copy " + address + ", D\ncopy " + std::to_string(core) + ", *D\n";
+                    break;
+            }
+        }
+        source += "halt\n";
+    }
+    auto const program = assemble(source);
+    ASSERT_EQ(program.label_addresses.size(), usize{ 5 });
+
+    auto const run = [&](u64 const quantum) {
+        auto machine = Machine{ program.bytes, program.label_addresses };
+        run_until_halted(machine, Scheduling::Deterministic, quantum);
+        return snapshot(machine);
+    };
+    for (auto const quantum : { u64{ 1 }, u64{ 3 }, u64{ 100 } }) {
+        EXPECT_TRUE(run(quantum) == run(quantum)) << "Quantum " << quantum;
+    }
+    // Otherwise the test would not show anything.
+    EXPECT_FALSE(run(1) == run(100));
+}
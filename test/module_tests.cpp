@@ -0,0 +1,189 @@
+#include <assembler/assembler.hpp>
+#include <assembler/module.hpp>
+#include <deque>
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "random_source.hpp"
+
+namespace {
+    constexpr auto base_address = Word{ 0x100 };
+
+    using Symbols = std::vector<std::pair<std::string, Word>>;
+
+    // Either the program or the error, which is described by its message and its offset in the whole source.
+    struct Linked final {
+        std::vector<std::byte> bytes;
+        Symbols symbols;
+        std::string error;
+
+        [[nodiscard]] friend bool operator==(Linked const&, Linked const&) = default;
+    };
+
+    [[nodiscard]] Symbols to_pairs(std::span<assembler::Symbol const> const symbols) {
+        auto result = Symbols{};
+        for (auto const& symbol : symbols) {
+            result.emplace_back(symbol.name, symbol.address);
+        }
+        return result;
+    }
+
+    // Labels are drawn from a small set, so that some of them are defined twice and others not at all.
+    [[nodiscard]] std::string random_section(RandomSource& random) {
+        auto const label = [&] { return "label_" + std::to_string(random.next() % 24); };
+        auto result = std::string{};
+        auto const num_lines = random.next() % 8;
+        for (auto i = u32{ 0 }; i < num_lines; ++i) {
+            switch (random.next() % 6) {
+                case 0:
+                    result += label() + ":\n";
+                    break;
+                case 1:
+                    result += "copy " + label() + ", A\n";
+                    break;
+                default:
+                    result += random.next_line();
+                    break;
+            }
+        }
+        return result;
+    }
+
+    // Keeps the sources alive for as long as the module refers to them.
+    class Sections final {
+    private:
+        std::deque<std::string> m_sources;
+        std::deque<assembler::SourceFile> m_files;
+        std::vector<assembler::SourceFile const*> m_sections;
+
+    public:
+        [[nodiscard]] assembler::SourceFile const& add(std::string source) {
+            auto const& stored = m_sources.emplace_back(std::move(source));
+            return m_files.emplace_back("section.asm", stored);
+        }
+
+        void insert(usize const index, assembler::SourceFile const& file) {
+            m_sections.insert(m_sections.begin() + static_cast<std::ptrdiff_t>(index), &file);
+        }
+
+        void replace(usize const index, assembler::SourceFile const& file) {
+            m_sections.at(index) = &file;
+        }
+
+        void erase(usize const index) {
+            m_sections.erase(m_sections.begin() + static_cast<std::ptrdiff_t>(index));
+        }
+
+        [[nodiscard]] usize size() const {
+            return m_sections.size();
+        }
+
+        [[nodiscard]] std::string whole_source() const {
+            auto result = std::string{};
+            for (auto const section : m_sections) {
+                result += section->source();
+            }
+            return result;
+        }
+
+        // Where an error in one of the sections would be in the whole source.
+        [[nodiscard]] std::string describe(assembler::Error const& error) const {
+            auto const location = error.source_location().value();
+            auto offset = location.offset();
+            for (auto const section : m_sections) {
+                if (section == &location.source_file()) {
+                    return fmt::format("{} at {}", error, offset);
+                }
+                offset += section->source().length();
+            }
+            ADD_FAILURE() << "Error in a section that is not part of the module.";
+            return {};
+        }
+    };
+
+    [[nodiscard]] Linked link(assembler::Module& module, Sections const& sections) {
+        auto const instructions = module.link();
+        if (not instructions.has_value()) {
+            return Linked{ {}, {}, sections.describe(instructions.error()) };
+        }
+        return Linked{ instructions->encode(), to_pairs(module.symbols()), {} };
+    }
+
+    [[nodiscard]] Linked assemble_from_scratch(std::string_view const source) {
+        auto const source_file = assembler::SourceFile{ "whole.asm", source };
+        auto const image = assembler::assemble_image(source_file, { .base_address = base_address });
+        if (not image.has_value()) {
+            return Linked{ {}, {}, fmt::format("{} at {}", image.error(), image.error().source_location()->offset()) };
+        }
+        return Linked{ { image->bytes().begin(), image->bytes().end() }, to_pairs(image->symbols()), {} };
+    }
+}  // namespace
+
+// Linking after every edit only lays out the sections from the first one that changed, which has to give
+// the same program, or the same first error, as assembling everything again.
+TEST(Module, RelinkingAfterEditsMatchesAssemblingFromScratch) {
+    auto random = RandomSource{ 36 };
+    auto sections = Sections{};
+    auto module = assembler::Module{ { .base_address = base_address } };
+    auto num_linked = 0;
+    auto num_duplicate_labels = 0;
+    auto num_undefined_symbols = 0;
+    for (auto edit = 0; edit < 500; ++edit) {
+        auto const& file = sections.add(random_section(random));
+        auto const choice = sections.size() < 3 ? 0 : random.next() % 4;
+        if (choice == 0) {
+            auto const index = random.next() % (sections.size() + 1);
+            ASSERT_TRUE(module.insert_section(index, file).has_value());
+            sections.insert(index, file);
+        } else if (choice == 3 and sections.size() > 6) {
+            auto const index = random.next() % sections.size();
+            module.erase_section(index);
+            sections.erase(index);
+        } else {
+            auto const index = random.next() % sections.size();
+            ASSERT_TRUE(module.replace_section(index, file).has_value());
+            sections.replace(index, file);
+        }
+        ASSERT_EQ(module.num_sections(), sections.size());
+
+        auto const source = sections.whole_source();
+        auto const linked = link(module, sections);
+        ASSERT_EQ(linked, assemble_from_scratch(source)) << "Edit " << edit << ", source:\n" << source;
+        if (linked.error.empty()) {
+            ++num_linked;
+        } else if (linked.error.starts_with("Duplicate label")) {
+            ++num_duplicate_labels;
+        } else if (linked.error.starts_with("Undefined symbol")) {
+            ++num_undefined_symbols;
+        }
+    }
+    // Otherwise the test would not show much.
+    EXPECT_GT(num_linked, 20);
+    EXPECT_GT(num_duplicate_labels, 20);
+    EXPECT_GT(num_undefined_symbols, 20);
+}
+
+// A section that does not assemble leaves the module as it was.
+TEST(Module, FailedEditsLeaveTheModuleUnchanged) {
+    auto sections = Sections{};
+    auto module = assembler::Module{ { .base_address = base_address } };
+    auto const& first = sections.add("start:\ncopy end, A\n");
+    auto const& second = sections.add("copy 1, *A\nend:\nhalt\n");
+    ASSERT_TRUE(module.insert_section(0, second).has_value());
+    ASSERT_TRUE(module.insert_section(0, first).has_value());
+    sections.insert(0, second);
+    sections.insert(0, first);
+    auto const expected = assemble_from_scratch(sections.whole_source());
+    ASSERT_TRUE(expected.error.empty()) << expected.error;
+    ASSERT_EQ(link(module, sections), expected);
+
+    auto const& invalid = sections.add("copy 1, A\ncopy\n");
+    EXPECT_FALSE(module.replace_section(1, invalid).has_value());
+    EXPECT_FALSE(module.insert_section(1, invalid).has_value());
+    EXPECT_EQ(module.num_sections(), usize{ 2 });
+    EXPECT_EQ(link(module, sections), expected);
+}
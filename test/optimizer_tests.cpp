@@ -0,0 +1,257 @@
+#include <assembler/assembler.hpp>
+#include <assembler/diagnostic.hpp>
+#include <assembler/module.hpp>
+#include <assembler/optimizer.hpp>
+#include <deque>
+#include <gtest/gtest.h>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "random_source.hpp"
+
+namespace {
+    using assembler::OptimizationReport;
+
+    struct Assembled final {
+        std::vector<std::byte> bytes;
+        std::vector<std::pair<std::string, Word>> symbols;
+
+        [[nodiscard]] friend bool operator==(Assembled const&, Assembled const&) = default;
+    };
+
+    [[nodiscard]] Assembled assemble(std::string_view const source, assembler::Options const& options) {
+        auto const source_file = assembler::SourceFile{ "test.asm", source };
+        auto const image = assembler::assemble_image(source_file, options);
+        if (not image.has_value()) {
+            ADD_FAILURE() << assembler::render(image.error());
+            return {};
+        }
+        auto result = Assembled{ { image->bytes().begin(), image->bytes().end() }, {} };
+        for (auto const& symbol : image->symbols()) {
+            result.symbols.emplace_back(symbol.name, symbol.address);
+        }
+        return result;
+    }
+
+    [[nodiscard]] OptimizationReport report_of(std::vector<std::string_view> const& sections) {
+        // Source files can be neither copied nor moved.
+        auto source_files = std::deque<assembler::SourceFile>{};
+        for (auto const section : sections) {
+            source_files.emplace_back("test.asm", section);
+        }
+        auto module = assembler::Module{ assembler::Options{ .optimize = true } };
+        for (auto const& source_file : source_files) {
+            if (auto const inserted = module.insert_section(module.num_sections(), source_file);
+                not inserted.has_value()) {
+                ADD_FAILURE() << assembler::render(inserted.error());
+                return {};
+            }
+        }
+        if (auto const linked = module.link(); not linked.has_value()) {
+            ADD_FAILURE() << assembler::render(linked.error());
+        }
+        return module.optimization_report();
+    }
+
+    // Optimising `source` has to give exactly what assembling `expected` without optimisation gives,
+    // including the addresses of the labels.
+    void expect_optimizes_to(std::string_view const source, std::string_view const expected) {
+        EXPECT_EQ(assemble(source, { .optimize = true }), assemble(expected, {})) << "Source:\n" << source;
+    }
+
+    void expect_unchanged(std::string_view const source) {
+        expect_optimizes_to(source, source);
+        EXPECT_EQ(report_of({ source }).num_removed_instructions(), usize{ 0 }) << "Source:\n" << source;
+    }
+
+    constexpr auto load_length = MoveImmediateIntoRegister::byte_length;
+    constexpr auto store_length = MoveImmediateIntoMemory::byte_length;
+}  // namespace
+
+TEST(Optimizer, RemovesDeadRegisterWrites) {
+    expect_optimizes_to("copy 1, A\ncopy 2, A\nhalt\n", "copy 2, A\nhalt\n");
+    expect_optimizes_to("copy 1, A\ncopy 5, B\ncopy 2, A\ncopy 3, *B\n", "copy 5, B\ncopy 2, A\ncopy 3, *B\n");
+    // The pointer register of a store is read.
+    expect_unchanged("copy 1, A\ncopy 3, *A\ncopy 2, A\n");
+
+    auto const report = report_of({ "copy 1, A\ncopy 2, A\nhalt\n" });
+    EXPECT_EQ(report.num_dead_register_writes, usize{ 1 });
+    EXPECT_EQ(report.num_redundant_reloads, usize{ 0 });
+    EXPECT_EQ(report.num_overwritten_stores, usize{ 0 });
+    EXPECT_EQ(report.num_bytes_saved, load_length);
+}
+
+// The atomic adds keep the stores after them from overwriting anything, so that only the reloads are removed.
+TEST(Optimizer, RemovesRedundantReloads) {
+    expect_optimizes_to(
+        "copy 1, A\natomic_add 7, *A\ncopy 1, A\ncopy 8, *A\n",
+        "copy 1, A\natomic_add 7, *A\ncopy 8, *A\n"
+    );
+    expect_unchanged("copy 1, A\natomic_add 7, *A\ncopy 2, A\ncopy 8, *A\n");
+    // Other registers holding the same value do not matter.
+    expect_unchanged("copy 1, A\ncopy 1, B\ncopy 7, *A\ncopy 8, *B\n");
+
+    auto const report = report_of({ "copy 1, A\natomic_add 7, *A\ncopy 1, A\ncopy 8, *A\n" });
+    EXPECT_EQ(report.num_redundant_reloads, usize{ 1 });
+    EXPECT_EQ(report.num_removed_instructions(), usize{ 1 });
+    EXPECT_EQ(report.num_bytes_saved, load_length);
+}
+
+// Every occurrence of a symbol resolves to the same address, so symbols are compared by name.
+TEST(Optimizer, RemovesRedundantReloadsOfSymbols) {
+    expect_optimizes_to(
+        "copy data, A\natomic_add 7, *A\ncopy data, A\ncopy 8, *A\nhalt\ndata:\n",
+        "copy data, A\natomic_add 7, *A\ncopy 8, *A\nhalt\ndata:\n"
+    );
+    expect_unchanged("copy data, A\natomic_add 7, *A\ncopy other, A\ncopy 8, *A\nhalt\ndata:\nother:\n");
+    // A symbol and an immediate are never considered equal, even if the symbol has that value.
+    expect_unchanged("start:\ncopy 0, A\natomic_add 7, *A\ncopy start, A\ncopy 8, *A\n");
+}
+
+TEST(Optimizer, RemovesStoresOverwrittenThroughTheSamePointer) {
+    expect_optimizes_to("copy 1, *A\ncopy 2, *A\n", "copy 2, *A\n");
+    expect_optimizes_to("copy 1, *A\ncopy 5, B\ncopy 2, *A\ncopy 3, *B\n", "copy 5, B\ncopy 2, *A\ncopy 3, *B\n");
+    // Different pointers might point to different words.
+    expect_unchanged("copy 1, *A\ncopy 2, *B\n");
+
+    auto const report = report_of({ "copy 1, *A\ncopy 2, *A\n" });
+    EXPECT_EQ(report.num_overwritten_stores, usize{ 1 });
+    EXPECT_EQ(report.num_bytes_saved, store_length);
+}
+
+TEST(Optimizer, KeepsStoresIfThePointerChangesInBetween) {
+    expect_unchanged("copy 1, *A\ncopy 5, A\ncopy 2, *A\n");
+    // Once the redundant reload is removed, the pointer no longer changes in between.
+    expect_optimizes_to("copy 5, A\ncopy 1, *A\ncopy 5, A\ncopy 2, *A\n", "copy 5, A\ncopy 2, *A\n");
+}
+
+// Every register is live at halt, atomic adds and fences. Atomic adds read memory, and other cores may
+// observe stores before fences.
+TEST(Optimizer, KeepsWritesBeforeHaltAtomicAddAndFence) {
+    expect_unchanged("copy 1, A\nhalt\ncopy 2, A\n");
+    expect_unchanged("copy 1, A\natomic_add 1, *B\ncopy 2, A\n");
+    expect_unchanged("copy 1, A\nfence\ncopy 2, A\n");
+    expect_unchanged("copy 1, *A\nhalt\ncopy 2, *A\n");
+    expect_unchanged("copy 1, *A\natomic_add 1, *B\ncopy 2, *A\n");
+    expect_unchanged("copy 1, *A\nfence\ncopy 2, *A\n");
+}
+
+// Labels might be reached other than by falling through, so nothing is known about the registers there.
+TEST(Optimizer, TreatsLabelsAsBarriers) {
+    expect_unchanged("copy 1, A\nagain:\ncopy 1, A\ncopy 7, *A\n");
+    expect_unchanged("copy 1, A\nagain:\ncopy 2, A\ncopy 7, *A\n");
+    expect_unchanged("copy 1, *A\nagain:\ncopy 2, *A\n");
+    // Within the code between two labels, the optimiser still applies.
+    expect_optimizes_to(
+        "first:\ncopy 1, A\ncopy 1, A\ncopy 7, *A\nsecond:\ncopy 2, *B\ncopy 3, *B\n",
+        "first:\ncopy 1, A\ncopy 7, *A\nsecond:\ncopy 3, *B\n"
+    );
+}
+
+TEST(Optimizer, TreatsSectionBoundariesAsBarriers) {
+    auto const report =
+        report_of({ "copy 1, A\ncopy 7, *A\n", "copy 1, A\ncopy 8, *A\n", "copy 1, *B\n", "copy 2, *B\n" });
+    EXPECT_EQ(report.num_removed_instructions(), usize{ 0 });
+}
+
+TEST(Optimizer, MovesLabelsToTheRemainingInstructions) {
+    expect_optimizes_to(
+        "start:\ncopy 1, A\ncopy 2, A\nmiddle:\ncopy 3, *B\ncopy 4, *B\nend:\n",
+        "start:\ncopy 2, A\nmiddle:\ncopy 4, *B\nend:\n"
+    );
+    // Several labels at the same instruction and at the end of the section.
+    expect_optimizes_to(
+        "copy 1, A\ncopy 1, A\ncopy 7, *A\na:\nb:\ncopy 1, *C\ncopy 2, *C\nc:\nd:\n",
+        "copy 1, A\ncopy 7, *A\na:\nb:\ncopy 2, *C\nc:\nd:\n"
+    );
+    // A label at a removed instruction moves to the next one.
+    expect_optimizes_to("copy 7, *A\nlabel:\ncopy 1, B\ncopy 2, B\n", "copy 7, *A\nlabel:\ncopy 2, B\n");
+}
+
+TEST(Optimizer, UpdatesBarriers) {
+    auto const make = [](::Instruction const& instruction) {
+        return assembler::LoweredInstruction{ instruction, tl::nullopt };
+    };
+    auto instructions = std::pmr::vector<assembler::LoweredInstruction>{
+        make(MoveImmediateIntoRegister{ 1, Register::A }),
+        make(MoveImmediateIntoRegister{ 2, Register::A }),
+        make(MoveImmediateIntoMemory{ 3, *Register::B }),
+        make(MoveImmediateIntoMemory{ 4, *Register::B }),
+        make(MoveImmediateIntoRegister{ 5, Register::C }),
+        make(MoveImmediateIntoRegister{ 5, Register::C }),
+    };
+    auto barriers = std::vector<u32>{ 0, 2, 2, 5, 6, 6 };
+    auto const report = assembler::optimize(instructions, barriers);
+
+    EXPECT_EQ(report.num_dead_register_writes, usize{ 1 });
+    EXPECT_EQ(report.num_overwritten_stores, usize{ 1 });
+    EXPECT_EQ(report.num_redundant_reloads, usize{ 0 });
+    ASSERT_EQ(instructions.size(), usize{ 4 });
+    EXPECT_EQ(instructions[0].instruction.opcode(), Opcode::MoveImmediateIntoRegister);
+    EXPECT_EQ(instructions[1].instruction.opcode(), Opcode::MoveImmediateIntoMemory);
+    EXPECT_EQ(barriers, (std::vector<u32>{ 0, 1, 1, 3, 4, 4 }));
+}
+
+TEST(Optimizer, SumsReportsOverAllSections) {
+    auto const report = report_of({
+        "copy 1, A\ncopy 2, A\n",
+        "copy 1, *A\ncopy 2, *A\n",
+        "copy 3, B\natomic_add 7, *B\ncopy 3, B\ncopy 8, *B\n",
+        "copy 4, C\ncopy 5, C\n",
+    });
+    EXPECT_EQ(report.num_dead_register_writes, usize{ 2 });
+    EXPECT_EQ(report.num_redundant_reloads, usize{ 1 });
+    EXPECT_EQ(report.num_overwritten_stores, usize{ 1 });
+    EXPECT_EQ(report.num_removed_instructions(), usize{ 4 });
+    EXPECT_EQ(report.num_bytes_saved, 3 * load_length + store_length);
+    EXPECT_EQ(report_of({ "copy 1, A\n", "halt\n" }).num_bytes_saved, usize{ 0 });
+}
+
+// Sources are split into the same sections regardless of the number of threads and the threshold, and
+// section boundaries are barriers, so the optimised output cannot depend on them either.
+TEST(Optimizer, OutputDoesNotDependOnParallelism) {
+    auto random = RandomSource{ 38 };
+    auto source = std::string{ "label_0:\n" };
+    auto last_label = 0;
+    for (auto i = 1; i < 40'000; ++i) {
+        auto const register_ = "ABCD"[random.next() % 4];
+        auto const value = std::to_string(random.next() % 3);
+        switch (random.next() % 8) {
+            case 0:
+                source += "label_" + std::to_string(i) + ":\n";
+                last_label = i;
+                break;
+            case 1:
+                source += "copy label_" + std::to_string(last_label) + ", " + register_ + "\n";
+                break;
+            case 2:
+            case 3:
+                source += "copy " + value + ", *" + register_ + "\n";
+                break;
+            case 4:
+                source += random.next_line();
+                break;
+            default:
+                source += "copy " + value + ", " + register_ + "\n";
+                break;
+        }
+    }
+    ASSERT_GT(source.length(), usize{ 4 } << 16);
+
+    auto const expected =
+        assemble(source, { .parallel_threshold = usize{ 1 } << 30, .num_threads = 1, .optimize = true });
+    ASSERT_LT(expected.bytes.size(), assemble(source, {}).bytes.size());
+    for (auto const parallel_threshold : { usize{ 0 }, usize{ 1 } << 16, usize{ 1 } << 30 }) {
+        for (auto const num_threads : { usize{ 0 }, usize{ 1 }, usize{ 2 }, usize{ 3 }, usize{ 8 } }) {
+            auto const options = assembler::Options{
+                .parallel_threshold = parallel_threshold,
+                .num_threads = num_threads,
+                .optimize = true,
+            };
+            EXPECT_TRUE(assemble(source, options) == expected)
+                << num_threads << " threads, threshold " << parallel_threshold;
+        }
+    }
+}
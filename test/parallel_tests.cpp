@@ -0,0 +1,119 @@
+#include <assembler/assembler.hpp>
+#include <assembler/diagnostic.hpp>
+#include <assembler/module.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+#include "random_source.hpp"
+
+// Sources are split into chunks of about 64 KiB that are assembled on their own, in parallel above the
+// threshold. Neither the output nor the reported error may differ from assembling the whole source as one
+// section on one thread.
+namespace {
+    // The bytes, or the rendered error.
+    using Result = std::variant<std::vector<std::byte>, std::string>;
+
+    [[nodiscard]] Result assemble_sequentially(std::string_view const source) {
+        auto const source_file = assembler::SourceFile{ "test.asm", source };
+        auto module = assembler::Module{};
+        if (auto const inserted = module.insert_section(0, source_file); not inserted.has_value()) {
+            return assembler::render(inserted.error());
+        }
+        auto const instructions = module.link();
+        if (not instructions.has_value()) {
+            return assembler::render(instructions.error());
+        }
+        return instructions->encode();
+    }
+
+    [[nodiscard]] Result assemble_in_parallel(std::string_view const source, usize const num_threads) {
+        auto const source_file = assembler::SourceFile{ "test.asm", source };
+        auto const options = assembler::Options{ .parallel_threshold = 0, .num_threads = num_threads };
+        auto const image = assembler::assemble_image(source_file, options);
+        if (not image.has_value()) {
+            return assembler::render(image.error());
+        }
+        return std::vector<std::byte>{ image->bytes().begin(), image->bytes().end() };
+    }
+
+    // About 20 bytes per line, so that the source spans several chunks. Labels are defined and referenced
+    // throughout, so that symbols resolve across chunks.
+    [[nodiscard]] std::vector<std::string> valid_lines(usize const num_lines) {
+        auto random = RandomSource{ 35 };
+        auto lines = std::vector<std::string>{};
+        for (auto i = usize{ 0 }; i < num_lines; ++i) {
+            if (i % 1000 == 0) {
+                lines.push_back("label_" + std::to_string(i) + ":\n");
+            } else if (i % 1000 == 500) {
+                lines.push_back("copy label_" + std::to_string((num_lines - 1 - i) / 1000 * 1000) + ", A\n");
+            } else {
+                lines.push_back(random.next_line());
+            }
+        }
+        lines.push_back("halt\n");
+        return lines;
+    }
+
+    [[nodiscard]] std::string join(std::vector<std::string> const& lines) {
+        auto result = std::string{};
+        for (auto const& line : lines) {
+            result += line;
+        }
+        return result;
+    }
+
+    struct Injection final {
+        double position;  // Relative to the number of lines.
+        std::string_view line;
+    };
+
+    void expect_same_as_sequential(std::vector<Injection> const& injections) {
+        auto lines = valid_lines(20'000);
+        for (auto const& [position, line] : injections) {
+            lines.at(static_cast<usize>(position * static_cast<double>(lines.size()))) = line;
+        }
+        auto const source = join(lines);
+        ASSERT_GT(source.length(), usize{ 4 } << 16);
+
+        auto const expected = assemble_sequentially(source);
+        ASSERT_EQ(std::holds_alternative<std::string>(expected), not injections.empty());
+        for (auto const num_threads : { usize{ 1 }, usize{ 2 }, usize{ 3 }, usize{ 8 } }) {
+            EXPECT_EQ(assemble_in_parallel(source, num_threads), expected) << num_threads << " threads";
+        }
+    }
+
+    constexpr auto lexer_error = std::string_view{ "copy 1, A $\n" };
+    constexpr auto parser_error = std::string_view{ "copy ,\n" };
+    constexpr auto lowering_error = std::string_view{ "copy A, B\n" };
+    constexpr auto undefined_symbol = std::string_view{ "copy nowhere, A\n" };
+    constexpr auto duplicate_label = std::string_view{ "label_0:\n" };
+}  // namespace
+
+TEST(ParallelAssembly, ValidSourceMatchesSequential) {
+    expect_same_as_sequential({});
+}
+
+TEST(ParallelAssembly, SingleErrorMatchesSequential) {
+    for (auto const position : { 0.01, 0.3, 0.6, 0.99 }) {
+        for (auto const line : { lexer_error, parser_error, lowering_error, undefined_symbol, duplicate_label }) {
+            expect_same_as_sequential({ { position, line } });
+        }
+    }
+}
+
+// The earliest phase wins over the earliest chunk, as if the whole source was lexed, then parsed, then lowered.
+TEST(ParallelAssembly, EarliestPhaseWinsAcrossChunks) {
+    expect_same_as_sequential({ { 0.1, lowering_error }, { 0.5, parser_error }, { 0.9, lexer_error } });
+    expect_same_as_sequential({ { 0.1, parser_error }, { 0.9, lexer_error } });
+    expect_same_as_sequential({ { 0.1, lowering_error }, { 0.9, parser_error } });
+    expect_same_as_sequential({ { 0.1, undefined_symbol }, { 0.9, lowering_error } });
+    expect_same_as_sequential({ { 0.1, undefined_symbol }, { 0.9, duplicate_label } });
+}
+
+TEST(ParallelAssembly, EarliestChunkWinsWithinAPhase) {
+    for (auto const line : { lexer_error, parser_error, lowering_error, undefined_symbol }) {
+        expect_same_as_sequential({ { 0.2, line }, { 0.5, line }, { 0.8, line } });
+    }
+}
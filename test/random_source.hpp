@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <lib2k/types.hpp>
+#include <string>
+#include <string_view>
+
+// Deterministic sources that are mostly, but not always, valid assembly: random sequences of the pieces
+// the language is made of, including invalid characters, overlong integers, comments at the end of the
+// input and trailing whitespace.
+class RandomSource final {
+private:
+    u32 m_state;
+
+public:
+    [[nodiscard]] explicit RandomSource(u32 const seed)
+        : m_state{ seed == 0 ? u32{ 1 } : seed } {}
+
+    // xorshift32
+    [[nodiscard]] u32 next() {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+
+    [[nodiscard]] std::string next_source(usize const num_pieces) {
+        static constexpr auto pieces = std::array<std::string_view, 32>{
+            "copy", "halt", "atomic_add", "fence", "A",   "B",     "C",   "D",          " ",   "  ",   "\t",
+            ",",    ", ",   "*",          ":",     "\n",  "\n",    "\n",  "0",          "12",  "0x",   "0x1F",
+            "0xG",  "lbl",  "lbl:",       " ; c",  "$",   "x_1",   "\r",  "4294967296", "; x\n", "0xFFFFFFFF",
+        };
+        auto source = std::string{};
+        for (auto i = usize{ 0 }; i < num_pieces; ++i) {
+            source += pieces[next() % pieces.size()];
+        }
+        return source;
+    }
+
+    // A line of valid assembly.
+    [[nodiscard]] std::string next_line() {
+        static constexpr auto registers = std::string_view{ "ABCD" };
+        auto const register_ = registers[next() % registers.length()];
+        switch (next() % 6) {
+            case 0:
+                return "copy " + std::to_string(next()) + ", " + register_ + "\n";
+            case 1:
+                return "copy " + std::to_string(next() % 1000) + ", *" + register_ + " ; store\n";
+            case 2:
+                return "atomic_add " + std::to_string(next() % 10) + ", *" + register_ + "\n";
+            case 3:
+                return "fence\n";
+            case 4:
+                return "; just a comment\n";
+            default:
+                return "\n";
+        }
+    }
+};
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <common/mapped_file.hpp>
+#include <common/memory.hpp>
+#include <emulator/save_state.hpp>
+#include <emulator/shared_memory.hpp>
+#include <emulator/text_device.hpp>
+#include <filesystem>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "random_source.hpp"
+#include "temporary_directory.hpp"
+
+namespace {
+    using testing::HasSubstr;
+
+    constexpr auto page_size = SharedMemory::page_size;
+
+    // Offsets into the file, see save_state.cpp.
+    constexpr auto format_version_offset = usize{ 8 };
+    constexpr auto header_size = usize{ 7 * sizeof(u64) };
+    constexpr auto core_size = usize{ (2 + std::tuple_size_v<Core::Registers>) * sizeof(u32) };
+
+    [[nodiscard]] std::vector<Core::State> some_cores() {
+        return {
+            Core::State{ 0x1234, false, { 1, 2, 3, 4 } },
+            Core::State{ 0xFFFF'FFFF, true, { 0xFFFF'FFFF, 0, 0x8000'0000, 42 } },
+        };
+    }
+
+    // Restores the memory through the page loader, as a machine would.
+    [[nodiscard]] std::vector<std::byte> restore(SaveState const& state) {
+        auto memory = SharedMemory{ state.memory_size(), state.page_loader() };
+        auto const bytes = memory.bytes();
+        return std::vector<std::byte>{ bytes.begin(), bytes.end() };
+    }
+
+    void expect_round_trip(
+        std::vector<std::byte> const& memory,
+        std::vector<Core::State> const& cores,
+        usize const expected_num_stored_pages
+    ) {
+        auto const directory = TemporaryDirectory{};
+        auto const path = directory.path() / "state.sav";
+        SaveState::write(path, memory, cores);
+        auto const state = SaveState::load(path);
+        ASSERT_TRUE(state.has_value()) << state.error();
+        EXPECT_EQ(state->memory_size(), memory.size());
+        EXPECT_EQ(state->num_stored_pages(), expected_num_stored_pages);
+        ASSERT_EQ(state->cores().size(), cores.size());
+        for (auto i = usize{ 0 }; i < cores.size(); ++i) {
+            EXPECT_EQ(state->cores()[i].instruction_pointer, cores[i].instruction_pointer);
+            EXPECT_EQ(state->cores()[i].is_halted, cores[i].is_halted);
+            EXPECT_EQ(state->cores()[i].registers, cores[i].registers);
+        }
+        EXPECT_TRUE(restore(state.value()) == memory);
+    }
+
+    void write_file(std::filesystem::path const& path, std::span<std::byte const> const contents) {
+        ASSERT_TRUE(write_file_atomically(path, contents));
+    }
+
+    // A state with three pages, of which the first is the only one that is stored, and two cores.
+    class SaveStateFile final {
+    private:
+        TemporaryDirectory m_directory;
+        std::vector<std::byte> m_contents;
+
+    public:
+        [[nodiscard]] SaveStateFile() {
+            auto memory = std::vector<std::byte>(3 * page_size);
+            std::ranges::fill(std::span{ memory }.first(TextDevice::num_mapped_bytes), std::byte{ ' ' });
+            SaveState::write(path(), memory, some_cores());
+            auto const file = MappedFile::open(path());
+            m_contents.assign(file->bytes().begin(), file->bytes().end());
+        }
+
+        [[nodiscard]] std::filesystem::path path() const {
+            return m_directory.path() / "state.sav";
+        }
+
+        [[nodiscard]] static usize page_table_offset() {
+            return header_size + 2 * core_size;
+        }
+
+        [[nodiscard]] static usize stored_pages_offset() {
+            return page_table_offset() + 3 * sizeof(u32);
+        }
+
+        template<MemoryValue Integral>
+        void patch(usize const offset, Integral const value) {
+            auto contents = m_contents;
+            store_little_endian(std::span{ contents }, offset, value);
+            write_file(path(), contents);
+        }
+
+        void truncate(usize const size) {
+            write_file(path(), std::span{ m_contents }.first(size));
+        }
+
+        [[nodiscard]] std::string load_error() const {
+            auto const state = SaveState::load(path());
+            if (state.has_value()) {
+                ADD_FAILURE() << "Loaded a broken save state.";
+                return {};
+            }
+            return state.error();
+        }
+    };
+}  // namespace
+
+TEST(SaveState, RoundTripsZeroPages) {
+    expect_round_trip(std::vector<std::byte>(4 * page_size), some_cores(), 0);
+    expect_round_trip(std::vector<std::byte>(TextDevice::num_mapped_bytes), {}, 0);
+}
+
+TEST(SaveState, StoresDuplicatePagesOnce) {
+    auto random = RandomSource{ 54 };
+    auto memory = std::vector<std::byte>(6 * page_size);
+    auto const fill_page = [&](usize const index, auto const& generate) {
+        std::ranges::generate(std::span{ memory }.subspan(index * page_size, page_size), generate);
+    };
+    fill_page(0, [&] { return static_cast<std::byte>(random.next()); });  // Incompressible.
+    fill_page(1, [] { return std::byte{ 'x' }; });
+    std::ranges::copy(std::span{ memory }.first(page_size), memory.begin() + 3 * page_size);
+    std::ranges::copy(std::span{ memory }.subspan(page_size, page_size), memory.begin() + 5 * page_size);
+    // Differs from page 1 in its last byte only.
+    fill_page(4, [] { return std::byte{ 'x' }; });
+    memory[5 * page_size - 1] = std::byte{ 'y' };
+    expect_round_trip(memory, some_cores(), 3);
+}
+
+TEST(SaveState, RoundTripsAShortLastPage) {
+    auto random = RandomSource{ 55 };
+    auto memory = std::vector<std::byte>(2 * page_size + 100);
+    std::ranges::generate(memory, [&] { return static_cast<std::byte>(random.next() % 4); });
+    expect_round_trip(memory, some_cores(), 3);
+
+    // A last page that is a prefix of an earlier page is not a duplicate.
+    std::ranges::copy(std::span{ memory }.first(100), memory.end() - 100);
+    expect_round_trip(memory, some_cores(), 3);
+}
+
+TEST(SaveState, RejectsOtherFormatVersions) {
+    auto file = SaveStateFile{};
+    file.patch(format_version_offset, SaveState::format_version + 1);
+    EXPECT_THAT(file.load_error(), HasSubstr("has format version 2, expected 1"));
+}
+
+TEST(SaveState, RejectsMalformedFiles) {
+    auto file = SaveStateFile{};
+    ASSERT_TRUE(SaveState::load(file.path()).has_value());
+
+    file.patch(0, u64{ 0 });
+    EXPECT_THAT(file.load_error(), HasSubstr("Malformed")) << "Magic";
+    file.patch(header_size + sizeof(u32), u32{ 2 });
+    EXPECT_THAT(file.load_error(), HasSubstr("Malformed")) << "Halt flag";
+    file.patch(SaveStateFile::page_table_offset() + sizeof(u32), u32{ 1 });
+    EXPECT_THAT(file.load_error(), HasSubstr("Malformed")) << "Stored page index";
+    file.patch(SaveStateFile::stored_pages_offset(), u64{ 1 } << 40);
+    EXPECT_THAT(file.load_error(), HasSubstr("Malformed")) << "Stored page offset";
+    file.patch(SaveStateFile::stored_pages_offset() + sizeof(u64), u32{ 0xFFFF'FFFF });
+    EXPECT_THAT(file.load_error(), HasSubstr("Malformed")) << "Stored page size";
+    file.patch(SaveStateFile::stored_pages_offset() + sizeof(u64) + sizeof(u32), u32{ 2 });
+    EXPECT_THAT(file.load_error(), HasSubstr("Malformed")) << "Encoding";
+    file.patch(header_size - sizeof(u64), u64{ 1 } << 60);
+    EXPECT_THAT(file.load_error(), HasSubstr("Malformed")) << "Number of stored pages";
+    for (auto const size : { usize{ 0 }, header_size - 1, header_size, SaveStateFile::stored_pages_offset() + 4 }) {
+        file.truncate(size);
+        EXPECT_THAT(file.load_error(), HasSubstr("Malformed")) << "Truncated to " << size << " bytes";
+    }
+}
+
+TEST(SaveState, ReportsCorruptPagesWhenLoadingThem) {
+    auto file = SaveStateFile{};
+    // The size of the only stored page, which is compressed.
+    file.patch(SaveStateFile::stored_pages_offset() + sizeof(u64), u32{ 3 });
+    auto const state = SaveState::load(file.path());
+    ASSERT_TRUE(state.has_value()) << state.error();
+    auto memory = SharedMemory{ state->memory_size(), state->page_loader() };
+    EXPECT_EQ(memory.load(page_size), Word{ 0 });
+    EXPECT_THROW([[maybe_unused]] auto const word = memory.load(0), std::runtime_error);
+}
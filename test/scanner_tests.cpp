@@ -0,0 +1,95 @@
+#include <assembler/scanner.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "random_source.hpp"
+
+// Compares the vectorized scanner against a plain loop. This file is built twice: for the baseline
+// instruction set, which uses SSE2 on x86-64, and, where the host supports it, with AVX2.
+namespace {
+    using namespace assembler::scanner;
+    using namespace std::string_view_literals;
+    using testing::Types;
+
+#if IUBS2K_SCANNER_HAS_SIMD
+    constexpr auto batch_size = simd::batch_size;
+#else
+    constexpr auto batch_size = usize{ 16 };
+#endif
+
+    template<typename CharacterClass>
+    [[nodiscard]] usize reference_skip(std::string_view const source, usize index) {
+        while (index < source.length() and CharacterClass::matches(source[index])) {
+            ++index;
+        }
+        return index;
+    }
+
+    // All 256 byte values, split by whether they belong to the class.
+    template<typename CharacterClass>
+    [[nodiscard]] std::pair<std::string, std::string> members_and_others() {
+        auto result = std::pair<std::string, std::string>{};
+        for (auto value = 0; value < 256; ++value) {
+            auto const c = static_cast<char>(value);
+            (CharacterClass::matches(c) ? result.first : result.second) += c;
+        }
+        return result;
+    }
+
+    template<typename CharacterClass>
+    class ScannerTest : public testing::Test { };
+
+    using CharacterClasses =
+        Types<HorizontalWhitespace, AnythingButNewline, DecimalDigit, HexadecimalDigit, IdentifierContinuation>;
+    TYPED_TEST_SUITE(ScannerTest, CharacterClasses);
+}  // namespace
+
+// Runs of every length up to several batches, starting at every position within a batch, both ending in
+// another character and at the end of the input. The latter end in the scalar tail.
+TYPED_TEST(ScannerTest, MatchesReferenceForEveryRunLength) {
+    auto const [members, others] = members_and_others<TypeParam>();
+    auto random = RandomSource{ 31 };
+    for (auto start = usize{ 0 }; start <= batch_size; ++start) {
+        for (auto length = usize{ 0 }; length <= 3 * batch_size + 1; ++length) {
+            auto source = std::string(start, others[random.next() % others.length()]);
+            for (auto i = usize{ 0 }; i < length; ++i) {
+                source += members[random.next() % members.length()];
+            }
+            EXPECT_EQ(skip<TypeParam>(source, start), start + length);
+            source += others[random.next() % others.length()];
+            source += std::string(random.next() % (2 * batch_size), ' ');
+            EXPECT_EQ(skip<TypeParam>(source, start), start + length);
+        }
+    }
+}
+
+// Mostly members with the occasional other character, covering all byte values including those above 0x7F,
+// which the unsigned range checks have to reject.
+TYPED_TEST(ScannerTest, MatchesReferenceOnRandomBytes) {
+    auto const [members, others] = members_and_others<TypeParam>();
+    auto random = RandomSource{ 32 };
+    for (auto round = 0; round < 200; ++round) {
+        auto source = std::string{};
+        auto const length = random.next() % (8 * batch_size);
+        for (auto i = usize{ 0 }; i < length; ++i) {
+            auto const is_member = random.next() % 16 != 0;
+            auto const& pool = is_member ? members : others;
+            source += pool[random.next() % pool.length()];
+        }
+        for (auto index = usize{ 0 }; index <= source.length(); ++index) {
+            ASSERT_EQ(skip<TypeParam>(source, index), reference_skip<TypeParam>(source, index))
+                << "Index " << index << " of " << source.length();
+        }
+    }
+}
+
+TEST(Scanner, UsesScalarLoopDuringConstantEvaluation) {
+    static_assert(skip<HorizontalWhitespace>(" \t\v\f\r\nx"sv, 0) == 5);
+    static_assert(skip<AnythingButNewline>("; comment at the end"sv, 0) == 20);
+    static_assert(skip<DecimalDigit>("0123456789a"sv, 0) == 10);
+    static_assert(skip<HexadecimalDigit>("0x09afAFg"sv, 2) == 8);
+    static_assert(skip<IdentifierContinuation>("a_Z9 "sv, 0) == 4);
+    static_assert(skip<DecimalDigit>(""sv, 0) == 0);
+    SUCCEED();
+}
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <atomic>
+#include <emulator/shared_memory.hpp>
+#include <gtest/gtest.h>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr auto page_size = SharedMemory::page_size;
+}  // namespace
+
+// A loader that throws leaves the page missing, so that the next access loads it again, starting from zeros.
+TEST(SharedMemory, RetriesLoadingAPageAfterTheLoaderThrows) {
+    auto num_calls = std::vector<usize>(3);
+    auto should_throw = true;
+    auto const load_page = [&](usize const index, std::span<std::byte> const page) {
+        ++num_calls.at(index);
+        EXPECT_TRUE(std::ranges::all_of(page, [](std::byte const byte) { return byte == std::byte{ 0 }; }));
+        std::ranges::fill(page, static_cast<std::byte>(index + 1));
+        if (index == 1 and should_throw) {
+            throw std::runtime_error{ "Corrupt page." };
+        }
+    };
+    auto memory = SharedMemory{ 2 * page_size + 8, load_page };
+    EXPECT_EQ(memory.load(0), Word{ 0x01'01'01'01 });
+    EXPECT_THROW([[maybe_unused]] auto const word = memory.load(page_size), std::runtime_error);
+    EXPECT_THROW(memory.store(page_size + 4, 0), std::runtime_error);
+    // Accesses spanning several pages load the pages that are missing.
+    EXPECT_THROW([[maybe_unused]] auto const word = memory.load(page_size - 2), std::runtime_error);
+    EXPECT_EQ(num_calls, (std::vector<usize>{ 1, 3, 0 }));
+
+    should_throw = false;
+    EXPECT_EQ(memory.load(page_size - 2), Word{ 0x02'02'01'01 });
+    EXPECT_EQ(memory.load(2 * page_size + 4), Word{ 0x03'03'03'03 });
+    EXPECT_EQ(memory.bytes().size(), 2 * page_size + 8);
+    EXPECT_EQ(num_calls, (std::vector<usize>{ 1, 4, 1 }));
+}
+
+// Cores that access a page while another one loads it wait for it instead of loading it again.
+TEST(SharedMemory, LoadsEveryPageOnceUnderConcurrentAccess) {
+    constexpr auto num_pages = usize{ 64 };
+    auto num_calls = std::vector<std::atomic<usize>>(num_pages);
+    auto const load_page = [&](usize const index, std::span<std::byte> const page) {
+        ++num_calls[index];
+        std::ranges::fill(page, static_cast<std::byte>(index));
+    };
+    auto memory = SharedMemory{ num_pages * page_size, load_page };
+    auto threads = std::vector<std::jthread>{};
+    for (auto thread = 0; thread < 8; ++thread) {
+        threads.emplace_back([&] {
+            for (auto index = usize{ 0 }; index < num_pages; ++index) {
+                auto const expected = Word{ 0x01'01'01'01 } * static_cast<Word>(index);
+                EXPECT_EQ(memory.load(index * page_size + page_size / 2), expected);
+            }
+        });
+    }
+    threads.clear();
+    for (auto const& calls : num_calls) {
+        EXPECT_EQ(calls.load(), usize{ 1 });
+    }
+}
+
+// Every thread stores to its own four bytes, which straddle two words that neighbouring threads store to as
+// well. Since each store merges its bytes into the words, every thread reads back what it stored last.
+TEST(SharedMemory, ConcurrentUnalignedStoresToNeighbouringBytesLoseNoUpdate) {
+    constexpr auto num_threads = usize{ 6 };
+    constexpr auto num_stores = Word{ 100'000 };
+    auto memory = SharedMemory{ 4 * (num_threads + 1) };
+    auto num_lost_updates = std::atomic<usize>{ 0 };
+    auto threads = std::vector<std::jthread>{};
+    for (auto thread = usize{ 0 }; thread < num_threads; ++thread) {
+        threads.emplace_back([&, thread] {
+            auto const address = 4 * thread + 2;
+            for (auto i = Word{ 0 }; i < num_stores; ++i) {
+                auto const value = i * Word{ 0x9E37'79B9 } + static_cast<Word>(thread);
+                memory.store(address, value);
+                if (memory.load(address) != value) {
+                    ++num_lost_updates;
+                }
+            }
+        });
+    }
+    threads.clear();
+    EXPECT_EQ(num_lost_updates.load(), usize{ 0 });
+    for (auto thread = usize{ 0 }; thread < num_threads; ++thread) {
+        EXPECT_EQ(memory.load(4 * thread + 2), (num_stores - 1) * Word{ 0x9E37'79B9 } + static_cast<Word>(thread));
+    }
+    // The bytes around the stores stay untouched.
+    EXPECT_EQ(memory.load(0) & 0xFFFF, Word{ 0 });
+    EXPECT_EQ(memory.load(4 * num_threads) >> 16, Word{ 0 });
+}
+
+TEST(SharedMemory, ConcurrentFetchAddsReachTheExactTotal) {
+    constexpr auto num_threads = usize{ 8 };
+    constexpr auto num_adds = Word{ 50'000 };
+    auto memory = SharedMemory{ 16 };
+    auto threads = std::vector<std::jthread>{};
+    for (auto thread = usize{ 0 }; thread < num_threads; ++thread) {
+        threads.emplace_back([&] {
+            for (auto i = Word{ 0 }; i < num_adds; ++i) {
+                memory.fetch_add(4, 3);
+            }
+        });
+    }
+    threads.clear();
+    EXPECT_EQ(memory.load(4), Word{ 3 * num_adds * num_threads });
+    EXPECT_EQ(memory.load(0), Word{ 0 });
+    EXPECT_EQ(memory.load(8), Word{ 0 });
+}
+
+TEST(SharedMemory, FetchAddRejectsUnalignedAddresses) {
+    auto memory = SharedMemory{ 16 };
+    for (auto const address : { usize{ 1 }, usize{ 2 }, usize{ 3 }, usize{ 5 }, usize{ 11 } }) {
+        EXPECT_THROW(memory.fetch_add(address, 1), std::invalid_argument) << address;
+    }
+    EXPECT_THROW(memory.fetch_add(16, 1), std::out_of_range);
+    EXPECT_EQ(memory.fetch_add(12, 1), Word{ 0 });
+    auto const is_zero = [](std::byte const byte) { return byte == std::byte{ 0 }; };
+    EXPECT_TRUE(std::ranges::all_of(memory.bytes().first(12), is_zero));
+}
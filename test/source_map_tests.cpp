@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <array>
+#include <common/memory.hpp>
+#include <common/source_map.hpp>
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "random_source.hpp"
+
+namespace {
+    struct Entry final {
+        Word address;
+        std::string_view filename;
+        u32 line;
+        u32 column;
+    };
+
+    // A source map together with what it is supposed to contain.
+    struct Reference final {
+        std::vector<Entry> entries;
+        Word end;
+
+        [[nodiscard]] SourceMap build() const {
+            auto builder = SourceMap::Builder{};
+            for (auto const& entry : entries) {
+                builder.add(entry.address, entry.filename, entry.line, entry.column);
+            }
+            return std::move(builder).build(end);
+        }
+
+        [[nodiscard]] std::string find(Word const address) const {
+            if (entries.empty() or address < entries.front().address or address >= end) {
+                return "none";
+            }
+            auto const found = std::ranges::upper_bound(entries, address, {}, &Entry::address) - 1;
+            return fmt::format("{}:{}:{}", found->filename, found->line, found->column);
+        }
+    };
+
+    [[nodiscard]] std::string describe(tl::optional<SourceMap::Location> const& location) {
+        return location.has_value() ? fmt::format("{}", location.value()) : "none";
+    }
+
+    // Gaps, line jumps and columns of all sizes, so that every length of varint occurs.
+    [[nodiscard]] Reference random_reference(RandomSource& random, usize const num_entries) {
+        static constexpr auto filenames = std::array<std::string_view, 3>{ "main.asm", "lib.asm", "" };
+        auto result = Reference{};
+        auto address = Word{ random.next() % 100 };
+        auto line = u32{ 1 };
+        for (auto i = usize{ 0 }; i < num_entries; ++i) {
+            auto const magnitude = random.next() % 4 == 0 ? 20 : 3;
+            result.entries.push_back(Entry{
+                address,
+                filenames[random.next() % 4 == 0 ? random.next() % 3 : 0],
+                line,
+                random.next() % (u32{ 1 } << magnitude),
+            });
+            address += 1 + random.next() % (u32{ 1 } << magnitude);
+            line = random.next() % 3 == 0 ? random.next() % (u32{ 1 } << magnitude) : line + random.next() % 4;
+        }
+        result.end = address;
+        return result;
+    }
+
+    // The addresses around every entry and the end, and random ones, in random order.
+    [[nodiscard]] std::vector<Word> addresses_to_look_up(RandomSource& random, Reference const& reference) {
+        auto result = std::vector<Word>{ 0, reference.end - 1, reference.end, reference.end + 1, 0xFFFF'FFFF };
+        for (auto const& entry : reference.entries) {
+            result.insert(result.end(), { entry.address - 1, entry.address, entry.address + 1 });
+        }
+        for (auto i = 0; i < 1'000; ++i) {
+            result.push_back(random.next() % std::max(reference.end, Word{ 1 }));
+        }
+        // find_all() has to deal with addresses in any order.
+        for (auto i = result.size(); i > 1; --i) {
+            std::swap(result[i - 1], result[random.next() % i]);
+        }
+        return result;
+    }
+
+    void expect_matches(SourceMap const& source_map, Reference const& reference, RandomSource& random) {
+        EXPECT_EQ(source_map.size(), reference.entries.size());
+        auto const addresses = addresses_to_look_up(random, reference);
+        auto const found = source_map.find_all(addresses);
+        ASSERT_EQ(found.size(), addresses.size());
+        for (auto i = usize{ 0 }; i < addresses.size(); ++i) {
+            auto const expected = reference.find(addresses[i]);
+            ASSERT_EQ(describe(source_map.find(addresses[i])), expected) << "Address " << addresses[i];
+            ASSERT_EQ(describe(found[i]), expected) << "Address " << addresses[i];
+        }
+    }
+
+    // Three blocks of entries from two files.
+    [[nodiscard]] std::vector<std::byte> serialized_example() {
+        auto builder = SourceMap::Builder{};
+        for (auto i = u32{ 0 }; i < 70; ++i) {
+            builder.add(4 * i, i % 10 == 9 ? "lib.asm" : "main.asm", i + 1, 1);
+        }
+        return std::move(builder).build(280).serialize();
+    }
+}  // namespace
+
+// Sizes around the block size of 32 entries, so that the first and last entries of blocks are looked up.
+TEST(SourceMap, FindsTheInstructionContainingAnAddress) {
+    auto random = RandomSource{ 44 };
+    for (auto const num_entries : { 0, 1, 2, 31, 32, 33, 63, 64, 65, 1'000 }) {
+        auto const reference = random_reference(random, static_cast<usize>(num_entries));
+        expect_matches(reference.build(), reference, random);
+    }
+}
+
+TEST(SourceMap, RoundTripsThroughSerialization) {
+    auto random = RandomSource{ 45 };
+    for (auto const num_entries : { 0, 1, 31, 32, 33, 500 }) {
+        auto const reference = random_reference(random, static_cast<usize>(num_entries));
+        auto const serialized = reference.build().serialize();
+        auto const deserialized = SourceMap::deserialize(serialized);
+        ASSERT_TRUE(deserialized.has_value()) << num_entries << " entries";
+        expect_matches(deserialized.value(), reference, random);
+        EXPECT_EQ(deserialized->serialize(), serialized);
+    }
+}
+
+// Large gaps and jumps backwards in the line numbers take several bytes per delta.
+TEST(SourceMap, EncodesExtremeDeltas) {
+    auto const reference = Reference{
+        {
+            { 0, "a.asm", 0xFFFF'FFFF, 0 },
+            { 1, "a.asm", 1, 0xFFFF'FFFF },
+            { 0x8000'0000, "b.asm", 0xFFFF'FFFF, 1 },
+            { 0xFFFF'FFFD, "a.asm", 0, 7 },
+        },
+        0xFFFF'FFFF,
+    };
+    auto const deserialized = SourceMap::deserialize(reference.build().serialize());
+    ASSERT_TRUE(deserialized.has_value());
+    auto random = RandomSource{ 46 };
+    expect_matches(deserialized.value(), reference, random);
+    EXPECT_EQ(describe(deserialized->find(0x7FFF'FFFF)), "a.asm:1:4294967295");
+    EXPECT_EQ(describe(deserialized->find(0xFFFF'FFFE)), "a.asm:0:7");
+}
+
+TEST(SourceMap, RejectsTruncatedAndOverlongInput) {
+    auto const serialized = serialized_example();
+    ASSERT_TRUE(SourceMap::deserialize(serialized).has_value());
+    for (auto size = usize{ 0 }; size < serialized.size(); ++size) {
+        EXPECT_FALSE(SourceMap::deserialize(std::span{ serialized }.first(size)).has_value()) << size << " bytes";
+    }
+    auto overlong = serialized;
+    overlong.push_back(std::byte{ 0 });
+    EXPECT_FALSE(SourceMap::deserialize(overlong).has_value());
+}
+
+// The layout is described in SourceMap::serialize().
+TEST(SourceMap, RejectsCorruptSidecars) {
+    auto const serialized = serialized_example();
+    auto const filenames_size = 2 * sizeof(u32) + std::string_view{ "main.asmlib.asm" }.size();
+    auto const blocks_offset = sizeof(u32) + filenames_size + 2 * sizeof(u32);
+    constexpr auto block_size = 5 * sizeof(u32);
+    auto const deltas_offset = blocks_offset + 3 * block_size + sizeof(u32);
+    auto const num_deltas = load_little_endian<u32>(std::span{ serialized }, deltas_offset - sizeof(u32));
+    ASSERT_EQ(num_deltas, serialized.size() - deltas_offset);
+
+    auto const expect_rejected = [&](usize const offset, u32 const value, std::string_view const what) {
+        auto corrupt = serialized;
+        store_little_endian(std::span{ corrupt }, offset, value);
+        EXPECT_FALSE(SourceMap::deserialize(corrupt).has_value()) << what;
+    };
+    expect_rejected(0, 0xFFFF'FFFF, "Number of files");
+    expect_rejected(sizeof(u32), 0xFFFF'FFFF, "Length of a filename");
+    expect_rejected(blocks_offset - 2 * sizeof(u32), 71, "Number of entries");
+    expect_rejected(blocks_offset - 2 * sizeof(u32), 69, "Number of entries");
+    expect_rejected(blocks_offset - sizeof(u32), 0, "End in front of the last entry");
+    expect_rejected(blocks_offset + block_size, 0, "Blocks out of order");
+    expect_rejected(blocks_offset + sizeof(u32), 2, "File index");
+    expect_rejected(blocks_offset + block_size + 4 * sizeof(u32), 1, "Deltas offset");
+    expect_rejected(blocks_offset + 2 * block_size + 4 * sizeof(u32), 0xFFFF'FFFF, "Deltas offset");
+
+    // An address delta of zero, which would make two entries share an address.
+    auto corrupt = serialized;
+    corrupt[deltas_offset] = std::byte{ 0 };
+    EXPECT_FALSE(SourceMap::deserialize(corrupt).has_value());
+    // A varint that does not end.
+    std::fill(corrupt.begin() + static_cast<std::ptrdiff_t>(deltas_offset), corrupt.end(), std::byte{ 0xFF });
+    EXPECT_FALSE(SourceMap::deserialize(corrupt).has_value());
+}
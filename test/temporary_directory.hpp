@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <lib2k/types.hpp>
+#include <string>
+#include <unistd.h>
+
+// A fresh, empty directory that is removed with everything in it when the object goes out of scope. Unique
+// across processes, so that test runs can be sharded.
+class TemporaryDirectory final {
+private:
+    std::filesystem::path m_path;
+
+public:
+    [[nodiscard]] TemporaryDirectory() {
+        static auto next_index = std::atomic<usize>{ 0 };
+        auto const name = "iubs2k_test_" + std::to_string(::getpid()) + "_" + std::to_string(next_index++);
+        m_path = std::filesystem::temp_directory_path() / name;
+        std::filesystem::remove_all(m_path);
+        std::filesystem::create_directories(m_path);
+    }
+
+    TemporaryDirectory(TemporaryDirectory const& other) = delete;
+    TemporaryDirectory(TemporaryDirectory&& other) noexcept = delete;
+    TemporaryDirectory& operator=(TemporaryDirectory const& other) = delete;
+    TemporaryDirectory& operator=(TemporaryDirectory&& other) noexcept = delete;
+
+    ~TemporaryDirectory() {
+        auto error = std::error_code{};
+        std::filesystem::remove_all(m_path, error);
+    }
+
+    [[nodiscard]] std::filesystem::path const& path() const {
+        return m_path;
+    }
+};
@@ -0,0 +1,183 @@
+#include <assembler/assembler.hpp>
+#include <assembler/diagnostic.hpp>
+#include <common/mapped_file.hpp>
+#include <emulator/machine.hpp>
+#include <emulator/verifier.hpp>
+#include <fmt/format.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "random_source.hpp"
+#include "temporary_directory.hpp"
+
+namespace {
+    using testing::HasSubstr;
+
+    constexpr auto entry_point = static_cast<Word>(Machine::entry_point);
+
+    [[nodiscard]] std::vector<std::byte> assemble(std::string_view const source) {
+        auto const source_file = assembler::SourceFile{ "test.asm", source };
+        auto const image = assembler::assemble_image(source_file, { .base_address = entry_point });
+        if (not image.has_value()) {
+            ADD_FAILURE() << assembler::render(image.error());
+            return {};
+        }
+        return std::vector<std::byte>{ image->bytes().begin(), image->bytes().end() };
+    }
+
+    // Expects verification to fail with exactly one error.
+    [[nodiscard]] VerifiedProgram::Error only_error(std::span<std::byte const> const program) {
+        auto const verified = VerifiedProgram::verify(program);
+        if (verified.has_value()) {
+            ADD_FAILURE() << "Verification succeeded.";
+            return {};
+        }
+        EXPECT_EQ(verified.error().size(), usize{ 1 });
+        return verified.error().front();
+    }
+
+    // Of the instruction with the given index, if all instructions in front of it are six bytes long.
+    [[nodiscard]] Word address_of(usize const index) {
+        return entry_point + static_cast<Word>(index * MoveImmediateIntoRegister::byte_length);
+    }
+
+    // The memory and the state of every core.
+    [[nodiscard]] std::vector<std::byte> snapshot(Machine const& machine) {
+        auto const directory = TemporaryDirectory{};
+        auto const path = directory.path() / "snapshot.sav";
+        machine.save(path);
+        auto const file = MappedFile::open(path);
+        if (not file.has_value()) {
+            ADD_FAILURE() << "Unable to read " << path;
+            return {};
+        }
+        return std::vector<std::byte>{ file->bytes().begin(), file->bytes().end() };
+    }
+}  // namespace
+
+TEST(Verifier, AcceptsValidPrograms) {
+    auto const program = assemble("copy 4, A\ncopy 7, *A\natomic_add 1, *A\nfence\nhalt\n");
+    EXPECT_TRUE(VerifiedProgram::verify(program).has_value());
+    // Instructions behind a halt are never executed, so their accesses do not matter.
+    EXPECT_TRUE(VerifiedProgram::verify(assemble("halt\ncopy 1, *A\ncopy 3, A\natomic_add 1, *A\n")).has_value());
+}
+
+TEST(Verifier, RejectsInvalidOpcodes) {
+    auto program = assemble("copy 1, A\nhalt\n");
+    program.back() = std::byte{ 0x7F };
+    auto const error = only_error(program);
+    EXPECT_EQ(error.address, address_of(1));
+    EXPECT_THAT(error.message, HasSubstr("Invalid opcode: 0x7f"));
+}
+
+TEST(Verifier, RejectsTruncatedTrailingInstructions) {
+    auto program = assemble("copy 1, A\ncopy 2, B\n");
+    program.pop_back();
+    auto const error = only_error(program);
+    EXPECT_EQ(error.address, address_of(1));
+    EXPECT_THAT(error.message, HasSubstr("Insufficient buffer size"));
+
+    // Without a halt, execution runs off the end.
+    EXPECT_THAT(only_error(assemble("copy 1, A\n")).message, HasSubstr("Execution leaves memory"));
+}
+
+TEST(Verifier, RejectsAccessesOutOfBounds) {
+    // The memory ends right behind the program, of which the four bytes behind the halt are never executed.
+    auto const program = [](std::string const& address) {
+        return assemble("copy " + address + ", A\ncopy 1, *A\nhalt\ndata:\nfence\nfence\nfence\nfence\n");
+    };
+    auto const memory_size = address_of(2) + 5;
+    for (auto const address : { memory_size, memory_size - 3, Word{ 0xFFFF'FFFE } }) {
+        auto const error = only_error(program(std::to_string(address)));
+        EXPECT_EQ(error.address, address_of(1)) << address;
+        EXPECT_THAT(error.message, HasSubstr("out of bounds")) << address;
+    }
+    EXPECT_TRUE(VerifiedProgram::verify(program("data")).has_value());
+    EXPECT_TRUE(VerifiedProgram::verify(program(std::to_string(memory_size - 4))).has_value());
+}
+
+TEST(Verifier, RejectsMisalignedAtomicAdds) {
+    for (auto const address : { 1, 2, 3, 1'001 }) {
+        auto const error = only_error(assemble(fmt::format("copy {}, A\natomic_add 1, *A\nhalt\n", address)));
+        EXPECT_EQ(error.address, address_of(1)) << address;
+        EXPECT_THAT(error.message, HasSubstr("Unaligned atomic access")) << address;
+    }
+    // Plain stores may be unaligned.
+    EXPECT_TRUE(VerifiedProgram::verify(assemble("copy 1, A\ncopy 1, *A\nhalt\n")).has_value());
+}
+
+TEST(Verifier, RejectsStoresThatOverwriteCode) {
+    // Every byte of the store counts, so a store that starts in front of the program overwrites it, too.
+    for (auto const address : { entry_point - 3, entry_point, address_of(2) - 3 }) {
+        auto const error = only_error(assemble(fmt::format("copy {}, B\ncopy 1, *B\nhalt\n", address)));
+        EXPECT_EQ(error.address, address_of(1)) << address;
+        EXPECT_THAT(error.message, HasSubstr("overwrites the instruction")) << address;
+    }
+    auto const error = only_error(assemble("start:\ncopy start, C\natomic_add 1, *C\nhalt\n"));
+    EXPECT_THAT(error.message, HasSubstr("overwrites the instruction at 0x00000780"));
+    // Right in front of the program is fine.
+    EXPECT_TRUE(VerifiedProgram::verify(assemble("copy 1916, B\ncopy 1, *B\nhalt\n")).has_value());
+}
+
+TEST(Verifier, ReportsErrorsOfAllEntryPointsSortedByAddress) {
+    auto const program =
+        assemble("first:\ncopy 2, A\natomic_add 1, *A\nhalt\nsecond:\ncopy 1920, A\ncopy 1, *A\nhalt\n");
+    auto const second = address_of(2) + 1;
+    auto const entry_points = std::vector<Word>{ second, entry_point };
+    auto const verified = VerifiedProgram::verify(program, entry_points);
+    ASSERT_FALSE(verified.has_value());
+    ASSERT_EQ(verified.error().size(), usize{ 2 });
+    EXPECT_EQ(verified.error()[0].address, address_of(1));
+    EXPECT_EQ(verified.error()[1].address, second + MoveImmediateIntoRegister::byte_length);
+}
+
+// Cores of a verified program run from the decoded control-flow graph, which has to behave exactly like
+// fetching and decoding every instruction.
+TEST(Verifier, VerifiedCoresExecuteLikeUnverifiedOnes) {
+    auto random = RandomSource{ 47 };
+    auto source = std::string{};
+    for (auto core = 0; core < 4; ++core) {
+        source += "core_" + std::to_string(core) + ":\n";
+        for (auto i = 0; i < 300; ++i) {
+            auto const address = std::to_string(random.next() % 1'000);
+            switch (random.next() % 4) {
+                case 0:
+                    source += "copy " + address + ", A\ncopy " + std::to_string(random.next()) + ", *A\n";
+                    break;
+                case 1:
+                    source += "copy " + std::to_string(random.next() % 250 * 4) + ", B\natomic_add 7, *B\n";
+                    break;
+                case 2:
+                    source += "copy " + std::to_string(random.next()) + ", " + "CD"[random.next() % 2] + "\nfence\n";
+                    break;
+                default:
+                    source += "copy " + std::to_string(random.next()) + ", *A\n";
+                    break;
+            }
+        }
+        source += "halt\n";
+    }
+    auto const source_file = assembler::SourceFile{ "test.asm", source };
+    auto const image = assembler::assemble_image(source_file, { .base_address = entry_point });
+    ASSERT_TRUE(image.has_value()) << assembler::render(image.error());
+    auto entry_points = std::vector<Word>{};
+    for (auto const& symbol : image->symbols()) {
+        entry_points.push_back(symbol.address);
+    }
+    auto const verified = VerifiedProgram::verify(image->bytes(), entry_points);
+    ASSERT_TRUE(verified.has_value()) << fmt::format("{}", verified.error().front());
+
+    for (auto const quantum : { u64{ 1 }, u64{ 5 }, Machine::default_quantum }) {
+        auto unverified_machine = Machine{ image->bytes(), entry_points };
+        auto verified_machine = Machine{ verified.value() };
+        while (not unverified_machine.is_halted() or not verified_machine.is_halted()) {
+            auto const num_unverified = unverified_machine.run(Scheduling::Deterministic, 100, quantum);
+            auto const num_verified = verified_machine.run(Scheduling::Deterministic, 100, quantum);
+            ASSERT_EQ(num_verified, num_unverified);
+            ASSERT_GT(num_verified, u64{ 0 });
+            ASSERT_TRUE(snapshot(verified_machine) == snapshot(unverified_machine)) << "Quantum " << quantum;
+        }
+    }
+}